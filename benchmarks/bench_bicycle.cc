@@ -0,0 +1,195 @@
+#include <vector>
+#include "benchmark.h"
+#include "bicycle/arend.h"
+#include "bicycle/kinematic.h"
+#include "bicycle/whipple.h"
+#include "constants.h"
+
+/*
+ * Benchmarks of bicycle model functions called in the control loop.
+ */
+namespace {
+    using real_t = model::real_t;
+    const real_t v0 = 4.0; // forward speed [m/s]
+    const real_t dt = 1.0/200; // sample time [s]
+
+    model::BicycleWhipple::state_t initial_state() {
+        model::BicycleWhipple::state_t x;
+        x << 0, 3, 5, 0, 0; // define x in degrees
+        return x*constants::as_radians;
+    }
+
+    template <typename T>
+    typename T::full_state_t initial_full_state() {
+        return T::make_full_state(T::auxiliary_state_t::Zero(), initial_state());
+    }
+
+    void bicycle_calculate_state_matrix(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        model::BicycleWhipple::state_matrix_t A;
+        real_t v = v0;
+        while (state.keep_running()) {
+            bicycle.calculate_state_matrix(v, &A);
+            benchmark::do_not_optimize(A);
+            v += static_cast<real_t>(1e-3);
+        }
+    }
+    BENCHMARK(bicycle_calculate_state_matrix);
+
+    /* the speed alternates so that the state space is always recalculated */
+    void bicycle_set_v(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        size_t i = 0;
+        while (state.keep_running()) {
+            bicycle.set_v(v0 + static_cast<real_t>(0.1)*(i++ & 1));
+            benchmark::do_not_optimize(bicycle.Ad());
+        }
+    }
+    BENCHMARK(bicycle_set_v);
+
+    void bicycle_set_v_discretization_table(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        bicycle.set_discretization_table(0.5, 10.0, 0.01);
+        size_t i = 0;
+        while (state.keep_running()) {
+            bicycle.set_v(v0 + static_cast<real_t>(0.1)*(i++ & 1));
+            benchmark::do_not_optimize(bicycle.Ad());
+        }
+    }
+    BENCHMARK(bicycle_set_v_discretization_table);
+
+    void bicycle_set_discrete_state_space(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        while (state.keep_running()) {
+            bicycle.set_discrete_state_space();
+            benchmark::do_not_optimize(bicycle.Ad());
+        }
+    }
+    BENCHMARK(bicycle_set_discrete_state_space);
+
+    void bicycle_solve_constraint_pitch(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        const model::BicycleWhipple::state_t x = initial_state();
+        real_t pitch = 0;
+        while (state.keep_running()) {
+            pitch = bicycle.solve_constraint_pitch(x[1], x[2], pitch);
+            benchmark::do_not_optimize(pitch);
+        }
+    }
+    BENCHMARK(bicycle_solve_constraint_pitch);
+
+    void bicycle_solve_constraint_pitch_table(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        bicycle.set_pitch_table(45*constants::as_radians, 60*constants::as_radians);
+        const model::BicycleWhipple::state_t x = initial_state();
+        real_t pitch = 0;
+        while (state.keep_running()) {
+            pitch = bicycle.solve_constraint_pitch(x[1], x[2], pitch);
+            benchmark::do_not_optimize(pitch);
+        }
+    }
+    BENCHMARK(bicycle_solve_constraint_pitch_table);
+
+    /* 1024 elements per iteration, compare with 1024 times bicycle_solve_constraint_pitch */
+    void bicycle_solve_constraint_pitch_batch(benchmark::State& state) {
+        static constexpr size_t count = 1024;
+        model::BicycleWhipple bicycle(v0, dt);
+        const model::BicycleWhipple::state_t x = initial_state();
+        std::vector<real_t> roll(count);
+        std::vector<real_t> steer(count);
+        std::vector<real_t> pitch(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            roll[i] = x[1]*(1 + static_cast<real_t>(i)/count);
+            steer[i] = x[2]*(1 - static_cast<real_t>(i)/count);
+        }
+        while (state.keep_running()) {
+            bicycle.solve_constraint_pitch_batch(roll.data(), steer.data(), pitch.data(), count);
+            benchmark::do_not_optimize(pitch[0]);
+        }
+    }
+    BENCHMARK(bicycle_solve_constraint_pitch_batch);
+
+    void whipple_update_state(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        model::BicycleWhipple::state_t x = initial_state();
+        const model::BicycleWhipple::input_t u = model::BicycleWhipple::input_t::Zero();
+        while (state.keep_running()) {
+            x = bicycle.update_state(x, u, model::BicycleWhipple::measurement_t::Zero());
+            benchmark::do_not_optimize(x);
+        }
+    }
+    BENCHMARK(whipple_update_state);
+
+    /*
+     * virtual dispatch through the base class for comparison with whipple_update_state
+     * the dynamic type is hidden so that the call is not devirtualized
+     */
+    void bicycle_update_state_virtual(benchmark::State& state) {
+        model::BicycleWhipple whipple(v0, dt);
+        const model::Bicycle& bicycle = *benchmark::hide_pointer<const model::Bicycle>(&whipple);
+        model::Bicycle::state_t x = initial_state();
+        const model::Bicycle::input_t u = model::Bicycle::input_t::Zero();
+        while (state.keep_running()) {
+            x = bicycle.update_state(x, u, model::Bicycle::measurement_t::Zero());
+            benchmark::do_not_optimize(x);
+        }
+    }
+    BENCHMARK(bicycle_update_state_virtual);
+
+    /* the full state is reset each iteration so that the integration does not diverge */
+    template <typename T>
+    void integrate_full_state(benchmark::State& state) {
+        T bicycle(v0, dt);
+        const typename T::full_state_t x0 = initial_full_state<T>();
+        const typename T::input_t u = T::input_t::Zero();
+        typename T::measurement_t z;
+        z << x0[T::p + 2], x0[T::p + 4]; // steer angle and steer rate
+        while (state.keep_running()) {
+            typename T::full_state_t x = bicycle.integrate_full_state(x0, u, dt, z);
+            benchmark::do_not_optimize(x);
+        }
+    }
+
+    void whipple_integrate_full_state(benchmark::State& state) {
+        integrate_full_state<model::BicycleWhipple>(state);
+    }
+    BENCHMARK(whipple_integrate_full_state);
+
+    void whipple_integrate_full_state_discrete(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        bicycle.set_integration_method(model::BicycleWhipple::integration_method_t::discrete);
+        const model::BicycleWhipple::full_state_t x0 = initial_full_state<model::BicycleWhipple>();
+        const model::BicycleWhipple::input_t u = model::BicycleWhipple::input_t::Zero();
+        while (state.keep_running()) {
+            model::BicycleWhipple::full_state_t x = bicycle.integrate_full_state(x0, u, dt);
+            benchmark::do_not_optimize(x);
+        }
+    }
+    BENCHMARK(whipple_integrate_full_state_discrete);
+
+    /* one second of simulation sampled at 60 Hz, compare with 200 calls of whipple_integrate_full_state */
+    void whipple_integrate_full_state_trajectory(benchmark::State& state) {
+        model::BicycleWhipple bicycle(v0, dt);
+        const model::BicycleWhipple::full_state_t x0 = initial_full_state<model::BicycleWhipple>();
+        const model::BicycleWhipple::input_t u = model::BicycleWhipple::input_t::Zero();
+        model::BicycleWhipple::full_state_trajectory_t trajectory;
+        trajectory.reserve(61);
+        while (state.keep_running()) {
+            trajectory.clear();
+            model::BicycleWhipple::full_state_t x = bicycle.integrate_full_state_trajectory(
+                    x0, u, 1.0, 1.0/60, &trajectory);
+            benchmark::do_not_optimize(x);
+        }
+    }
+    BENCHMARK(whipple_integrate_full_state_trajectory);
+
+    void arend_integrate_full_state(benchmark::State& state) {
+        integrate_full_state<model::BicycleArend>(state);
+    }
+    BENCHMARK(arend_integrate_full_state);
+
+    void kinematic_integrate_full_state(benchmark::State& state) {
+        integrate_full_state<model::BicycleKinematic>(state);
+    }
+    BENCHMARK(kinematic_integrate_full_state);
+} // namespace
@@ -0,0 +1,169 @@
+#include <cmath>
+#include "benchmark.h"
+#include "bicycle/whipple.h"
+#include "constants.h"
+#include "kalman.h"
+#include "lqr.h"
+#include "parameters.h"
+#include "square_root_kalman.h"
+
+/*
+ * Benchmarks of observer and controller functions called in the control loop.
+ */
+namespace {
+    using bicycle_t = model::BicycleWhipple;
+    using kalman_t = observer::Kalman<bicycle_t>;
+    using square_root_kalman_t = observer::SquareRootKalman<bicycle_t>;
+    using lqr_t = controller::Lqr<bicycle_t>;
+    using real_t = model::real_t;
+    const real_t v0 = 4.0; // forward speed [m/s]
+    const real_t dt = 1.0/200; // sample time [s]
+    const uint32_t horizon_length = 100;
+
+    kalman_t make_kalman(bicycle_t& bicycle) {
+        return kalman_t(bicycle,
+                bicycle_t::state_t::Zero(),
+                parameters::defaultvalue::kalman::Q(dt),
+                parameters::defaultvalue::kalman::R,
+                std::pow(3*constants::as_radians/2, 2) * bicycle_t::state_matrix_t::Identity());
+    }
+
+    lqr_t make_lqr(bicycle_t& bicycle) {
+        return lqr_t(bicycle,
+                lqr_t::state_cost_t::Identity(),
+                0.1 * (lqr_t::input_cost_t() << 0, 0, 0, 1).finished(),
+                bicycle_t::state_t::Zero(), horizon_length);
+    }
+
+    bicycle_t::output_t measurement() {
+        bicycle_t::output_t z;
+        z << 3*constants::as_radians, 5*constants::as_radians;
+        return z;
+    }
+
+    void kalman_time_update(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman = make_kalman(bicycle);
+        const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+        while (state.keep_running()) {
+            kalman.time_update(u);
+            benchmark::do_not_optimize(kalman.P());
+        }
+    }
+    BENCHMARK(kalman_time_update);
+
+    void kalman_measurement_update(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman = make_kalman(bicycle);
+        const bicycle_t::output_t z = measurement();
+        while (state.keep_running()) {
+            kalman.measurement_update(z);
+            benchmark::do_not_optimize(kalman.x());
+        }
+    }
+    BENCHMARK(kalman_measurement_update);
+
+    void kalman_time_measurement_update(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman = make_kalman(bicycle);
+        const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+        const bicycle_t::output_t z = measurement();
+        while (state.keep_running()) {
+            kalman.time_update(u);
+            kalman.measurement_update(z);
+            benchmark::do_not_optimize(kalman.x());
+        }
+    }
+    BENCHMARK(kalman_time_measurement_update);
+
+    void kalman_steady_state_update(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman = make_kalman(bicycle);
+        kalman.set_steady_state_mode(true);
+        const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+        const bicycle_t::output_t z = measurement();
+        while (!kalman.steady_state()) {
+            kalman.time_update(u);
+            kalman.measurement_update(z);
+        }
+        while (state.keep_running()) {
+            kalman.time_update(u);
+            kalman.measurement_update(z);
+            benchmark::do_not_optimize(kalman.x());
+        }
+    }
+    BENCHMARK(kalman_steady_state_update);
+
+    void square_root_kalman_update(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        const kalman_t kalman = make_kalman(bicycle);
+        square_root_kalman_t square_root_kalman(bicycle, kalman.x(), kalman.Q(), kalman.R(), kalman.P());
+        const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+        const bicycle_t::output_t z = measurement();
+        while (state.keep_running()) {
+            square_root_kalman.time_update(u);
+            square_root_kalman.measurement_update(z);
+            benchmark::do_not_optimize(square_root_kalman.x());
+        }
+    }
+    BENCHMARK(square_root_kalman_update);
+
+    /* the controller is constructed every iteration so the full horizon is iterated */
+    void lqr_control_calculate_cold(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        const bicycle_t::state_t x = bicycle_t::state_t::Constant(constants::as_radians);
+        while (state.keep_running()) {
+            lqr_t lqr = make_lqr(bicycle);
+            benchmark::do_not_optimize(lqr.control_calculate(x));
+        }
+    }
+    BENCHMARK(lqr_control_calculate_cold);
+
+    void lqr_control_calculate_steady_state(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        lqr_t lqr = make_lqr(bicycle);
+        const bicycle_t::state_t x = bicycle_t::state_t::Constant(constants::as_radians);
+        lqr.control_calculate(x);
+        while (state.keep_running()) {
+            benchmark::do_not_optimize(lqr.control_calculate(x));
+        }
+    }
+    BENCHMARK(lqr_control_calculate_steady_state);
+
+    /* speed changes every iteration so the gain is recalculated for a new system */
+    void lqr_control_calculate_speed_change(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        lqr_t lqr = make_lqr(bicycle);
+        const bicycle_t::state_t x = bicycle_t::state_t::Constant(constants::as_radians);
+        size_t i = 0;
+        while (state.keep_running()) {
+            bicycle.set_v(v0 + static_cast<real_t>(0.01)*(i++ & 1));
+            benchmark::do_not_optimize(lqr.control_calculate(x));
+        }
+    }
+    BENCHMARK(lqr_control_calculate_speed_change);
+
+    void lqr_riccati_doubling_cold(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        const bicycle_t::state_t x = bicycle_t::state_t::Constant(constants::as_radians);
+        while (state.keep_running()) {
+            lqr_t lqr = make_lqr(bicycle);
+            lqr.set_solver(lqr_t::solver_t::riccati_doubling);
+            benchmark::do_not_optimize(lqr.control_calculate(x));
+        }
+    }
+    BENCHMARK(lqr_riccati_doubling_cold);
+
+    void lqr_riccati_doubling_speed_change(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        lqr_t lqr = make_lqr(bicycle);
+        lqr.set_solver(lqr_t::solver_t::riccati_doubling);
+        const bicycle_t::state_t x = bicycle_t::state_t::Constant(constants::as_radians);
+        size_t i = 0;
+        while (state.keep_running()) {
+            bicycle.set_v(v0 + static_cast<real_t>(0.01)*(i++ & 1));
+            benchmark::do_not_optimize(lqr.control_calculate(x));
+        }
+    }
+    BENCHMARK(lqr_riccati_doubling_speed_change);
+} // namespace
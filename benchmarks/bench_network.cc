@@ -0,0 +1,140 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "benchmark.h"
+#include "network_server.h"
+#if defined(__linux__)
+#include "network_batch_server.h"
+#endif
+
+/*
+ * Benchmarks of UDP packet handling over loopback. Packets per second is the
+ * inverse of the time per iteration.
+ */
+namespace {
+    const uint16_t server_port = 9910;
+    const uint16_t remote_port = 9911;
+    using payload_t = std::array<double, 5>;
+
+    /* one packet in flight, from send until the receive function is called */
+    void network_udp_receive(benchmark::State& state) {
+        std::atomic<uint64_t> received(0);
+        network::udp::Server server(server_port, remote_port,
+                [&received](const uint8_t* data, size_t size) {
+                    benchmark::do_not_optimize(data[size - 1]);
+                    received.fetch_add(1, std::memory_order_release);
+                });
+
+        asio::io_service io_service;
+        asio::ip::udp::socket socket(io_service, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+        const asio::ip::udp::endpoint endpoint(asio::ip::address_v4::loopback(), server_port);
+        payload_t payload = {};
+        uint64_t sent = 0;
+        while (state.keep_running()) {
+            payload[0] = static_cast<double>(sent);
+            socket.send_to(asio::buffer(payload), endpoint);
+            ++sent;
+            // a lost packet would otherwise block the sender
+            const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+            while ((received.load(std::memory_order_acquire) < sent) &&
+                    (std::chrono::steady_clock::now() < timeout)) {
+                std::this_thread::yield();
+            }
+            sent = received.load(std::memory_order_acquire); // skip a lost packet
+        }
+    }
+    BENCHMARK(network_udp_receive);
+
+    /* asynchronous send followed by a wait for send completion */
+    void network_udp_send(benchmark::State& state) {
+        network::udp::Server server(server_port, remote_port,
+                [](const uint8_t* data, size_t size) {
+                    (void)data;
+                    (void)size;
+                });
+
+        // receive socket so that packets are not sent to a closed port
+        asio::io_service io_service;
+        asio::ip::udp::socket socket(io_service,
+                asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), remote_port));
+        const payload_t payload = {};
+        while (state.keep_running()) {
+            server.async_send(asio::buffer(payload));
+            server.wait_for_send_complete();
+        }
+    }
+    BENCHMARK(network_udp_send);
+
+#if defined(__linux__)
+    constexpr size_t window = 4*network::udp::BatchServer::batch_size; // messages in flight
+
+    /*
+     * Packets are sent one per system call to a Server with the same number
+     * of messages in flight as network_udp_batch, so that the difference
+     * between the two is due to recvmmsg and sendmmsg. Messages per second is
+     * the inverse of the time per iteration.
+     */
+    void network_udp_receive_window(benchmark::State& state) {
+        std::atomic<uint64_t> received(0);
+        network::udp::Server server(server_port, remote_port,
+                [&received](const uint8_t* data, size_t size) {
+                    benchmark::do_not_optimize(data[size - 1]);
+                    received.fetch_add(1, std::memory_order_release);
+                });
+
+        asio::io_service io_service;
+        asio::ip::udp::socket socket(io_service, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+        const asio::ip::udp::endpoint endpoint(asio::ip::address_v4::loopback(), server_port);
+        payload_t payload = {};
+        uint64_t sent = 0;
+        while (state.keep_running()) {
+            payload[0] = static_cast<double>(sent);
+            socket.send_to(asio::buffer(payload), endpoint);
+            ++sent;
+            if ((sent % network::udp::BatchServer::batch_size) == 0) {
+                // a lost packet would otherwise block the sender
+                const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+                while ((sent - received.load(std::memory_order_acquire) > window) &&
+                        (std::chrono::steady_clock::now() < timeout)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+    BENCHMARK(network_udp_receive_window);
+
+    /*
+     * Frames are sent in batches to a second batch server. The sender waits
+     * if more than a few batches are in flight so that the receive socket
+     * buffer does not overflow. Messages per second is the inverse of the time
+     * per iteration.
+     */
+    void network_udp_batch(benchmark::State& state) {
+        network::udp::BatchServer receiver(remote_port, server_port,
+                [](const network::udp::frame_header_t& header, const uint8_t* payload) {
+                    benchmark::do_not_optimize(payload[header.size - 1]);
+                });
+        network::udp::BatchServer sender(server_port, remote_port);
+
+        payload_t payload = {};
+        uint64_t sent = 0;
+        while (state.keep_running()) {
+            payload[0] = static_cast<double>(sent);
+            sender.async_send(network::udp::frame_t::state,
+                    static_cast<uint8_t>(sent % 32), asio::buffer(payload)); // 32 sources
+            ++sent;
+            if ((sent % network::udp::BatchServer::batch_size) == 0) {
+                // a lost frame would otherwise block the sender
+                const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+                while ((sent - receiver.receive_count() > window) &&
+                        (std::chrono::steady_clock::now() < timeout)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        sender.wait_for_send_complete();
+    }
+    BENCHMARK(network_udp_batch);
+#endif
+} // namespace
@@ -0,0 +1,90 @@
+#include "benchmark.h"
+#include "bicycle/whipple.h"
+#include "kalman.h"
+#include "lqr.h"
+#include "parameters.h"
+
+#include "flatbuffers/flatbuffers.h"
+#include "sample_generated.h"
+#include "sample_util.h" // only included in this file as it defines non-inline functions
+
+/*
+ * Benchmarks of flatbuffer serialization of control loop state.
+ */
+namespace {
+    using bicycle_t = model::BicycleWhipple;
+    using kalman_t = observer::Kalman<bicycle_t>;
+    using lqr_t = controller::Lqr<bicycle_t>;
+    using real_t = model::real_t;
+    const real_t v0 = 4.0; // forward speed [m/s]
+    const real_t dt = 1.0/200; // sample time [s]
+
+    void sample_create_kalman(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman(bicycle,
+                bicycle_t::state_t::Zero(),
+                parameters::defaultvalue::kalman::Q(dt),
+                parameters::defaultvalue::kalman::R,
+                bicycle_t::state_matrix_t::Identity());
+        flatbuffers::FlatBufferBuilder fbb;
+        while (state.keep_running()) {
+            fbb.Clear();
+            fbb.Finish(fbs::create_kalman(fbb, kalman));
+            benchmark::do_not_optimize(fbb.GetBufferPointer());
+        }
+    }
+    BENCHMARK(sample_create_kalman);
+
+    void sample_create_lqr(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        lqr_t lqr(bicycle,
+                lqr_t::state_cost_t::Identity(),
+                0.1 * (lqr_t::input_cost_t() << 0, 0, 0, 1).finished(),
+                bicycle_t::state_t::Zero(), 100);
+        flatbuffers::FlatBufferBuilder fbb;
+        while (state.keep_running()) {
+            fbb.Clear();
+            fbb.Finish(fbs::create_lqr(fbb, lqr));
+            benchmark::do_not_optimize(fbb.GetBufferPointer());
+        }
+    }
+    BENCHMARK(sample_create_lqr);
+
+    /* serialize the fields logged every sample in examples/full_fbs.cc */
+    void sample_create_sample(benchmark::State& state) {
+        bicycle_t bicycle(v0, dt);
+        kalman_t kalman(bicycle,
+                bicycle_t::state_t::Zero(),
+                parameters::defaultvalue::kalman::Q(dt),
+                parameters::defaultvalue::kalman::R,
+                bicycle_t::state_matrix_t::Identity());
+        lqr_t lqr(bicycle,
+                lqr_t::state_cost_t::Identity(),
+                0.1 * (lqr_t::input_cost_t() << 0, 0, 0, 1).finished(),
+                bicycle_t::state_t::Zero(), 100);
+        const bicycle_t::state_t x = bicycle_t::state_t::Zero();
+        const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+        const bicycle_t::output_t z = bicycle_t::output_t::Zero();
+        const bicycle_t::auxiliary_state_t aux = bicycle_t::auxiliary_state_t::Zero();
+        flatbuffers::FlatBufferBuilder fbb;
+        uint32_t sample = 0;
+        while (state.keep_running()) {
+            fbb.Clear();
+            auto kalman_location = fbs::create_kalman(fbb, kalman,
+                    true, true, false, false, true); // x, P, Q, R, K
+            auto lqr_location = fbs::create_lqr(fbb, lqr,
+                    false, true, true, false, false, true, // n, r, P, Q, R, K
+                    false, true); // Qi, q
+            auto fbs_state = fbs::state(x);
+            auto fbs_input = fbs::input(u);
+            auto fbs_measurement = fbs::output(z);
+            auto fbs_auxiliary_state = fbs::auxiliary_state(aux);
+            fbb.Finish(fbs::CreateSample(fbb, sample++, 0,
+                        0, kalman_location, lqr_location,
+                        &fbs_state, &fbs_input, 0, &fbs_measurement,
+                        &fbs_auxiliary_state));
+            benchmark::do_not_optimize(fbb.GetBufferPointer());
+        }
+    }
+    BENCHMARK(sample_create_sample);
+} // namespace
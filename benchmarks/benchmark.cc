@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "allocation.h"
+#include "benchmark.h"
+
+namespace {
+    struct benchmark_t {
+        const char* name;
+        benchmark::function_t function;
+    };
+
+    struct result_t {
+        std::string name;
+        size_t iterations;
+        double ns_per_iteration;
+        double cycles_per_iteration;
+        double allocations_per_iteration;
+    };
+
+    enum class format_t { console, csv, json };
+
+    // constructed on first use as registration occurs during static initialization
+    std::vector<benchmark_t>& benchmarks() {
+        static std::vector<benchmark_t> b;
+        return b;
+    }
+
+    uint64_t cycle_count() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    result_t run(const benchmark_t& b, double min_time) {
+        constexpr size_t max_iterations = 1000000000;
+        size_t iterations = 1;
+        while (true) {
+            benchmark::State state(iterations);
+            b.function(state);
+            const double elapsed = state.elapsed_seconds();
+            if ((elapsed >= min_time) || (iterations >= max_iterations)) {
+                const double n = static_cast<double>(state.iterations());
+                return result_t{b.name, state.iterations(),
+                    1e9*elapsed/n,
+                    static_cast<double>(state.elapsed_cycles())/n,
+                    static_cast<double>(state.allocations())/n};
+            }
+            // predict the number of iterations needed, growing at most 10x per attempt
+            double multiplier = 10;
+            if (elapsed > 0) {
+                multiplier = std::min(multiplier, 1.4*min_time/elapsed);
+            }
+            iterations = std::min(max_iterations, std::max(iterations + 1,
+                        static_cast<size_t>(iterations*multiplier)));
+        }
+    }
+
+    void print_header(format_t format) {
+        switch (format) {
+            case format_t::console:
+                std::cout << std::left << std::setw(40) << "benchmark" << std::right <<
+                    std::setw(14) << "iterations" <<
+                    std::setw(14) << "ns/op" <<
+                    std::setw(14) << "cycles/op" <<
+                    std::setw(14) << "allocs/op" << "\n" <<
+                    std::string(96, '-') << std::endl;
+                break;
+            case format_t::csv:
+                std::cout << "name,iterations,ns_per_op,cycles_per_op,allocations_per_op" << std::endl;
+                break;
+            case format_t::json:
+                std::cout << "{\n  \"context\": {\n" <<
+                    "    \"timestamp_counter\": " <<
+                    ((cycle_count() != 0) ? "true" : "false") << "\n  },\n" <<
+                    "  \"benchmarks\": [";
+                break;
+        }
+    }
+
+    void print_result(format_t format, const result_t& r, bool first) {
+        switch (format) {
+            case format_t::console:
+                std::cout << std::left << std::setw(40) << r.name << std::right <<
+                    std::setw(14) << r.iterations << std::fixed <<
+                    std::setw(14) << std::setprecision(1) << r.ns_per_iteration <<
+                    std::setw(14) << std::setprecision(0) << r.cycles_per_iteration <<
+                    std::setw(14) << std::setprecision(2) << r.allocations_per_iteration <<
+                    std::defaultfloat << std::endl;
+                break;
+            case format_t::csv:
+                std::cout << r.name << "," << r.iterations << "," <<
+                    r.ns_per_iteration << "," << r.cycles_per_iteration << "," <<
+                    r.allocations_per_iteration << std::endl;
+                break;
+            case format_t::json:
+                std::cout << (first ? "\n" : ",\n") <<
+                    "    {\n" <<
+                    "      \"name\": \"" << r.name << "\",\n" <<
+                    "      \"iterations\": " << r.iterations << ",\n" <<
+                    "      \"ns_per_op\": " << r.ns_per_iteration << ",\n" <<
+                    "      \"cycles_per_op\": " << r.cycles_per_iteration << ",\n" <<
+                    "      \"allocations_per_op\": " << r.allocations_per_iteration << "\n" <<
+                    "    }" << std::flush;
+                break;
+        }
+    }
+
+    void print_footer(format_t format) {
+        if (format == format_t::json) {
+            std::cout << "\n  ]\n}" << std::endl;
+        }
+    }
+
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options]\n";
+        std::cerr << "\nRun registered microbenchmarks and report time, timestamp counter cycles,\n" <<
+            "and heap allocations per iteration.\n\n";
+        std::cerr << "Options:\n";
+        std::cerr << "  --filter=<string>          only run benchmarks containing string\n";
+        std::cerr << "  --format=<console|csv|json> output format (default: console)\n";
+        std::cerr << "  --min_time=<seconds>       minimum time per benchmark (default: 0.5)\n";
+        std::cerr << "  --list                     list benchmarks and exit\n";
+    }
+} // namespace
+
+namespace benchmark {
+
+State::State(size_t max_iterations) :
+    m_max_iterations(max_iterations),
+    m_iterations(0),
+    m_running(false),
+    m_start_cycles(0),
+    m_start_allocations(0),
+    m_elapsed_time(clock::duration::zero()),
+    m_elapsed_cycles(0),
+    m_allocations(0) { }
+
+bool State::keep_running() {
+    if (m_iterations == 0 && !m_running) {
+        start();
+    }
+    if (m_iterations < m_max_iterations) {
+        ++m_iterations;
+        return true;
+    }
+    if (m_running) {
+        stop();
+    }
+    return false;
+}
+
+void State::pause_timing() {
+    stop();
+}
+
+void State::resume_timing() {
+    start();
+}
+
+size_t State::iterations() const {
+    return m_iterations;
+}
+
+double State::elapsed_seconds() const {
+    return std::chrono::duration<double>(m_elapsed_time).count();
+}
+
+uint64_t State::elapsed_cycles() const {
+    return m_elapsed_cycles;
+}
+
+uint64_t State::allocations() const {
+    return m_allocations;
+}
+
+void State::start() {
+    m_running = true;
+    m_start_allocations = allocation_count();
+    m_start_time = clock::now();
+    m_start_cycles = cycle_count();
+}
+
+void State::stop() {
+    const uint64_t cycles = cycle_count();
+    const clock::time_point time = clock::now();
+    m_elapsed_cycles += cycles - m_start_cycles;
+    m_elapsed_time += time - m_start_time;
+    m_allocations += allocation_count() - m_start_allocations;
+    m_running = false;
+}
+
+int register_benchmark(const char* name, function_t function) {
+    benchmarks().push_back(benchmark_t{name, function});
+    return 0;
+}
+
+uint64_t allocation_count() {
+    return allocation::thread_count();
+}
+
+} // namespace benchmark
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    format_t format = format_t::console;
+    double min_time = 0.5;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string(argv[i]);
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg == "--format=console") {
+            format = format_t::console;
+        } else if (arg == "--format=csv") {
+            format = format_t::csv;
+        } else if (arg == "--format=json") {
+            format = format_t::json;
+        } else if (arg.compare(0, 11, "--min_time=") == 0) {
+            min_time = std::atof(arg.substr(11).c_str());
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<benchmark_t> selected;
+    std::copy_if(benchmarks().cbegin(), benchmarks().cend(), std::back_inserter(selected),
+            [&filter](const benchmark_t& b) {
+                return std::string(b.name).find(filter) != std::string::npos;
+            });
+
+    if (list) {
+        for (const auto& b: selected) {
+            std::cout << b.name << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    print_header(format);
+    bool first = true;
+    for (const auto& b: selected) {
+        print_result(format, run(b, min_time), first);
+        first = false;
+    }
+    print_footer(format);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+/*
+ * Minimal microbenchmark harness modeled after Google Benchmark.
+ *
+ * A benchmark is a function taking a State reference and running the code to
+ * be measured in a loop while State::keep_running() returns true. Setup code
+ * placed before the loop is not measured. Benchmarks are registered with the
+ * BENCHMARK() macro and run by the main() function defined in benchmark.cc.
+ *
+ * The number of iterations is increased until the measured time exceeds the
+ * minimum benchmark time. For each benchmark the harness reports time per
+ * iteration, timestamp counter cycles per iteration (x86 only), and heap
+ * allocations per iteration. Results can be printed as a table, CSV, or JSON
+ * to allow tracking across commits.
+ */
+namespace benchmark {
+
+class State {
+    public:
+        State(size_t max_iterations);
+
+        bool keep_running();
+        void pause_timing();
+        void resume_timing();
+
+        size_t iterations() const;
+        double elapsed_seconds() const;
+        uint64_t elapsed_cycles() const;
+        uint64_t allocations() const;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        size_t m_max_iterations;
+        size_t m_iterations;
+        bool m_running;
+        clock::time_point m_start_time;
+        uint64_t m_start_cycles;
+        uint64_t m_start_allocations;
+        clock::duration m_elapsed_time;
+        uint64_t m_elapsed_cycles;
+        uint64_t m_allocations;
+
+        void start();
+        void stop();
+};
+
+using function_t = void (*)(State&);
+int register_benchmark(const char* name, function_t function);
+
+// number of heap allocations made by the current thread, see allocation.h
+uint64_t allocation_count();
+
+// prevent the compiler from optimizing away a value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// prevent the compiler from knowing the value of a pointer, e.g. the dynamic
+// type of the object it points to
+template <typename T>
+inline T* hide_pointer(T* pointer) {
+    asm volatile("" : "+r"(pointer));
+    return pointer;
+}
+
+// prevent the compiler from reordering memory operations across this point
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+} // namespace benchmark
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_(a, b)
+#define BENCHMARK(function) \
+    static int BENCHMARK_CONCAT(benchmark_registration_, __LINE__) = \
+        ::benchmark::register_benchmark(#function, function)
@@ -0,0 +1,72 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include "bicycle/batch.h"
+#include "bicycle/whipple.h"
+#include "parameters.h"
+
+namespace {
+    const double fs = 200; // sample rate [Hz]
+    const double dt = 1.0/fs; // sample time [s]
+    const size_t N = 1000; // length of simulation in samples
+    const size_t batch_sizes[] = {1, 4, 16, 64, 256, 1024, 4096};
+
+    using clock = std::chrono::high_resolution_clock;
+} // namespace
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> rv(1.0, 9.0); // forward speed [m/s]
+
+    std::cout << "simulating " << N << " steps at " << fs << " Hz per bicycle" << std::endl;
+    std::cout << "batch size, scalar steps/s, batch steps/s, speedup" << std::endl;
+
+    for (auto size: batch_sizes) {
+        std::vector<std::unique_ptr<model::BicycleWhipple>> bicycles;
+        std::vector<model::Bicycle::state_t, Eigen::aligned_allocator<model::Bicycle::state_t>> states;
+        model::BicycleBatch batch(size);
+
+        model::Bicycle::state_t x0;
+        x0 << 0, 3, 5, 0, 0; // define in degrees
+        x0 *= constants::as_radians;
+        for (size_t i = 0; i < size; ++i) {
+            bicycles.emplace_back(new model::BicycleWhipple(rv(gen), dt));
+            states.push_back(x0);
+            batch.set_bicycle(i, *bicycles.back());
+            batch.set_state(i, x0);
+        }
+
+        // update through the virtual interface of the base class
+        auto start = clock::now();
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t i = 0; i < size; ++i) {
+                const model::Bicycle& bicycle = *bicycles[i];
+                states[i] = bicycle.update_state(states[i], model::Bicycle::input_t::Zero(),
+                        model::Bicycle::measurement_t::Zero());
+            }
+        }
+        std::chrono::duration<double> scalar_time = clock::now() - start;
+
+        start = clock::now();
+        batch.update_state(N);
+        std::chrono::duration<double> batch_time = clock::now() - start;
+
+        const double steps = static_cast<double>(size*N);
+        std::cout << size << ", " <<
+            steps/scalar_time.count() << ", " <<
+            steps/batch_time.count() << ", " <<
+            scalar_time.count()/batch_time.count() << std::endl;
+
+        // prevent the simulation loops from being optimized away
+        if ((batch.state(0) - states[0]).norm() > 1e-3) {
+            std::cout << "batch and scalar simulation differ" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
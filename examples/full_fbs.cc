@@ -5,13 +5,16 @@
 #include <iostream>
 #include <random>
 
+#include "allocation.h"
 #include "bicycle/whipple.h"
 #include "kalman.h"
 #include "lqr.h"
 #include "parameters.h"
 
 #include "flatbuffers/flatbuffers.h"
+#include "sample_delta.h"
 #include "sample_log_generated.h"
+#include "sample_log_writer.h"
 #include "sample_util.h"
 
 
@@ -48,10 +51,8 @@ namespace {
     bicycle_t::state_t x; // yaw angle, roll angle, steer angle, roll rate, steer rate
     bicycle_t::auxiliary_state_t aux; // x, y, rear wheel angle, pitch angle
 
-    /* used for serializing/logging */
-    flatbuffers::FlatBufferBuilder builder;
-    flatbuffers::FlatBufferBuilder log_builder;
-    flatbuffers::Offset<fbs::SampleBuffer> sample_locations[N];
+    /* samples are streamed to the log file as they are serialized */
+    const char* log_filename = "samples_full.bin";
 
     /* reference trajectory (yaw angle) */
     auto reference = [](double t) {
@@ -118,71 +119,113 @@ int main(int argc, char* argv[]) {
      * bicycle, kalman, and lqr objects must be serialized first
      */
 
+    fbs::SampleLogWriter log_writer(log_filename);
     size_t current_sample = 0;
-    auto bicycle_location = fbs::create_bicycle(builder, bicycle);
-    auto kalman_location = fbs::create_kalman(builder, kalman);
-    auto lqr_location = fbs::create_lqr(builder, lqr);
+    uint32_t bicycle_revision = bicycle.revision(); // bicycle is serialized only when changed
+
+    /* converged covariance and gain matrices are serialized only when changed or in a keyframe */
+    fbs::SampleDeltaEncoder log_encoder;
+    log_encoder.next_sample(); // the first sample is a keyframe and all fields are serialized
+    log_encoder.update(fbs::delta_field_t::kalman_error_covariance, fbs::symmetric_state_matrix(kalman.P()));
+    log_encoder.update(fbs::delta_field_t::kalman_gain, fbs::kalman_gain_matrix(kalman.K()));
+    log_encoder.update(fbs::delta_field_t::lqr_horizon_cost, fbs::symmetric_state_matrix(lqr.P()));
+    log_encoder.update(fbs::delta_field_t::lqr_gain, fbs::lqr_gain_matrix(lqr.K()));
+
+    flatbuffers::FlatBufferBuilder* builder = log_writer.acquire();
+    auto bicycle_location = fbs::create_bicycle(*builder, bicycle);
+    auto kalman_location = fbs::create_kalman(*builder, kalman);
+    auto lqr_location = fbs::create_lqr(*builder, lqr);
     auto fbs_state = fbs::state(x);
     auto fbs_input = fbs::input(bicycle_t::input_t::Zero());
     auto fbs_measurement = fbs::output(bicycle_t::output_t::Zero());
     auto fbs_auxiliary_state = fbs::auxiliary_state(aux);
-    builder.Finish(fbs::CreateSample(builder, current_sample, 0,
+    builder->Finish(fbs::CreateSample(*builder, current_sample++, 0,
                 bicycle_location, kalman_location, lqr_location,
                 &fbs_state, 0, 0, &fbs_measurement, &fbs_auxiliary_state));
+    log_writer.commit();
 
-    auto data = log_builder.CreateVector(builder.GetBufferPointer(), builder.GetSize());
-    sample_locations[current_sample++] = fbs::CreateSampleBuffer(log_builder, data);
+    /* log builders may grow on first use so allocations are only checked after each has been used */
+    const size_t warmup_samples = fbs::SampleLogWriter::default_ring_size;
+    uint64_t warmup_violations = 0;
 
     auto disc_start = std::chrono::system_clock::now();
     for (; current_sample < N; ++current_sample) {
-        auto comp_start = std::chrono::high_resolution_clock::now();
-        /* compute control law */
-        auto u = lqr.control_calculate(kalman.x(), reference(dt*current_sample));
-
-        /* system simulate */
-        bicycle_t::full_state_t x_full = bicycle_t::make_full_state(aux, x);
-        x_full = bicycle.integrate_full_state(x_full, u, bicycle.dt());
-        aux = bicycle_t::get_auxiliary_state_part(x_full);
-        x = bicycle_t::get_state_part(x_full);
-
-        /* measure output with noise */
-        auto z = bicycle.calculate_output(x);
-        z(0) += rn0(gen);
-        z(1) += rn1(gen);
-
-        /* observer time/measurement update */
-        kalman.time_update(u);
-        kalman.measurement_update(z);
-
-        builder.Clear();
-
-        kalman_location = fbs::create_kalman(builder, kalman,
-                true, true, false, false, true); // x, P, Q, R, K
-        lqr_location = fbs::create_lqr(builder, lqr,
-                false, true, true, false, false, true, // n, r, P, Q, R, K
-                false, true); // Qi, q
-
-        /* skip output as we can get it from state */
-        fbs_state = fbs::state(x);
-        fbs_input = fbs::input(u);
-        fbs_measurement = fbs::output(z);
-        fbs_auxiliary_state = fbs::auxiliary_state(aux);
-
-        auto comp_stop = std::chrono::high_resolution_clock::now();
-        auto comp_time = std::chrono::duration<double>(comp_stop - comp_start);
-        builder.Finish(fbs::CreateSample(builder, current_sample, comp_time.count(),
-                    0, kalman_location, lqr_location,
-                    &fbs_state, &fbs_input, 0, &fbs_measurement,
-                    &fbs_auxiliary_state));
-        /* sample is serialized */
-
-        //uint8_t* p = nullptr;
-        //auto data = log_builder.CreateUninitializedVector<uint8_t>(builder.GetSize(), &p);
-        //std::memcpy(p, builder.GetBufferPointer(), builder.GetSize());
-        // Using CreateUninitializedVector occasionally causes the sample to be
-        // written incorrectly.
-        auto data = log_builder.CreateVector(builder.GetBufferPointer(), builder.GetSize());
-        sample_locations[current_sample] = fbs::CreateSampleBuffer(log_builder, data);
+        if (current_sample == warmup_samples) {
+            warmup_violations = allocation::realtime_violations();
+        }
+        /*
+         * No heap allocation is expected from control computation to sample
+         * serialization. The sample is written to file by the log writer
+         * thread and this loop does not wait on the file.
+         */
+        {
+            allocation::RealtimeSection realtime_section("full_fbs loop",
+                    allocation::RealtimeSection::policy_t::count);
+            auto comp_start = std::chrono::high_resolution_clock::now();
+            /* compute control law */
+            auto u = lqr.control_calculate(kalman.x(), reference(dt*current_sample));
+
+            /* system simulate */
+            bicycle_t::full_state_t x_full = bicycle_t::make_full_state(aux, x);
+            x_full = bicycle.integrate_full_state(x_full, u, bicycle.dt());
+            aux = bicycle_t::get_auxiliary_state_part(x_full);
+            x = bicycle_t::get_state_part(x_full);
+
+            /* measure output with noise */
+            auto z = bicycle.calculate_output(x);
+            z(0) += rn0(gen);
+            z(1) += rn1(gen);
+
+            /* observer time/measurement update */
+            kalman.time_update(u);
+            kalman.measurement_update(z);
+
+            /* the sample is dropped if the log writer has fallen behind */
+            builder = log_writer.acquire();
+            if (builder == nullptr) {
+                continue;
+            }
+
+            bicycle_location = flatbuffers::Offset<fbs::Bicycle>();
+            if (bicycle.revision() != bicycle_revision) {
+                bicycle_revision = bicycle.revision();
+                bicycle_location = fbs::create_bicycle(*builder, bicycle,
+                        true, true, false, false, false, false); // dt, v, M, C1, K0, K2
+            }
+            /* constant costs and covariances are serialized only in keyframes */
+            log_encoder.next_sample();
+            const bool keyframe = log_encoder.keyframe();
+            kalman_location = fbs::create_kalman(*builder, kalman,
+                    true, // x
+                    log_encoder.update(fbs::delta_field_t::kalman_error_covariance,
+                        fbs::symmetric_state_matrix(kalman.P())), // P
+                    keyframe, keyframe, // Q, R
+                    log_encoder.update(fbs::delta_field_t::kalman_gain,
+                        fbs::kalman_gain_matrix(kalman.K()))); // K
+            lqr_location = fbs::create_lqr(*builder, lqr,
+                    false, true, // n, r
+                    log_encoder.update(fbs::delta_field_t::lqr_horizon_cost,
+                        fbs::symmetric_state_matrix(lqr.P())), // P
+                    keyframe, keyframe, // Q, R
+                    log_encoder.update(fbs::delta_field_t::lqr_gain,
+                        fbs::lqr_gain_matrix(lqr.K())), // K
+                    keyframe, true); // Qi, q
+
+            /* skip output as we can get it from state */
+            fbs_state = fbs::state(x);
+            fbs_input = fbs::input(u);
+            fbs_measurement = fbs::output(z);
+            fbs_auxiliary_state = fbs::auxiliary_state(aux);
+
+            auto comp_stop = std::chrono::high_resolution_clock::now();
+            auto comp_time = std::chrono::duration<double>(comp_stop - comp_start);
+            builder->Finish(fbs::CreateSample(*builder, current_sample, comp_time.count(),
+                        bicycle_location, kalman_location, lqr_location,
+                        &fbs_state, &fbs_input, 0, &fbs_measurement,
+                        &fbs_auxiliary_state, !keyframe));
+            log_writer.commit();
+            /* sample is serialized */
+        }
     }
 
     auto disc_stop = std::chrono::system_clock::now();
@@ -193,22 +236,29 @@ int main(int argc, char* argv[]) {
     std::cout << "simulation duration: " <<
         std::chrono::duration_cast<std::chrono::microseconds>(disc_time).count() <<
         " us" << std::endl;
-
-    auto samples_vector = log_builder.CreateVector(sample_locations, N);
-    auto log_location = fbs::CreateSampleLog(log_builder, samples_vector);
-    log_builder.Finish(log_location, fbs::SampleLogIdentifier());
+    uint64_t violations = 0;
+    if (allocation::tracking_enabled()) {
+        violations = allocation::realtime_violations() - warmup_violations;
+        std::cout << "loop iterations with heap allocations after warmup: " <<
+            violations << std::endl;
+    }
 
     {
         disc_start = std::chrono::system_clock::now();
-        auto f = std::fopen("samples_full.bin", "wb");
-        std::fwrite(log_builder.GetBufferPointer(), sizeof(char), log_builder.GetSize(), f);
-        std::fclose(f);
+        log_writer.close();
         disc_stop = std::chrono::system_clock::now();
         disc_time = disc_stop - disc_start;
-        std::cout << "write to file took: " <<
+        std::cout << "closing log file took: " <<
             std::chrono::duration_cast<std::chrono::microseconds>(disc_time).count() <<
             " us" << std::endl;
+        std::cout << log_writer.samples_written() << " samples written to '" <<
+            log_filename << "', " << log_writer.samples_dropped() <<
+            " samples dropped" << std::endl;
+        if (log_writer.error()) {
+            std::cerr << "error writing log file '" << log_filename <<
+                "', log is incomplete" << std::endl;
+        }
     }
 
-    return EXIT_SUCCESS;
+    return ((violations == 0) && !log_writer.error()) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -2,6 +2,7 @@
 #include <chrono>
 #include <iostream>
 #include <random>
+#include "allocation.h"
 #include "bicycle/whipple.h"
 #include "lqr.h"
 #include "kalman.h"
@@ -58,6 +59,9 @@ int main(int argc, char* argv[]) {
 
     auto start = std::chrono::system_clock::now();
     for (; it_x != system_state.end(); ++it_x, ++it_xh) {
+        // no heap allocation is expected in the loop
+        allocation::RealtimeSection realtime_section("lqr_kalman loop");
+
         // compute control law
         auto u = lqr.control_calculate(kalman.x());
 
@@ -87,6 +91,10 @@ int main(int argc, char* argv[]) {
     std::cout << "time per iteration: " <<
         std::chrono::duration_cast<std::chrono::microseconds>(duration/N).count() <<
         " us" << std::endl << std::endl;
+    if (allocation::tracking_enabled()) {
+        std::cout << "loop iterations with heap allocations: " <<
+            allocation::realtime_violations() << std::endl << std::endl;
+    }
 
     std::cout << "state at end of simulation (" << N << " steps @ " << fs << " Hz)" << std::endl;
     std::cout << "final state:          [" << system_state.back().transpose() * constants::as_degrees << "]' deg" << std::endl;
@@ -15,15 +15,23 @@ namespace {
 
     std::array<model::BicycleWhipple::state_t, N> discrete_time_system_state_n;
     std::array<int32_t, N> simulation_loop_period;
-    std::array<int32_t, N> transmit_loop_period;
+
+    // transmitted samples are copied so the state must be trivially copyable
+    using sample_t = std::array<double, model::BicycleWhipple::n>;
+    using server_t = network::udp::SnapshotTransmitServer<sample_t>;
 
     void update(const asio::error_code& error, asio::high_resolution_timer* timer,
             size_t* count, model::BicycleWhipple* bicycle, model::BicycleWhipple::state_t* x,
-            std::chrono::high_resolution_clock::time_point time) {
+            server_t* server, std::chrono::high_resolution_clock::time_point time) {
         if (!error) {
             if (*count < N) {
                 *x = bicycle->update_state(*x);
 
+                sample_t sample;
+                Eigen::Map<Eigen::Matrix<double, model::BicycleWhipple::n, 1>>(sample.data()) =
+                    x->cast<double>();
+                server->push(sample);
+
                 auto now = std::chrono::high_resolution_clock::now();
                 auto dt = std::chrono::duration_cast<std::chrono::microseconds>(now - time).count();
 
@@ -37,6 +45,7 @@ namespace {
                             count,
                             bicycle,
                             x,
+                            server,
                             now));
 
             }
@@ -55,23 +64,12 @@ int main(int argc, char* argv[]) {
     x << 0, 0, 10, 10, 0; // define in degrees
     x *= constants::as_radians;
 
-    using clock = std::chrono::high_resolution_clock;
-    auto start = clock::now();
-    auto i = transmit_loop_period.begin();
+    auto start = std::chrono::high_resolution_clock::now();
 
-    // periodic transmit buffer function
-    auto f = [&x, &i, &start]() -> asio::const_buffer {
-        auto now = clock::now();
-        *i++ = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
-        start = now;
-        return asio::const_buffer(static_cast<void*>(x.data()), x.size()*sizeof(double));
-    };
-
-    network::udp::PeriodicTransmitServer<decltype(f)> server(
+    server_t server(
             network::udp::default_server_port,
             network::udp::default_remote_port,
-            transmission_period,
-            std::cref(f));
+            transmission_period);
 
     asio::io_service io_service;
     asio::high_resolution_timer simulation_timer(io_service, simulation_period);
@@ -83,6 +81,7 @@ int main(int argc, char* argv[]) {
                 &count,
                 &bicycle,
                 &x,
+                &server,
                 start));
 
     io_service.run();
@@ -93,12 +92,6 @@ int main(int argc, char* argv[]) {
     }
 
     std::cout << "\n";
-    std::cout << "transmission loop periods (us): ";
-    for (auto dt: transmit_loop_period) {
-        if (dt == 0) {
-            break;
-        }
-        std::cout << dt << " ";
-    }
-    std::cout << "\n";
+    std::cout << "pushed samples: " << server.push_count() << "\n";
+    std::cout << "transmitted samples: " << server.transmit_count() << "\n";
 }
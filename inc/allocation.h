@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+/*
+ * Optional heap allocation tracking.
+ *
+ * If BICYCLE_TRACK_ALLOCATIONS is defined when compiling allocation.cc, the
+ * global operator new and operator delete are replaced with versions that
+ * count allocations per process and per thread. Otherwise no replacement is
+ * made, count() and thread_count() always return zero, and RealtimeSection
+ * does nothing.
+ *
+ * A RealtimeSection marks a scope, such as a single iteration of a control
+ * loop, in which no heap allocation is expected to occur on the current
+ * thread. Allocations made in the scope are handled according to the section
+ * policy: recorded only, reported to stderr when the section ends, or reported
+ * and aborted at the allocation site so the allocation can be found with a
+ * debugger. Sections may be nested.
+ *
+ * Memory allocated directly with malloc (e.g. by Eigen::aligned_allocator) is
+ * not counted.
+ */
+namespace allocation {
+
+bool tracking_enabled();
+uint64_t count(); // number of allocations by all threads
+uint64_t thread_count(); // number of allocations by the current thread
+uint64_t realtime_violations(); // number of sections ended with allocations, all threads
+
+class RealtimeSection {
+    public:
+        enum class policy_t {
+            count, // record allocations only
+            log, // report allocations when the section ends
+            abort // report and abort on first allocation
+        };
+
+        RealtimeSection(const char* name, policy_t policy = policy_t::log);
+        ~RealtimeSection();
+        RealtimeSection(const RealtimeSection&) = delete;
+        RealtimeSection& operator=(const RealtimeSection&) = delete;
+
+        // number of allocations by the current thread since section start
+        uint64_t allocations() const;
+
+    private:
+        const char* m_name;
+        policy_t m_policy;
+        uint64_t m_start_count;
+        const char* m_previous_name;
+        bool m_previous_abort;
+}; // class RealtimeSection
+
+} // namespace allocation
@@ -23,6 +23,8 @@ class BicycleArend final : public Bicycle {
 
         virtual state_t update_state(const state_t& x, const input_t& u, const measurement_t& z) const override;
         virtual full_state_t integrate_full_state(const full_state_t& xf, const input_t& u, real_t t, const measurement_t& z) const override;
+        virtual full_state_t integrate_full_state_trajectory(const full_state_t& xf, const input_t& u, real_t t,
+                real_t t_sample, full_state_trajectory_t* trajectory, const measurement_t& z) const override;
 
         virtual void set_state_space() override;
 
@@ -34,9 +36,10 @@ class BicycleArend final : public Bicycle {
     private:
         /*
          * Some steppers have internal state and so none have do_step() defined as const.
-         * While internal state may be changed from multiple calls to do_step(), the
-         * state is 'reset' when all calls to do_step() are completed and the integration
-         * has completed, thus we mark them as mutable as we do not perceive the internal
+         * The Dormand-Prince stepper caches the derivative at the end of a step
+         * (first same as last) and reuses it in the next step. The stepper is
+         * reset before each integration so that results do not depend on previous
+         * calls, thus we mark them as mutable as we do not perceive the internal
          * state change of the stepper.
          */
         mutable boost::numeric::odeint::runge_kutta_dopri5<
@@ -45,6 +48,7 @@ class BicycleArend final : public Bicycle {
         second_order_matrix_t m_K;
 
         void set_K();
+        auto full_state_system(const measurement_t& z) const;
 };
 
 } // namespace model
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <Eigen/Core>
+#include "bicycle/bicycle.h"
+
+namespace model {
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+/*
+ * This class simulates a batch of discrete time bicycle models in parallel.
+ *
+ * The discrete state space matrices and states of all bicycles are stored in
+ * structure-of-arrays layout: element (i, j) of Ad for bicycle k is stored at
+ * index (i*n + j)*stride + k, where stride is size() rounded up to a multiple
+ * of the lane block size. A state update then consists of n*(n + m)
+ * multiply-add operations over contiguous arrays with one bicycle per lane,
+ * allowing the compiler to vectorize the update across bicycles. On x86-64
+ * the update is compiled for AVX-512, AVX2, and the baseline instruction set
+ * and the widest version supported by the processor is selected at runtime.
+ *
+ * Multiple iterations are performed one block of lanes at a time so that the
+ * matrices and states of a block remain in cache. Inputs are held constant
+ * over the iterations.
+ *
+ * Model parameters and discretization are obtained from Bicycle objects, so
+ * each lane may use a different parameter set, speed, or sampling time.
+ */
+class BicycleBatch {
+    public:
+        static constexpr unsigned int n = Bicycle::n;
+        static constexpr unsigned int m = Bicycle::m;
+        using state_t = Bicycle::state_t;
+        using input_t = Bicycle::input_t;
+
+        BicycleBatch(size_t size);
+
+        // functions taking an index throw std::out_of_range if index >= size()
+        void set_bicycle(size_t index, const Bicycle& bicycle); // copy Ad and Bd of bicycle
+        void set_state(size_t index, const state_t& x);
+        void set_input(size_t index, const input_t& u);
+        void set_state_element(Bicycle::state_index_t field, real_t value); // set for all bicycles
+        void set_input_element(Bicycle::input_index_t field, real_t value); // set for all bicycles
+
+        void update_state(); // x[k+1] = Ad*x[k] + Bd*u[k] for all bicycles
+        void update_state(size_t iterations);
+
+        // accessors
+        size_t size() const;
+        state_t state(size_t index) const;
+        input_t input(size_t index) const;
+        const real_t* state_data(Bicycle::state_index_t field) const; // contiguous array of size()
+        real_t* input_data(Bicycle::input_index_t field); // contiguous array of size()
+
+    private:
+        using real_vector_t = std::vector<real_t, Eigen::aligned_allocator<real_t>>;
+        static constexpr size_t block_size = 64; // number of lanes updated together
+
+        size_t m_size;
+        size_t m_stride;
+        real_vector_t m_Ad;
+        real_vector_t m_Bd;
+        real_vector_t m_x;
+        real_vector_t m_u;
+
+        void check_index(size_t index) const;
+}; // class BicycleBatch
+
+inline size_t BicycleBatch::size() const {
+    return m_size;
+}
+#endif
+
+} // namespace model
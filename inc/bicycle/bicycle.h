@@ -1,7 +1,14 @@
 #pragma once
+#include <cmath>
+#include <vector>
 #include <Eigen/Core>
 #include <Eigen/Cholesky>
+#include "constants.h"
 #include "discrete_linear.h"
+#include "pitch_table.h"
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+#include "discretization_table.h"
+#endif
 
 namespace model {
 
@@ -23,8 +30,10 @@ namespace model {
 class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
     public:
         static constexpr unsigned int p = 4;
+        static constexpr unsigned int ni = 1; // yaw angle does not feed back
         using auxiliary_state_t = Eigen::Matrix<real_t, p, 1>;
         using full_state_t = Eigen::Matrix<real_t, p + n, 1>;
+        using full_state_trajectory_t = std::vector<full_state_t, Eigen::aligned_allocator<full_state_t>>;
 
         /* state enum definitions */
         enum class input_index_t: uint8_t {
@@ -85,6 +94,18 @@ class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
         /* pure virtual state and output functions repeated */
         virtual state_t update_state(const state_t& x, const input_t& u, const measurement_t& z) const override = 0;
         virtual full_state_t integrate_full_state(const full_state_t& x, const input_t& u, real_t t, const measurement_t& z) const = 0;
+        /*
+         * Integrate the full state over time t with an error controlled
+         * Dormand-Prince stepper with dense output. Step sizes are chosen to
+         * satisfy the integration tolerances and do not depend on the sample
+         * time. The full states at times 0, t_sample, 2*t_sample, ... up to t
+         * are interpolated from the dense output and appended to trajectory.
+         * The full state at time t is returned. The default implementation
+         * integrates the linear model A(v), B(v) with the kinematic auxiliary
+         * states and ignores the measurement z.
+         */
+        virtual full_state_t integrate_full_state_trajectory(const full_state_t& x, const input_t& u, real_t t,
+                real_t t_sample, full_state_trajectory_t* trajectory, const measurement_t& z) const;
         virtual output_t calculate_output(const state_t& x, const input_t& u = input_t::Zero()) const override final;
 
         virtual void set_v_dt(real_t v, real_t dt); /* this function _always_ recalculates state space */
@@ -104,13 +125,68 @@ class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
         void set_dt(real_t dt);
 
         virtual void set_state_space() = 0; /* this pure virtual function is defined */
+        void calculate_state_matrix(real_t v, state_matrix_t* A) const; /* does not modify state space */
 #if !defined(BICYCLE_NO_DISCRETIZATION)
         void set_discrete_state_space();
 #endif
         void set_moore_parameters();
 
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+        /*
+         * Generate a table of discrete time state space matrices for the
+         * current sampling time over the speed range [v_min, v_max]. Subsequent
+         * calls to set_v() or set_v_dt() interpolate the discretization from
+         * the table instead of calculating the matrix exponential, falling back
+         * to the exact calculation if the speed is outside the table range, the
+         * sampling time differs, or the interpolation error exceeds tolerance.
+         * The tolerance is compared to the absolute error of each Ad and Bd
+         * element at the grid interval midpoints. The table is cleared when any
+         * parameter affecting A is changed.
+         */
+        using discretization_table_t = DiscretizationTable<n, m>;
+        static constexpr real_t default_discretization_table_tolerance = static_cast<real_t>(1e-5);
+        void set_discretization_table(real_t v_min, real_t v_max, real_t dv,
+                real_t tolerance = default_discretization_table_tolerance);
+        void clear_discretization_table();
+        const discretization_table_t& discretization_table() const;
+#endif
+
+        static constexpr real_t default_integration_tolerance = static_cast<real_t>(1e-6);
+        void set_integration_tolerance(real_t absolute, real_t relative);
+        real_t integration_absolute_tolerance() const;
+        real_t integration_relative_tolerance() const;
+
+        /*
+         * Solve the pitch constraint for the roll and steer angles. If a pitch
+         * table has been generated, the pitch angle is interpolated from the
+         * table unless the angles are outside the table range or the Moore
+         * parameters must be recalculated.
+         */
         real_t solve_constraint_pitch(real_t roll_angle, real_t steer_angle, real_t guess, size_t max_iterations = 3) const;
 
+        /*
+         * Generate a table of pitch angles over the roll and steer angle range
+         * [-roll_max, roll_max] x [-steer_max, steer_max] with the given grid
+         * spacing. With the default spacing of 1 degree, the interpolation
+         * error for the benchmark bicycle is below 1e-6 rad, see
+         * PitchTable::max_error(). The table is generated again whenever the
+         * Moore parameters are set.
+         */
+        using pitch_table_t = PitchTable;
+        static constexpr real_t default_pitch_table_spacing = constants::as_radians;
+        void set_pitch_table(real_t roll_max, real_t steer_max, real_t spacing = default_pitch_table_spacing);
+        void clear_pitch_table();
+        const pitch_table_t& pitch_table() const;
+        /*
+         * Solve the pitch constraint for count pairs of roll and steer angles.
+         * The pitch angle array contains the initial guesses, e.g. the pitch
+         * angles of the previous sample, and is overwritten with the solutions.
+         * A fixed number of Newton iterations is performed for all elements in
+         * lockstep so that the calculation is vectorized.
+         */
+        void solve_constraint_pitch_batch(const real_t* roll_angle, const real_t* steer_angle, real_t* pitch_angle,
+                size_t count, size_t iterations = 3) const;
+
         // (pseudo) parameter accessors
 #if !defined(BICYCLE_NO_DISCRETIZATION)
         virtual const state_matrix_t& Ad() const override final;
@@ -133,6 +209,7 @@ class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
         real_t front_wheel_radius() const;
         real_t v() const;
         virtual real_t dt() const override final;
+        virtual uint32_t revision() const override final;
 
         bool need_recalculate_state_space() const;
         bool need_recalculate_moore_parameters() const;
@@ -160,17 +237,25 @@ class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
 
         bool m_recalculate_state_space;
         bool m_recalculate_moore_parameters;
+        uint32_t m_revision; // incremented when the state space changes
+        real_t m_integration_absolute_tolerance; // used by integrate_full_state_trajectory()
+        real_t m_integration_relative_tolerance;
 
         Eigen::LLT<second_order_matrix_t> m_M_llt;
         state_matrix_t m_A;
         input_matrix_t m_B;
+        state_matrix_t m_A0; // coefficients of state matrix polynomial in v
+        state_matrix_t m_A1;
+        state_matrix_t m_A2;
         output_matrix_t m_C;
         feedthrough_matrix_t m_D;
 
 #if !defined(BICYCLE_NO_DISCRETIZATION)
         state_matrix_t m_Ad;
         input_matrix_t m_Bd;
+        discretization_table_t m_discretization_table;
 #endif
+        pitch_table_t m_pitch_table;
 
         Bicycle(const second_order_matrix_t& M, const second_order_matrix_t& C1,
                 const second_order_matrix_t& K0, const second_order_matrix_t& K2,
@@ -180,6 +265,200 @@ class Bicycle : public DiscreteLinear<5, 2, 2, 2> {
         Bicycle(const char* param_file, real_t v, real_t dt);
         Bicycle(real_t v, real_t dt);
         void set_parameters_from_file(const char* param_file);
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+        static void calculate_discrete_state_space(const state_matrix_t& A, const input_matrix_t& B,
+                real_t dt, state_matrix_t* Ad, input_matrix_t* Bd);
+#endif
+        void set_state_space_coefficients();
+        void generate_pitch_table(real_t roll_max, real_t steer_max, real_t spacing);
+        real_t newton_solve_constraint_pitch(real_t roll_angle, real_t steer_angle, real_t guess, size_t max_iterations) const;
+        static real_t mod_two_pi(real_t angle);
+        /*
+         * Integrate the full state with a dense output stepper, see
+         * integrate_full_state_trajectory(). This is defined in
+         * bicycle/bicycle.hh which must be included by derived class sources.
+         */
+        template <typename System>
+        full_state_t integrate_full_state_dense_output(System system, const full_state_t& x, real_t t,
+                real_t t_sample, full_state_trajectory_t* trajectory) const;
 }; // class Bicycle
 
+/*
+ * Evaluate the state matrix A(v) = A0 + v*A1 + v^2*A2. Only the speed
+ * dependent elements are updated, see set_state_space_coefficients() for the
+ * structure of the coefficient matrices.
+ */
+inline void Bicycle::calculate_state_matrix(real_t v, state_matrix_t* A) const {
+    *A = m_A0;
+    (*A)(0, 2) += v*m_A1(0, 2);
+    A->block<o, o>(3, 1) += (v*v)*m_A2.block<o, o>(3, 1);
+    A->bottomRightCorner<o, o>() += v*m_A1.bottomRightCorner<o, o>();
+}
+
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+inline const Bicycle::state_matrix_t& Bicycle::Ad() const {
+    return m_Ad;
+}
+
+inline const Bicycle::input_matrix_t& Bicycle::Bd() const {
+    return m_Bd;
+}
+
+inline const Bicycle::output_matrix_t& Bicycle::Cd() const {
+    return C();
+}
+
+inline const Bicycle::feedthrough_matrix_t& Bicycle::Dd() const {
+    return D();
+}
+#endif
+
+inline const Bicycle::state_matrix_t& Bicycle::A() const {
+    return m_A;
+}
+
+inline const Bicycle::input_matrix_t& Bicycle::B() const {
+    return m_B;
+}
+
+inline const Bicycle::output_matrix_t& Bicycle::C() const {
+    return m_C;
+}
+
+inline const Bicycle::feedthrough_matrix_t& Bicycle::D() const {
+    return m_D;
+}
+
+inline const Bicycle::second_order_matrix_t& Bicycle::M() const {
+    return m_M;
+}
+
+inline const Bicycle::second_order_matrix_t& Bicycle::C1() const {
+    return m_C1;
+}
+
+inline const Bicycle::second_order_matrix_t& Bicycle::K0() const {
+    return m_K0;
+}
+
+inline const Bicycle::second_order_matrix_t& Bicycle::K2() const {
+    return m_K2;
+}
+
+inline real_t Bicycle::wheelbase() const {
+    return m_w;
+}
+
+inline real_t Bicycle::trail() const {
+    return m_c;
+}
+
+inline real_t Bicycle::steer_axis_tilt() const {
+    return m_lambda;
+}
+
+inline real_t Bicycle::rear_wheel_radius() const {
+    return m_rr;
+}
+
+inline real_t Bicycle::front_wheel_radius() const {
+    return m_rf;
+}
+
+inline real_t Bicycle::v() const {
+    return m_v;
+}
+
+inline real_t Bicycle::dt() const {
+    return m_dt;
+}
+
+inline uint32_t Bicycle::revision() const {
+    return m_revision;
+}
+
+inline void Bicycle::set_integration_tolerance(real_t absolute, real_t relative) {
+    m_integration_absolute_tolerance = absolute;
+    m_integration_relative_tolerance = relative;
+}
+
+inline real_t Bicycle::integration_absolute_tolerance() const {
+    return m_integration_absolute_tolerance;
+}
+
+inline real_t Bicycle::integration_relative_tolerance() const {
+    return m_integration_relative_tolerance;
+}
+
+inline bool Bicycle::need_recalculate_state_space() const {
+    return m_recalculate_state_space;
+}
+
+inline bool Bicycle::need_recalculate_moore_parameters() const {
+    return m_recalculate_moore_parameters;
+}
+
+/*
+ * Ensure the normalization functions are updated if state indices change.
+ *
+ * We use 2*pi as the second argument simply to keep these angles from
+ * growing toward infinity.
+ * NOTE: This does not prevent the roll rate and steer rate from
+ * growing to infinity.
+ */
+inline Bicycle::state_t Bicycle::normalize_state(const state_t& x) const {
+    static_assert(static_cast<uint8_t>(state_index_t::yaw_angle) == 0,
+        "Invalid underlying value for state index element");
+    static_assert(static_cast<uint8_t>(state_index_t::roll_angle) == 1,
+        "Invalid underlying value for state index element");
+    static_assert(static_cast<uint8_t>(state_index_t::steer_angle) == 2,
+        "Invalid underlying value for state index element");
+    static_assert(static_cast<uint8_t>(state_index_t::roll_rate) == 3,
+        "Invalid underlying value for state index element");
+    static_assert(static_cast<uint8_t>(state_index_t::steer_rate) == 4,
+        "Invalid underlying value for state index element");
+    static_assert(static_cast<uint8_t>(state_index_t::number_of_types) == 5,
+        "Invalid underlying value for state index element");
+
+    state_t normalized_x = x;
+    normalized_x[0] = mod_two_pi(x[0]);
+    normalized_x[1] = mod_two_pi(x[1]);
+    normalized_x[2] = mod_two_pi(x[2]);
+    return normalized_x;
+}
+
+inline Bicycle::output_t Bicycle::normalize_output(const output_t& y) const {
+    static_assert(static_cast<uint8_t>(output_index_t::yaw_angle) == 0,
+        "Invalid underlying value for output index element");
+    static_assert(static_cast<uint8_t>(output_index_t::steer_angle) == 1,
+        "Invalid underlying value for output index element");
+    static_assert(static_cast<uint8_t>(output_index_t::number_of_types) == 2,
+        "Invalid underlying value for output index element");
+
+    output_t normalized_y = y;
+    real_t yaw = y[0];
+    if ((yaw >= constants::pi) || (yaw < -constants::pi)) {
+        yaw = mod_two_pi(yaw);
+        if (yaw >= constants::pi) {
+            yaw -= constants::two_pi;
+        } else if (yaw < -constants::pi) {
+            yaw += constants::two_pi;
+        }
+    }
+    normalized_y[0] = yaw;
+    normalized_y[1] = mod_two_pi(y[1]);
+    return normalized_y;
+}
+
+/*
+ * std::fmod(angle, 2*pi) returns angle if the magnitude is less than 2*pi and
+ * the relatively expensive call is skipped in this case.
+ */
+inline real_t Bicycle::mod_two_pi(real_t angle) {
+    if ((angle < constants::two_pi) && (angle > -constants::two_pi)) {
+        return angle;
+    }
+    return std::fmod(angle, constants::two_pi);
+}
+
 } // namespace model
@@ -5,8 +5,23 @@
 
 namespace model {
 
+/*
+ * The full state can be integrated with one of two methods:
+ *  - runge_kutta_dopri5: The full state is integrated numerically with a
+ *    single Dormand-Prince step.
+ *  - discrete: If the integration time is equal to the sampling time, the
+ *    dynamic states are advanced exactly with the discrete time state space
+ *    Ad, Bd. The yaw angle is assumed to vary linearly over the step and the
+ *    rear contact position is integrated analytically. Otherwise the
+ *    Dormand-Prince step is used.
+ */
 class BicycleWhipple final : public Bicycle {
     public:
+        enum class integration_method_t: uint8_t {
+            runge_kutta_dopri5 = 0,
+            discrete
+        };
+
         BicycleWhipple(const second_order_matrix_t& M, const second_order_matrix_t& C1,
                 const second_order_matrix_t& K0, const second_order_matrix_t& K2,
                 real_t wheelbase, real_t trail, real_t steer_axis_tilt,
@@ -17,16 +32,26 @@ class BicycleWhipple final : public Bicycle {
 
         virtual state_t update_state(const state_t& x, const input_t& u = input_t::Zero(), const measurement_t& z = measurement_t::Zero()) const override;
         virtual full_state_t integrate_full_state(const full_state_t& xf, const input_t& u, real_t t, const measurement_t& z = measurement_t::Zero()) const override;
+        virtual full_state_t integrate_full_state_trajectory(const full_state_t& xf, const input_t& u, real_t t,
+                real_t t_sample, full_state_trajectory_t* trajectory, const measurement_t& z = measurement_t::Zero()) const override;
         virtual state_t integrate_state(const state_t& x, const input_t& u, real_t t) const;
 
         virtual void set_state_space() override;
 
+        void set_integration_method(integration_method_t method);
+        integration_method_t integration_method() const;
+
     private:
+        integration_method_t m_integration_method;
+
+        auto full_state_system(const input_t& u) const;
+
         /*
          * Some steppers have internal state and so none have do_step() defined as const.
-         * While internal state may be changed from multiple calls to do_step(), the
-         * state is 'reset' when all calls to do_step() are completed and the integration
-         * has completed, thus we mark them as mutable as we do not perceive the internal
+         * The Dormand-Prince stepper caches the derivative at the end of a step
+         * (first same as last) and reuses it in the next step. The stepper is
+         * reset before each integration so that results do not depend on previous
+         * calls, thus we mark them as mutable as we do not perceive the internal
          * state change of the stepper.
          */
         mutable boost::numeric::odeint::runge_kutta_dopri5<
@@ -37,4 +62,28 @@ class BicycleWhipple final : public Bicycle {
             boost::numeric::odeint::vector_space_algebra> m_stepper_state;
 };
 
+inline void BicycleWhipple::set_integration_method(integration_method_t method) {
+    m_integration_method = method;
+}
+
+inline BicycleWhipple::integration_method_t BicycleWhipple::integration_method() const {
+    return m_integration_method;
+}
+
+/*
+ * update_state() is defined inline as it is called every sample by observers
+ * and controllers. As the class is final, calls through a BicycleWhipple
+ * reference are dispatched statically and can be inlined.
+ */
+inline BicycleWhipple::state_t BicycleWhipple::update_state(const state_t& x, const input_t& u, const measurement_t& z) const {
+    (void)z;
+#if defined(BICYCLE_NO_DISCRETIZATION)
+    // This simply calls integrate state with the integration time set to m_dt
+    // if discretization has been disabled.
+    return integrate_state(x, u, m_dt);
+#else
+    return m_Ad*x + m_Bd*u;
+#endif
+}
+
 } // namespace model
@@ -10,6 +10,14 @@ class DiscreteLinearBase {
         ~DiscreteLinearBase() { }
 };
 
+/*
+ * The virtual interface allows runtime model selection. Observers and
+ * controllers are templated on the model type and call these functions several
+ * times per sample. When the model type is a final class, or the overriding
+ * functions are final, calls are dispatched statically and functions defined
+ * inline in the model header are inlined, so no separate static interface is
+ * required.
+ */
 template <size_t N, size_t M, size_t L, size_t O>
 class DiscreteLinear : private DiscreteLinearBase {
     public:
@@ -17,6 +25,10 @@ class DiscreteLinear : private DiscreteLinearBase {
         static constexpr unsigned int m = M; // input size
         static constexpr unsigned int l = L; // output size
         static constexpr unsigned int o = O; // second order state size
+        // Number of leading states that do not feed back, i.e. the first ni
+        // columns of the state matrix A are zero and Ad = [I A12; 0 A22].
+        // Derived classes with this structure may redefine ni.
+        static constexpr unsigned int ni = 0; // integrator state size
 
         using state_t = Eigen::Matrix<real_t, n, 1>;
         using input_t = Eigen::Matrix<real_t, m, 1>;
@@ -40,6 +52,9 @@ class DiscreteLinear : private DiscreteLinearBase {
         virtual const feedthrough_matrix_t& Dd() const = 0;
 #endif
         virtual real_t dt() const = 0;
+        // Incremented whenever the system matrices or sampling time may have
+        // changed. Users can compare revisions to detect a system change.
+        virtual uint32_t revision() const = 0;
 
         virtual state_t normalize_state(const state_t& x) const = 0;
         virtual output_t normalize_output(const output_t& y) const = 0;
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include "types.h"
+
+namespace model {
+
+/*
+ * This template class stores the discrete time state and input matrices of a
+ * linear system parameterized by forward speed. The matrices are calculated at
+ * evenly spaced speeds over [v_min, v_max] for a single sampling time and a
+ * lookup linearly interpolates between adjacent grid points.
+ *
+ * When the table is generated, the interpolation error is checked against the
+ * exact discretization at the midpoint of each grid interval. Intervals with
+ * an error exceeding the given tolerance are marked invalid and a lookup in
+ * such an interval fails. A lookup also fails if the speed lies outside the
+ * grid or if the sampling time does not match. In all failing cases the caller
+ * must calculate the exact discretization.
+ */
+template <size_t N, size_t M>
+class DiscretizationTable {
+    public:
+        using state_matrix_t = Eigen::Matrix<real_t, N, N>;
+        using input_matrix_t = Eigen::Matrix<real_t, N, M>;
+
+        DiscretizationTable();
+
+        // The discretize function must have the signature:
+        //   void discretize(real_t v, state_matrix_t* Ad, input_matrix_t* Bd)
+        // and calculate the exact discretization for speed v and sampling time dt.
+        template <typename F>
+        void generate(real_t v_min, real_t v_max, real_t dv, real_t dt,
+                real_t tolerance, F discretize);
+        void clear();
+
+        bool lookup(real_t v, real_t dt, state_matrix_t* Ad, input_matrix_t* Bd) const;
+
+        // accessors
+        bool empty() const;
+        real_t v_min() const;
+        real_t v_max() const;
+        real_t dv() const;
+        real_t dt() const;
+        real_t tolerance() const;
+        real_t max_error() const; // maximum interpolation error of valid intervals
+        size_t size() const; // number of grid points
+        size_t invalid_intervals() const;
+
+    private:
+        using state_matrix_vector_t = std::vector<state_matrix_t, Eigen::aligned_allocator<state_matrix_t>>;
+        using input_matrix_vector_t = std::vector<input_matrix_t, Eigen::aligned_allocator<input_matrix_t>>;
+
+        real_t m_v_min;
+        real_t m_v_max;
+        real_t m_dv;
+        real_t m_dt;
+        real_t m_tolerance;
+        real_t m_max_error;
+        state_matrix_vector_t m_Ad;
+        input_matrix_vector_t m_Bd;
+        std::vector<bool> m_valid; // interpolation error within tolerance for each grid interval
+}; // class DiscretizationTable
+
+template <size_t N, size_t M>
+inline bool DiscretizationTable<N, M>::empty() const {
+    return m_Ad.empty();
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::v_min() const {
+    return m_v_min;
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::v_max() const {
+    return m_v_max;
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::dv() const {
+    return m_dv;
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::dt() const {
+    return m_dt;
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::tolerance() const {
+    return m_tolerance;
+}
+
+template <size_t N, size_t M>
+inline real_t DiscretizationTable<N, M>::max_error() const {
+    return m_max_error;
+}
+
+template <size_t N, size_t M>
+inline size_t DiscretizationTable<N, M>::size() const {
+    return m_Ad.size();
+}
+
+} // namespace model
+
+#include "discretization_table.hh"
@@ -0,0 +1,144 @@
+#pragma once
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include "discrete_linear.h"
+
+namespace model {
+/*
+ * This class stores steady state LQR and Kalman filter gains over a uniform
+ * grid of forward speeds for a discrete time system with a fixed sampling
+ * time. The template parameter T must provide v() and set_v() functions, as
+ * Bicycle does.
+ *
+ * Gains are generated offline by calculating the steady state LQR gain (with
+ * the Riccati doubling solver) and iterating the Kalman filter covariance
+ * update until convergence at each grid speed. At runtime, gains are linearly
+ * interpolated between the two nearest grid speeds in constant time and
+ * speeds outside the grid are clamped to the grid range. See ScheduledLqr and
+ * ScheduledKalman.
+ *
+ * LQR gains are stored for all inputs, with zero rows for inputs that have
+ * zero input cost, so that u = K*x + Ki*q.
+ */
+template <typename T>
+class GainSchedule {
+    public:
+        using state_matrix_t = typename T::state_matrix_t;
+        using lqr_gain_t = Eigen::Matrix<real_t, T::m, T::n>;
+        using kalman_gain_t = Eigen::Matrix<real_t, T::n, T::l>;
+        using state_cost_t = state_matrix_t;
+        using input_cost_t = Eigen::Matrix<real_t, T::m, T::m>;
+        using error_covariance_t = state_matrix_t;
+        using process_noise_covariance_t = state_matrix_t;
+        using measurement_noise_covariance_t = Eigen::Matrix<real_t, T::l, T::l>;
+
+        // weights and noise covariances used to calculate gains
+        struct weights_t {
+            state_cost_t lqr_Q;
+            input_cost_t lqr_R;
+            state_cost_t lqr_Qi;
+            process_noise_covariance_t kalman_Q;
+            measurement_noise_covariance_t kalman_R;
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        // steady state gains at a single speed
+        struct entry_t {
+            lqr_gain_t lqr_K;
+            lqr_gain_t lqr_Ki;
+            kalman_gain_t kalman_K;
+            error_covariance_t kalman_P; // a posteriori error covariance
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+        using entry_vector_t = std::vector<entry_t, Eigen::aligned_allocator<entry_t>>;
+
+        static constexpr uint32_t max_kalman_iterations = 100000;
+        static constexpr uint32_t max_lqr_iterations = 1000;
+        // value iteration horizon, used if the Riccati doubling solver falls back
+        static constexpr uint32_t lqr_horizon_iterations = 100;
+
+        GainSchedule();
+
+        /*
+         * Calculate gains for speeds [v_min, v_max] with grid spacing of at
+         * most dv using the sampling time of system. The speed of system is
+         * changed during generation and restored afterwards.
+         */
+        void generate(T& system, real_t v_min, real_t v_max, real_t dv, const weights_t& weights);
+        void set(real_t v_min, real_t dv, real_t dt, const weights_t& weights,
+                const entry_vector_t& entries);
+        void clear();
+
+        void lqr_gain(real_t v, lqr_gain_t* K, lqr_gain_t* Ki) const;
+        void kalman_gain(real_t v, kalman_gain_t* K, error_covariance_t* P) const;
+
+        // accessors
+        bool empty() const;
+        bool contains(real_t v) const;
+        size_t size() const;
+        real_t v_min() const;
+        real_t v_max() const;
+        real_t dv() const;
+        real_t dt() const;
+        const weights_t& weights() const;
+        const entry_vector_t& entries() const;
+
+    private:
+        real_t m_v_min;
+        real_t m_dv;
+        real_t m_dt;
+        weights_t m_weights;
+        entry_vector_t m_entries;
+
+        void interval(real_t v, size_t* i, real_t* t) const;
+}; // class GainSchedule
+
+template <typename T>
+inline bool GainSchedule<T>::empty() const {
+    return m_entries.empty();
+}
+
+template <typename T>
+inline bool GainSchedule<T>::contains(real_t v) const {
+    return !empty() && (v >= v_min()) && (v <= v_max());
+}
+
+template <typename T>
+inline size_t GainSchedule<T>::size() const {
+    return m_entries.size();
+}
+
+template <typename T>
+inline real_t GainSchedule<T>::v_min() const {
+    return m_v_min;
+}
+
+template <typename T>
+inline real_t GainSchedule<T>::v_max() const {
+    return m_v_min + (size() - 1)*m_dv;
+}
+
+template <typename T>
+inline real_t GainSchedule<T>::dv() const {
+    return m_dv;
+}
+
+template <typename T>
+inline real_t GainSchedule<T>::dt() const {
+    return m_dt;
+}
+
+template <typename T>
+inline const typename GainSchedule<T>::weights_t& GainSchedule<T>::weights() const {
+    return m_weights;
+}
+
+template <typename T>
+inline const typename GainSchedule<T>::entry_vector_t& GainSchedule<T>::entries() const {
+    return m_entries;
+}
+
+} // namespace model
+
+#include "gain_schedule.hh"
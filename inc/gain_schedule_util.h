@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include "gain_schedule.h"
+#include "gain_schedule_generated.h"
+#include "sample_util.h"
+
+/*
+ * Serialization of a GainSchedule to and from the GainSchedule flatbuffer
+ * table. See fbs/gain_schedule.fbs. The table has fixed matrix sizes so these
+ * functions accept any model with 5 states, 2 inputs and 2 outputs, such as the
+ * Bicycle models.
+ */
+namespace fbs {
+
+template <typename T>
+struct gain_schedule_traits {
+    static_assert((T::n == 5) && (T::m == 2) && (T::l == 2),
+            "GainSchedule flatbuffer table requires 5 states, 2 inputs and 2 outputs");
+    using gain_schedule_t = model::GainSchedule<T>;
+};
+
+template <typename T>
+inline typename gain_schedule_traits<T>::gain_schedule_t::state_cost_t symmetric_state_matrix(
+        const ::fbs::SymmetricStateMatrix& s) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    return (typename gain_schedule_t::state_cost_t() <<
+        s.q00(), s.q01(), s.q02(), s.q03(), s.q04(),
+        s.q01(), s.q11(), s.q12(), s.q13(), s.q14(),
+        s.q02(), s.q12(), s.q22(), s.q23(), s.q24(),
+        s.q03(), s.q13(), s.q23(), s.q33(), s.q34(),
+        s.q04(), s.q14(), s.q24(), s.q34(), s.q44()).finished();
+}
+
+template <typename T>
+inline typename gain_schedule_traits<T>::gain_schedule_t::input_cost_t symmetric_input_matrix(
+        const ::fbs::SymmetricInputMatrix& s) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    return (typename gain_schedule_t::input_cost_t() <<
+        s.r00(), s.r01(),
+        s.r01(), s.r11()).finished();
+}
+
+template <typename T>
+inline typename gain_schedule_traits<T>::gain_schedule_t::measurement_noise_covariance_t symmetric_output_matrix(
+        const ::fbs::SymmetricOutputMatrix& s) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    return (typename gain_schedule_t::measurement_noise_covariance_t() <<
+        s.r00(), s.r01(),
+        s.r01(), s.r11()).finished();
+}
+
+template <typename T>
+inline typename gain_schedule_traits<T>::gain_schedule_t::lqr_gain_t lqr_gain_matrix(
+        const ::fbs::LqrGainMatrix& k) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    return (typename gain_schedule_t::lqr_gain_t() <<
+        k.k00(), k.k01(), k.k02(), k.k03(), k.k04(),
+        k.k10(), k.k11(), k.k12(), k.k13(), k.k14()).finished();
+}
+
+template <typename T>
+inline typename gain_schedule_traits<T>::gain_schedule_t::kalman_gain_t kalman_gain_matrix(
+        const ::fbs::KalmanGainMatrix& k) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    return (typename gain_schedule_t::kalman_gain_t() <<
+        k.k00(), k.k01(),
+        k.k10(), k.k11(),
+        k.k20(), k.k21(),
+        k.k30(), k.k31(),
+        k.k40(), k.k41()).finished();
+}
+
+template <typename T>
+inline flatbuffers::Offset<::fbs::GainSchedule> create_gain_schedule(
+        flatbuffers::FlatBufferBuilder& fbb, const model::GainSchedule<T>& schedule) {
+    const typename model::GainSchedule<T>::weights_t& w = schedule.weights();
+    auto Q_ = symmetric_state_matrix(w.lqr_Q);
+    auto R_ = symmetric_input_matrix(w.lqr_R);
+    auto Qi_ = symmetric_state_matrix(w.lqr_Qi);
+    auto kalman_Q_ = symmetric_state_matrix(w.kalman_Q);
+    auto kalman_R_ = symmetric_output_matrix(w.kalman_R);
+
+    std::vector<::fbs::GainScheduleEntry> entries;
+    entries.reserve(schedule.size());
+    for (const auto& e: schedule.entries()) {
+        entries.emplace_back(lqr_gain_matrix(e.lqr_K), lqr_gain_matrix(e.lqr_Ki),
+                kalman_gain_matrix(e.kalman_K), symmetric_state_matrix(e.kalman_P));
+    }
+    auto entries_ = fbb.CreateVectorOfStructs(entries);
+    return CreateGainSchedule(fbb, schedule.v_min(), schedule.dv(), schedule.dt(),
+            &Q_, &R_, &Qi_, &kalman_Q_, &kalman_R_, entries_);
+}
+
+/*
+ * Set a gain schedule from a flatbuffer table. Returns false if the table is
+ * missing fields.
+ */
+template <typename T>
+inline bool get_gain_schedule(const ::fbs::GainSchedule* fb, model::GainSchedule<T>* schedule) {
+    using gain_schedule_t = typename gain_schedule_traits<T>::gain_schedule_t;
+    if ((fb->state_cost() == nullptr) || (fb->input_cost() == nullptr) ||
+            (fb->integral_cost() == nullptr) || (fb->process_noise_covariance() == nullptr) ||
+            (fb->measurement_noise_covariance() == nullptr) || (fb->entries() == nullptr)) {
+        return false;
+    }
+
+    typename gain_schedule_t::weights_t w;
+    w.lqr_Q = symmetric_state_matrix<T>(*fb->state_cost());
+    w.lqr_R = symmetric_input_matrix<T>(*fb->input_cost());
+    w.lqr_Qi = symmetric_state_matrix<T>(*fb->integral_cost());
+    w.kalman_Q = symmetric_state_matrix<T>(*fb->process_noise_covariance());
+    w.kalman_R = symmetric_output_matrix<T>(*fb->measurement_noise_covariance());
+
+    typename gain_schedule_t::entry_vector_t entries(fb->entries()->size());
+    for (flatbuffers::uoffset_t i = 0; i < fb->entries()->size(); ++i) {
+        const ::fbs::GainScheduleEntry* e = fb->entries()->Get(i);
+        entries[i].lqr_K = lqr_gain_matrix<T>(e->lqr_gain());
+        entries[i].lqr_Ki = lqr_gain_matrix<T>(e->lqr_integral_gain());
+        entries[i].kalman_K = kalman_gain_matrix<T>(e->kalman_gain());
+        entries[i].kalman_P = symmetric_state_matrix<T>(e->error_covariance());
+    }
+    schedule->set(fb->v_min(), fb->dv(), fb->dt(), w, entries);
+    return true;
+}
+
+} // namespace fbs
@@ -6,6 +6,21 @@ namespace observer {
 
 /*
  * This template class implements a discrete-time Kalman Filter.
+ *
+ * In steady state mode, the relative change of the error covariance is
+ * checked after each measurement update. Once the change is within
+ * dummy_precision, the filter is in steady state and the error
+ * covariance and Kalman gain are no longer updated, so that a time and
+ * measurement update only update the state estimate. P() then returns the
+ * steady state a posteriori error covariance. The full update is resumed if
+ * the system matrices change, if Q, R, or P are set, or if an update is
+ * called with explicit noise covariances.
+ *
+ * The error covariance update skips products with the identity and zero
+ * blocks of the state matrix given by the model integrator state size T::ni
+ * and uses row and column selection when the output matrix is a selection
+ * matrix. P is kept symmetric and the process noise covariance must be
+ * symmetric.
  */
 template <typename T>
 class Kalman final : public Observer<T> {
@@ -48,6 +63,7 @@ class Kalman final : public Observer<T> {
         void set_P(const error_covariance_t& P);
         void set_Q(const process_noise_covariance_t& Q);
         void set_R(const measurement_noise_covariance_t& R);
+        void set_steady_state_mode(bool enabled);
 
         // accessors
         const state_t& x() const;
@@ -55,6 +71,10 @@ class Kalman final : public Observer<T> {
         const error_covariance_t& P() const;
         const process_noise_covariance_t& Q() const;
         const measurement_noise_covariance_t& R() const;
+        bool steady_state_mode() const;
+        bool steady_state() const; // error covariance and gain are not updated
+        uint32_t steady_state_updates() const; // measurement updates until steady state
+        real_t error_covariance_change() const; // relative change of last measurement update
 
     private:
         using Observer<T>::m_system;
@@ -63,12 +83,24 @@ class Kalman final : public Observer<T> {
         error_covariance_t m_P;
         process_noise_covariance_t m_Q;
         measurement_noise_covariance_t m_R;
-
+        error_covariance_t m_P_previous;        // a posteriori error covariance of last update
+        bool m_steady_state_mode;
+        bool m_steady_state;
+        uint32_t m_steady_state_updates;
+        real_t m_error_covariance_change;
+        uint32_t m_system_revision;             // system revision of output selection
+        typename T::state_matrix_t m_Ad;        // state matrix of steady state gain
+        typename T::output_matrix_t m_Cd;       // output matrix of steady state gain
+        bool m_output_selection;                // output matrix selects states
+        Eigen::Matrix<uint32_t, T::l, 1> m_output_index; // selected state of each output
+        typename T::output_matrix_t m_CP;       // output matrix times a priori error covariance
+
+        void check_system_change();
+        void reset_steady_state();
+        void set_output_selection();
         void time_update_state();
         void time_update_state(const input_t& u);
-        void time_update_error_covariance();
         void time_update_error_covariance(const process_noise_covariance_t& Q);
-        void measurement_update_kalman_gain();
         void measurement_update_kalman_gain(const measurement_noise_covariance_t& R);
         void measurement_update_state(const measurement_t& z);
         void measurement_update_error_covariance();
@@ -81,19 +113,28 @@ inline void Kalman<T>::set_x(const state_t& x) {
 
 template <typename T>
 inline void Kalman<T>::set_P(const error_covariance_t& P) {
+    reset_steady_state();
     m_P = P;
 }
 
 template <typename T>
 inline void Kalman<T>::set_Q(const process_noise_covariance_t& Q) {
+    reset_steady_state();
     m_Q = Q;
 }
 
 template <typename T>
 inline void Kalman<T>::set_R(const measurement_noise_covariance_t& R) {
+    reset_steady_state();
     m_R = R;
 }
 
+template <typename T>
+inline void Kalman<T>::set_steady_state_mode(bool enabled) {
+    reset_steady_state();
+    m_steady_state_mode = enabled;
+}
+
 template <typename T>
 inline const typename Kalman<T>::state_t& Kalman<T>::x() const {
     return this->state();
@@ -119,6 +160,26 @@ inline const typename Kalman<T>::measurement_noise_covariance_t& Kalman<T>::R()
     return m_R;
 }
 
+template <typename T>
+inline bool Kalman<T>::steady_state_mode() const {
+    return m_steady_state_mode;
+}
+
+template <typename T>
+inline bool Kalman<T>::steady_state() const {
+    return m_steady_state;
+}
+
+template <typename T>
+inline uint32_t Kalman<T>::steady_state_updates() const {
+    return m_steady_state_updates;
+}
+
+template <typename T>
+inline real_t Kalman<T>::error_covariance_change() const {
+    return m_error_covariance_change;
+}
+
 } // namespace observer
 
 #include "kalman.hh"
@@ -2,16 +2,38 @@
 #include <type_traits>
 #include <Eigen/Core>
 #include <Eigen/QR>
+#include <Eigen/LU>
+#include <Eigen/Cholesky>
 #include "discrete_linear.h"
 
 namespace controller {
 // TODO: Allow reference state to vary in horizon
 using real_t = model::real_t;
 
+/*
+ * The feedback gain is calculated with one of two solvers:
+ *
+ * value_iteration: Each call to control_calculate() performs horizon
+ * iterations of the Riccati recursion, continuing from the previous cost-to-go.
+ * The gain converges to the steady state gain over multiple calls and the
+ * recursion is restarted from zero cost-to-go when the system changes.
+ *
+ * riccati_doubling: The steady state gain is calculated directly by solving
+ * the discrete algebraic Riccati equation with the structured doubling
+ * algorithm, which converges quadratically. When the system changes, the
+ * previous cost-to-go is kept and the equation is solved again only if it is
+ * no longer a fixed point of the Riccati recursion. If the doubling algorithm
+ * does not converge, e.g. if the system is not stabilizable, value iteration
+ * is used instead.
+ */
 template<typename T>
 class Lqr {
     static_assert(std::is_base_of<model::DiscreteLinearBase, T>::value, "Invalid template parameter type for Lqr");
     public:
+        enum class solver_t {
+            value_iteration,
+            riccati_doubling
+        };
         using state_t = typename T::state_t;
         using input_t = typename T::input_t;
         using state_matrix_t = typename T::state_matrix_t;
@@ -34,6 +56,7 @@ class Lqr {
         void set_Q(const state_cost_t& Q);
         void set_Qi(const state_cost_t& Qi);
         void set_R(const input_cost_t& R);
+        void set_solver(solver_t solver);
 
         // accessors
         T& system() const;
@@ -47,6 +70,7 @@ class Lqr {
         const state_cost_t& Qi() const;
         const input_cost_t& R() const;
         real_t dt() const;
+        solver_t solver() const;
 
     private:
         using control_mask_t = typename Eigen::Matrix<uint32_t, T::m, 1>;
@@ -54,6 +78,7 @@ class Lqr {
         using augmented_input_matrix_t = typename Eigen::Matrix<real_t, 2*T::n, T::m>;
         using augmented_lqr_gain_t = typename Eigen::Matrix<real_t, T::m, 2*T::n>;
         using augmented_state_cost_t = augmented_state_matrix_t;
+        static constexpr uint32_t max_doubling_iterations = 32;
 
         T& m_system;                        // controlled system or plant
         uint32_t m_horizon;                 // horizon length in iterations
@@ -65,8 +90,11 @@ class Lqr {
         state_cost_t m_Qi;                  // error integral cost weights
         input_cost_t m_R;                   // input cost weights
         bool m_steady_state;                // steady state indicator
+        solver_t m_solver;                  // gain calculation method
+        bool m_solve_riccati;               // riccati equation must be solved (problem changed)
         //state_matrix_t m_Ad;                // copy of system state matrix
         input_matrix_t m_Bd;                // copy of system input matrix
+        uint32_t m_system_revision;         // system revision of copied matrices
         control_mask_t m_mask;              // control input mask
         uint32_t m_m;                       // number of accessible control inputs
         input_cost_t m_Rr;                  // reduced form of input cost matrix
@@ -76,7 +104,17 @@ class Lqr {
         augmented_state_cost_t m_Pg;        // augmented cost-to-go matrix
 
         void perform_value_iteration();
+        bool solve_riccati_doubling();
+        bool is_riccati_fixed_point(); // also sets gain from cost-to-go
+        template<int N>
+        static bool riccati_doubling(const Eigen::Matrix<real_t, N, N>& A,
+                const Eigen::Matrix<real_t, N, N>& G, const Eigen::Matrix<real_t, N, N>& H,
+                Eigen::Matrix<real_t, N, N>* P);
         void update_lqr_gain();
+        template<int N>
+        void update_lqr_gain();
+        void update_horizon_cost();
+        template<int N>
         void update_horizon_cost();
         void set_control_mask();
         void reduce_input_matrices();
@@ -101,13 +139,22 @@ inline void Lqr<T>::set_error_integral(const state_t& q) {
 template<typename T>
 inline void Lqr<T>::set_Q(const state_cost_t& Q) {
     m_steady_state = false;
+    m_solve_riccati = true;
     m_Q = Q;
 }
 
 template<typename T>
 inline void Lqr<T>::set_Qi(const state_cost_t& Qi) {
     m_steady_state = false;
+    m_solve_riccati = true;
     m_Qi = Qi;
+    if (m_Qi.isZero()) {
+        // error integral states are decoupled and only the state gain and
+        // cost-to-go are updated
+        m_Kg.template rightCols<T::n>().setZero();
+        m_Pg.template rightCols<T::n>().setZero();
+        m_Pg.template bottomRows<T::n>().setZero();
+    }
     // Look at diagonal entries of Qi and if zero, treat the output as unobserved.
     m_Ag.template bottomLeftCorner<T::n, T::n>() =
         (m_Qi.diagonal().array() != 0.0).template cast<real_t>().matrix().asDiagonal();
@@ -116,10 +163,18 @@ inline void Lqr<T>::set_Qi(const state_cost_t& Qi) {
 template<typename T>
 inline void Lqr<T>::set_R(const input_cost_t& R) {
     m_steady_state = false;
+    m_solve_riccati = true;
     m_R = R;
     set_control_mask();
 }
 
+template<typename T>
+inline void Lqr<T>::set_solver(solver_t solver) {
+    m_steady_state = false;
+    m_solve_riccati = true;
+    m_solver = solver;
+}
+
 template<typename T>
 inline T& Lqr<T>::system() const {
     return m_system;
@@ -175,6 +230,11 @@ inline real_t Lqr<T>::dt() const {
     return m_system.dt();
 }
 
+template<typename T>
+inline typename Lqr<T>::solver_t Lqr<T>::solver() const {
+    return m_solver;
+}
+
 } // namespace controller
 
 #include "lqr.hh"
@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <asio.hpp>
+#include "network_frame.h"
+#include "network_server.h"
+
+namespace network {
+namespace udp {
+
+/*
+ * This class is a Linux-specific alternative to Server for streaming many
+ * small frames, e.g. the state of many simulated bicycles. Frames are sent
+ * and received in batches with sendmmsg() and recvmmsg() so that one system
+ * call handles up to batch_size datagrams.
+ *
+ * async_send() copies a frame into the send batch, so the payload may change
+ * after the call. The batch is sent on the calling thread when it is full or
+ * when flush() or wait_for_send_complete() is called. Only one thread may
+ * send. If the socket send buffer stays full for send_timeout, the frames
+ * that have not been sent are dropped and counted so that the sending thread,
+ * e.g. a control loop, is not blocked.
+ *
+ * The io_service thread waits for the socket to become readable and reads
+ * all available datagrams in batches. Valid frames are passed to the receive
+ * function on the io_service thread. The payload is only valid during the
+ * call. Gaps in the sequence numbers of a source are counted as lost frames.
+ */
+class BatchServer {
+    public:
+        static constexpr size_t batch_size = 64;
+        static constexpr size_t max_sources = 256;
+        static constexpr int receive_buffer_size = 4*1024*1024; // bytes
+        static constexpr int send_timeout = 1; // ms
+
+        using receive_function_t = std::function<void(const frame_header_t& header,
+                const uint8_t* payload)>;
+
+        BatchServer(uint16_t server_port=default_server_port, uint16_t remote_port=default_remote_port,
+                receive_function_t receive_function=nullptr);
+        ~BatchServer();
+
+        // payload size must not exceed max_payload_size
+        void async_send(frame_t type, uint8_t source, asio::const_buffer payload);
+        void flush();
+        void wait_for_send_complete();
+
+        // accessors
+        uint64_t send_count() const;
+        uint64_t send_dropped_count() const;
+        uint64_t receive_count() const;
+        uint64_t lost_count() const;
+        uint64_t invalid_count() const;
+
+    private:
+        using frame_buffer_t = std::array<uint8_t, max_frame_size>;
+
+        asio::io_service m_io_service;
+        asio::ip::udp::endpoint m_remote_endpoint;
+        asio::ip::udp::socket m_socket;
+        receive_function_t m_receive_function;
+
+        // send batch, used only by the sending thread
+        std::vector<frame_buffer_t> m_send_frames;
+        std::vector<iovec> m_send_iovecs;
+        std::vector<mmsghdr> m_send_messages;
+        size_t m_send_batch_count;
+        std::array<uint32_t, max_sources> m_send_sequence;
+
+        // receive batch, used only by the io_service thread
+        std::vector<frame_buffer_t> m_receive_frames;
+        std::vector<iovec> m_receive_iovecs;
+        std::vector<mmsghdr> m_receive_messages;
+        std::array<uint32_t, max_sources> m_receive_sequence;
+        std::array<bool, max_sources> m_source_seen;
+
+        std::atomic<uint64_t> m_send_count;
+        std::atomic<uint64_t> m_send_dropped_count;
+        std::atomic<uint64_t> m_receive_count;
+        std::atomic<uint64_t> m_lost_count;
+        std::atomic<uint64_t> m_invalid_count;
+        std::thread m_service_thread;
+
+        void start_receive();
+        void handle_receive(const asio::error_code& error);
+        void handle_frame(const uint8_t* data, size_t size);
+
+        void run_service();
+}; // class BatchServer
+
+inline uint64_t BatchServer::send_count() const {
+    return m_send_count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BatchServer::send_dropped_count() const {
+    return m_send_dropped_count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BatchServer::receive_count() const {
+    return m_receive_count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BatchServer::lost_count() const {
+    return m_lost_count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BatchServer::invalid_count() const {
+    return m_invalid_count.load(std::memory_order_relaxed);
+}
+
+} // namespace udp
+} // namespace network
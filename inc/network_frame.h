@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace network {
+namespace udp {
+
+/*
+ * Each datagram sent by BatchServer contains a single frame, a fixed-size
+ * header followed by the payload:
+ *   uint8 type, uint8 source, uint16 payload size, uint32 sequence
+ * All integers are little-endian. The sequence number is incremented for
+ * each frame sent from a source, e.g. a bicycle rig, so that a receiver can
+ * detect lost frames per source.
+ */
+enum class frame_t: uint8_t {
+    state = 0, // array of doubles, e.g. a state vector
+    sample, // finished fbs::Sample flatbuffer
+    number_of_types
+};
+
+struct frame_header_t {
+    frame_t type;
+    uint8_t source;
+    uint16_t size;
+    uint32_t sequence;
+};
+
+constexpr size_t frame_header_size = 8;
+constexpr size_t max_frame_size = 1472; // UDP payload with a 1500 byte MTU
+constexpr size_t max_payload_size = max_frame_size - frame_header_size;
+
+// Writes the header and payload to buffer, which must have space for
+// frame_header_size + header.size bytes. Returns the frame size.
+size_t encode_frame(const frame_header_t& header, const uint8_t* payload, uint8_t* buffer);
+
+// Returns false if the frame is truncated or has an invalid type. On success
+// payload points into data.
+bool decode_frame(const uint8_t* data, size_t size,
+        frame_header_t* header, const uint8_t** payload);
+
+inline size_t encode_frame(const frame_header_t& header, const uint8_t* payload, uint8_t* buffer) {
+    buffer[0] = static_cast<uint8_t>(header.type);
+    buffer[1] = header.source;
+    buffer[2] = static_cast<uint8_t>(header.size);
+    buffer[3] = static_cast<uint8_t>(header.size >> 8);
+    for (size_t i = 0; i < sizeof(header.sequence); ++i) {
+        buffer[4 + i] = static_cast<uint8_t>(header.sequence >> (8*i));
+    }
+    std::memcpy(buffer + frame_header_size, payload, header.size);
+    return frame_header_size + header.size;
+}
+
+inline bool decode_frame(const uint8_t* data, size_t size,
+        frame_header_t* header, const uint8_t** payload) {
+    if ((size < frame_header_size) ||
+            (data[0] >= static_cast<uint8_t>(frame_t::number_of_types))) {
+        return false;
+    }
+    header->type = static_cast<frame_t>(data[0]);
+    header->source = data[1];
+    header->size = static_cast<uint16_t>(data[2] | (data[3] << 8));
+    header->sequence = 0;
+    for (size_t i = 0; i < sizeof(header->sequence); ++i) {
+        header->sequence |= static_cast<uint32_t>(data[4 + i]) << (8*i);
+    }
+    if (header->size > size - frame_header_size) {
+        return false;
+    }
+    *payload = data + frame_header_size;
+    return true;
+}
+
+} // namespace udp
+} // namespace network
@@ -1,12 +1,15 @@
 #pragma once
 #include <array>
+#include <atomic>
 #include <condition_variable>
 #include <chrono>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <type_traits>
 #include <asio.hpp>
 #include <asio/high_resolution_timer.hpp>
+#include "snapshot_ring.h"
 
 namespace network {
 namespace udp {
@@ -15,9 +18,21 @@ constexpr size_t buffer_size = 128;
 constexpr uint16_t default_remote_port = 9901;
 constexpr uint16_t default_server_port = 9900;
 
+/*
+ * Completion handlers run on the io_service thread and only update atomic
+ * counters. The mutex and condition variable are used only when a thread is
+ * waiting in wait_for_receive_complete() or wait_for_send_complete().
+ *
+ * By default received data is printed as doubles. If a receive function is
+ * provided, received data is passed to it on the io_service thread instead
+ * and nothing is printed. The data is only valid during the call.
+ */
 class Server {
     public:
-        Server(uint16_t server_port=default_server_port, uint16_t remote_port=default_remote_port);
+        using receive_function_t = std::function<void(const uint8_t* data, size_t size)>;
+
+        Server(uint16_t server_port=default_server_port, uint16_t remote_port=default_remote_port,
+                receive_function_t receive_function=nullptr);
         ~Server();
         //void async_send(uint8_t* buffer, size_t length);
         void async_send(asio::const_buffer buffer);
@@ -27,23 +42,27 @@ class Server {
     protected:
         asio::io_service m_io_service;
 
+        bool send_pending();
+
     private:
         std::array<uint8_t, buffer_size> m_receive_buffer;
         //std::array<uint8_t, buffer_size> m_transmit_buffer;
         asio::ip::udp::endpoint m_remote_endpoint;
         asio::ip::udp::endpoint m_server_endpoint;
         asio::ip::udp::socket m_socket;
-        std::thread m_service_thread;
+        receive_function_t m_receive_function;
 
-        std::mutex m_receive_mutex;
-        std::condition_variable m_receive_condition_variable;
-        uint32_t m_pending_receptions;
+        std::atomic<uint32_t> m_pending_receptions;
+        std::atomic<uint32_t> m_pending_transmissions;
 
-        std::mutex m_send_mutex;
-        std::condition_variable m_send_condition_variable;
-        uint32_t m_pending_transmissions;
+        // waiters register before checking a counter so that a completion
+        // handler only locks the mutex if a thread may be waiting
+        std::atomic<uint32_t> m_waiters;
+        std::mutex m_wait_mutex;
+        std::condition_variable m_wait_condition_variable;
 
         uint32_t m_receive_count;
+        std::thread m_service_thread;
         //uint32_t m_transmit_count;
 
         asio::ip::udp::endpoint remote_endpoint() const;
@@ -52,6 +71,8 @@ class Server {
         void start_receive();
         void handle_receive(const asio::error_code& error, size_t bytes_transferred);
         void handle_send(const asio::error_code& error, size_t bytes_transferred);
+        void complete(std::atomic<uint32_t>* pending);
+        void wait_for_complete(const std::atomic<uint32_t>& pending);
 
         void run_service();
 };
@@ -65,8 +86,9 @@ class PeriodicTransmitServer : public Server {
 
         // period must convert to an integer number of nanoseconds
         PeriodicTransmitServer(uint16_t server_port, uint16_t remote_port,
-                std::chrono::nanoseconds deadline_period, F buffer_function) :
-            Server(server_port, remote_port),
+                std::chrono::nanoseconds deadline_period, F buffer_function,
+                receive_function_t receive_function=nullptr) :
+            Server(server_port, remote_port, receive_function),
             m_deadline(deadline_period),
             m_transmit_time(deadline_timer::clock_type::now()),
             m_timer(m_io_service, m_deadline),
@@ -92,5 +114,59 @@ class PeriodicTransmitServer : public Server {
         }
 };
 
+/*
+ * This server periodically transmits the newest sample pushed by the control
+ * loop. push() copies the sample into a SnapshotRing and does not lock a mutex
+ * or wait on the io_service thread. The io_service thread copies the newest
+ * sample into a transmit buffer that is not modified while the transmission
+ * is queued. If the previous transmission has not completed or no sample has
+ * been pushed since the last transmission, the period is skipped.
+ */
+template <typename T, size_t N = 16>
+class SnapshotTransmitServer : public Server {
+    public:
+        using deadline_timer = typename std::conditional<std::chrono::high_resolution_clock::is_steady,
+              asio::high_resolution_timer, asio::steady_timer>::type;
+
+        // period must convert to an integer number of nanoseconds
+        SnapshotTransmitServer(uint16_t server_port, uint16_t remote_port,
+                std::chrono::nanoseconds deadline_period,
+                receive_function_t receive_function=nullptr) :
+            Server(server_port, remote_port, receive_function),
+            m_deadline(deadline_period),
+            m_timer(m_io_service, m_deadline),
+            m_transmit_count(0) {
+                m_timer.async_wait(std::bind(&SnapshotTransmitServer::periodic_function, this));
+        }
+
+        void push(const T& sample) {
+            m_ring.push(sample);
+        }
+
+        // accessors
+        uint64_t transmit_count() const {
+            return m_transmit_count.load(std::memory_order_relaxed);
+        }
+        uint64_t push_count() const {
+            return m_ring.pushed();
+        }
+
+    private:
+        std::chrono::nanoseconds m_deadline;
+        deadline_timer m_timer;
+        SnapshotRing<T, N> m_ring;
+        T m_transmit_sample;
+        std::atomic<uint64_t> m_transmit_count;
+
+        void periodic_function() {
+            if (!send_pending() && m_ring.latest(&m_transmit_sample)) {
+                async_send(asio::buffer(&m_transmit_sample, sizeof(T)));
+                m_transmit_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_timer.expires_at(m_timer.expires_at() + m_deadline);
+            m_timer.async_wait(std::bind(&SnapshotTransmitServer::periodic_function, this));
+        }
+}; // class SnapshotTransmitServer
+
 } // namespace udp
 } // namespace network
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include "types.h"
+
+namespace model {
+
+/*
+ * This class stores the pitch angle satisfying the bicycle pitch constraint
+ * on a grid of roll and steer angles. The grid is evenly spaced over
+ * [-roll_max, roll_max] x [-steer_max, steer_max] with one additional point
+ * on each side so that a lookup anywhere in the domain can use a 4x4
+ * neighborhood of grid points. A lookup interpolates with bicubic
+ * (Catmull-Rom) convolution, which has third order accuracy in the grid
+ * spacing and requires 16 multiply-adds after the weights are calculated.
+ *
+ * When the table is generated, the interpolation error is checked against the
+ * exact solution at the center of each grid cell, where the error is largest,
+ * and the maximum is available with max_error(). A lookup fails if the angles
+ * lie outside the domain or if the table is empty. In both cases the caller
+ * must solve the pitch constraint.
+ */
+class PitchTable {
+    public:
+        PitchTable();
+
+        // The solve function must have the signature:
+        //   real_t solve(real_t roll, real_t steer)
+        // and return the exact pitch angle for the roll and steer angles.
+        template <typename F>
+        void generate(real_t roll_max, real_t steer_max, real_t spacing, F solve);
+        void clear();
+
+        bool lookup(real_t roll, real_t steer, real_t* pitch) const;
+
+        // accessors
+        bool empty() const;
+        real_t roll_max() const;
+        real_t steer_max() const;
+        real_t spacing() const;
+        real_t max_error() const; // maximum interpolation error at grid cell centers
+        size_t size() const; // number of grid points including padding
+
+    private:
+        real_t m_roll_max;
+        real_t m_steer_max;
+        real_t m_spacing;
+        real_t m_droll; // grid spacing adjusted so that the domain limits are grid points
+        real_t m_dsteer;
+        real_t m_max_error;
+        size_t m_roll_points; // number of points including padding
+        size_t m_steer_points;
+        std::vector<real_t> m_pitch; // row major with steer index varying fastest
+
+        real_t interpolate(real_t roll, real_t steer) const;
+        static void catmull_rom_weights(real_t t, real_t w[4]);
+}; // class PitchTable
+
+inline bool PitchTable::empty() const {
+    return m_pitch.empty();
+}
+
+inline real_t PitchTable::roll_max() const {
+    return m_roll_max;
+}
+
+inline real_t PitchTable::steer_max() const {
+    return m_steer_max;
+}
+
+inline real_t PitchTable::spacing() const {
+    return m_spacing;
+}
+
+inline real_t PitchTable::max_error() const {
+    return m_max_error;
+}
+
+inline size_t PitchTable::size() const {
+    return m_pitch.size();
+}
+
+} // namespace model
+
+#include "pitch_table.hh"
@@ -0,0 +1,236 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include "sample_generated.h"
+
+namespace fbs {
+
+/*
+ * Kalman and Lqr struct fields that are omitted from a delta encoded Sample
+ * when they are unchanged from the previous sample.
+ */
+enum class delta_field_t: uint8_t {
+    kalman_state_estimate = 0,
+    kalman_error_covariance,
+    kalman_process_noise_covariance,
+    kalman_measurement_noise_covariance,
+    kalman_gain,
+    lqr_reference,
+    lqr_state_cost,
+    lqr_input_cost,
+    lqr_horizon_cost,
+    lqr_gain,
+    lqr_integral_cost,
+    lqr_integral,
+    number_of_types
+};
+
+namespace delta {
+    constexpr size_t field_count = static_cast<size_t>(delta_field_t::number_of_types);
+    constexpr size_t max_field_size = sizeof(SymmetricStateMatrix); // largest Kalman or Lqr struct
+
+    struct field_value_t {
+        bool present;
+        alignas(8) uint8_t data[max_field_size];
+    };
+} // namespace delta
+
+/*
+ * This class decides which Kalman and Lqr struct fields must be serialized
+ * for a delta encoded sample log.
+ *
+ * The converged error covariance, horizon cost and gains are bit-identical
+ * over many samples and dominate the size of a log when serialized every
+ * sample. A field is serialized only if its value differs from the last
+ * serialized value or the sample is a keyframe. Keyframes occur every
+ * keyframe_interval samples and serialize every field requested, so that a
+ * reader can start decoding at any keyframe. The Sample must be created with
+ * delta = !keyframe().
+ *
+ * Fields are compared bitwise and no allocation is performed, so the encoder
+ * can be used in the control loop.
+ */
+class SampleDeltaEncoder {
+    public:
+        static constexpr size_t default_keyframe_interval = 1000;
+
+        explicit SampleDeltaEncoder(size_t keyframe_interval = default_keyframe_interval);
+
+        // must be called once for each sample before update()
+        void next_sample();
+
+        // Returns true if the field must be serialized in the current sample
+        // and stores the value for comparison with the following samples.
+        template <typename T>
+        bool update(delta_field_t field, const T& value);
+
+        // accessors
+        bool keyframe() const;
+        size_t keyframe_interval() const;
+
+    private:
+        size_t m_keyframe_interval;
+        size_t m_sample_count;
+        bool m_keyframe;
+        std::array<delta::field_value_t, delta::field_count> m_fields;
+}; // class SampleDeltaEncoder
+
+/*
+ * This class reconstructs the Kalman and Lqr struct fields of a delta encoded
+ * sample log. Samples must be passed to update() in order, starting from a
+ * keyframe (a Sample with delta() == false). A log written without delta
+ * encoding consists of keyframes only.
+ */
+class SampleDeltaDecoder {
+    public:
+        SampleDeltaDecoder();
+
+        void update(const Sample* sample);
+        void reset();
+
+        // Returns the latest value of a field or nullptr if the field has not
+        // been present since the last keyframe.
+        template <typename T>
+        const T* get(delta_field_t field) const;
+
+        // Create a copy of the sample with all reconstructed fields present.
+        // The sample must be the last sample passed to update().
+        flatbuffers::Offset<Sample> create_sample(flatbuffers::FlatBufferBuilder& fbb,
+                const Sample* sample) const;
+
+    private:
+        std::array<delta::field_value_t, delta::field_count> m_fields;
+
+        template <typename T>
+        void store(delta_field_t field, const T* value);
+        bool any_present(delta_field_t first, delta_field_t last) const; // fields in [first, last]
+}; // class SampleDeltaDecoder
+
+inline SampleDeltaEncoder::SampleDeltaEncoder(size_t keyframe_interval) :
+    m_keyframe_interval(keyframe_interval > 0 ? keyframe_interval : 1),
+    m_sample_count(0),
+    m_keyframe(true) {
+    for (auto& f: m_fields) {
+        f.present = false;
+    }
+}
+
+inline void SampleDeltaEncoder::next_sample() {
+    m_keyframe = (m_sample_count++ % m_keyframe_interval) == 0;
+}
+
+template <typename T>
+inline bool SampleDeltaEncoder::update(delta_field_t field, const T& value) {
+    static_assert(sizeof(T) <= delta::max_field_size, "Field type is too large.");
+    delta::field_value_t& f = m_fields[static_cast<size_t>(field)];
+    if (!m_keyframe && f.present && (std::memcmp(f.data, &value, sizeof(T)) == 0)) {
+        return false;
+    }
+    std::memcpy(f.data, &value, sizeof(T));
+    f.present = true;
+    return true;
+}
+
+inline bool SampleDeltaEncoder::keyframe() const {
+    return m_keyframe;
+}
+
+inline size_t SampleDeltaEncoder::keyframe_interval() const {
+    return m_keyframe_interval;
+}
+
+inline SampleDeltaDecoder::SampleDeltaDecoder() {
+    reset();
+}
+
+inline void SampleDeltaDecoder::reset() {
+    for (auto& f: m_fields) {
+        f.present = false;
+    }
+}
+
+inline void SampleDeltaDecoder::update(const Sample* sample) {
+    if (!sample->delta()) {
+        reset();
+    }
+    if (const Kalman* k = sample->kalman()) {
+        store(delta_field_t::kalman_state_estimate, k->state_estimate());
+        store(delta_field_t::kalman_error_covariance, k->error_covariance());
+        store(delta_field_t::kalman_process_noise_covariance, k->process_noise_covariance());
+        store(delta_field_t::kalman_measurement_noise_covariance, k->measurement_noise_covariance());
+        store(delta_field_t::kalman_gain, k->kalman_gain());
+    }
+    if (const Lqr* l = sample->lqr()) {
+        store(delta_field_t::lqr_reference, l->reference());
+        store(delta_field_t::lqr_state_cost, l->state_cost());
+        store(delta_field_t::lqr_input_cost, l->input_cost());
+        store(delta_field_t::lqr_horizon_cost, l->horizon_cost());
+        store(delta_field_t::lqr_gain, l->lqr_gain());
+        store(delta_field_t::lqr_integral_cost, l->integral_cost());
+        store(delta_field_t::lqr_integral, l->integral());
+    }
+}
+
+template <typename T>
+inline const T* SampleDeltaDecoder::get(delta_field_t field) const {
+    const delta::field_value_t& f = m_fields[static_cast<size_t>(field)];
+    return f.present ? reinterpret_cast<const T*>(f.data) : nullptr;
+}
+
+template <typename T>
+inline void SampleDeltaDecoder::store(delta_field_t field, const T* value) {
+    static_assert(sizeof(T) <= delta::max_field_size, "Field type is too large.");
+    if (value != nullptr) {
+        delta::field_value_t& f = m_fields[static_cast<size_t>(field)];
+        std::memcpy(f.data, value, sizeof(T));
+        f.present = true;
+    }
+}
+
+inline bool SampleDeltaDecoder::any_present(delta_field_t first, delta_field_t last) const {
+    for (size_t i = static_cast<size_t>(first); i <= static_cast<size_t>(last); ++i) {
+        if (m_fields[i].present) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline flatbuffers::Offset<Sample> SampleDeltaDecoder::create_sample(
+        flatbuffers::FlatBufferBuilder& fbb, const Sample* sample) const {
+    auto bicycle_location = flatbuffers::Offset<Bicycle>();
+    if (const Bicycle* b = sample->bicycle()) {
+        bicycle_location = CreateBicycle(fbb, b->v(), b->dt(), b->M(), b->C1(), b->K0(), b->K2(),
+                b->Ad(), b->Bd(), b->Cd(), b->Dd());
+    }
+    auto kalman_location = flatbuffers::Offset<Kalman>();
+    if ((sample->kalman() != nullptr) ||
+            any_present(delta_field_t::kalman_state_estimate, delta_field_t::kalman_gain)) {
+        kalman_location = CreateKalman(fbb,
+                get<State>(delta_field_t::kalman_state_estimate),
+                get<SymmetricStateMatrix>(delta_field_t::kalman_error_covariance),
+                get<SymmetricStateMatrix>(delta_field_t::kalman_process_noise_covariance),
+                get<SymmetricOutputMatrix>(delta_field_t::kalman_measurement_noise_covariance),
+                get<KalmanGainMatrix>(delta_field_t::kalman_gain));
+    }
+    auto lqr_location = flatbuffers::Offset<Lqr>();
+    if ((sample->lqr() != nullptr) ||
+            any_present(delta_field_t::lqr_reference, delta_field_t::lqr_integral)) {
+        lqr_location = CreateLqr(fbb,
+                sample->lqr() ? sample->lqr()->horizon() : 0,
+                get<State>(delta_field_t::lqr_reference),
+                get<SymmetricStateMatrix>(delta_field_t::lqr_state_cost),
+                get<SymmetricInputMatrix>(delta_field_t::lqr_input_cost),
+                get<SymmetricStateMatrix>(delta_field_t::lqr_horizon_cost),
+                get<LqrGainMatrix>(delta_field_t::lqr_gain),
+                get<SymmetricStateMatrix>(delta_field_t::lqr_integral_cost),
+                get<State>(delta_field_t::lqr_integral));
+    }
+    return CreateSample(fbb, sample->timestamp(), sample->computation_time(),
+            bicycle_location, kalman_location, lqr_location,
+            sample->state(), sample->input(), sample->output(), sample->measurement(),
+            sample->auxiliary_state(), false);
+}
+
+} // namespace fbs
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace fbs {
+namespace compression {
+
+/*
+ * Lossless compression of a block of sample records.
+ *
+ * Consecutive samples have the same flatbuffer layout, and their values
+ * (smooth time series of doubles, converged matrices) differ only in the low
+ * order bytes. A block is encoded in three stages:
+ *   1. each record is XORed with the previous record in the block if both
+ *      have the same size, which zeroes the vtables, offsets and the sign,
+ *      exponent and high mantissa bytes of slowly varying doubles,
+ *   2. the bytes are shuffled so that byte k of every 8 byte word is stored
+ *      contiguously, grouping the zeroed bytes into long runs,
+ *   3. runs of zero bytes are run-length encoded and other bytes are copied.
+ * Each block is independently decodable as the first record of a block is
+ * not XORed.
+ *
+ * Encoded block layout (all integers little-endian):
+ *   uint32 record_count, uint32 data_size, uint32 size[record_count],
+ *   followed by the run-length encoded bytes
+ * The decoded data is the concatenation of the records without size prefix.
+ */
+
+// The data must contain sizes.size() records with total size data_size.
+// The scratch buffer is used for intermediate results and may be reused
+// between calls to avoid allocation.
+void encode_block(const std::vector<uint32_t>& sizes, const uint8_t* data,
+        std::vector<uint8_t>* encoded, std::vector<uint8_t>* scratch);
+
+// Returns false if the encoded block is invalid.
+bool decode_block(const uint8_t* encoded, size_t encoded_size,
+        std::vector<uint32_t>* sizes, std::vector<uint8_t>* data,
+        std::vector<uint8_t>* scratch);
+
+} // namespace compression
+} // namespace fbs
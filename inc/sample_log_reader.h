@@ -0,0 +1,149 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "sample_log_generated.h"
+
+namespace fbs {
+
+/*
+ * This class provides random access to the samples of a log file without
+ * copying or parsing the file. The file is memory mapped and an index of the
+ * offset and size of each sample is built when the file is opened, after which
+ * access to any sample is O(1). Samples are read directly from the mapped file
+ * and pages are loaded by the operating system as they are accessed, so memory
+ * use is bounded by the index (16 bytes per sample) and not the size of the
+ * file.
+ *
+ * Three file formats are supported:
+ *   container: a single SampleLog flatbuffer with nested Sample buffers
+ *   stream: size-prefixed Sample records written by SampleLogWriter
+ *   compressed stream: compressed blocks of records written by SampleLogWriter
+ * For a stream file, the index is built by reading only the record size
+ * prefixes. If the stream has an index footer, the sample count is taken from
+ * it. A stream without footer, e.g. after a crash, is read until the last
+ * complete record or block.
+ *
+ * For a compressed stream, the index is built from the block headers and a
+ * block is decoded when one of its samples is accessed. The most recently
+ * decoded blocks are cached, and a pointer returned for a sample is valid
+ * until cache_size other blocks have been decoded. A reader of a compressed
+ * stream must not be shared between threads. For the other formats, the
+ * returned pointers are valid for the lifetime of the reader and the reader
+ * may be shared between threads.
+ */
+class SampleLogReader {
+    public:
+        enum class format_t: uint8_t {
+            container = 0,
+            stream,
+            compressed_stream
+        };
+        static constexpr size_t cache_size = 4; // number of decoded blocks
+
+        explicit SampleLogReader(const char* filename);
+        ~SampleLogReader();
+        SampleLogReader(const SampleLogReader&) = delete;
+        SampleLogReader& operator=(const SampleLogReader&) = delete;
+
+        const Sample* sample(size_t index) const;
+        const uint8_t* data(size_t index) const; // start of the Sample flatbuffer
+        uint32_t data_size(size_t index) const;
+
+        // Returns the index of the last keyframe at or before index. Decoding
+        // of a delta encoded log must start at a keyframe, see sample_delta.h.
+        size_t keyframe(size_t index) const;
+
+        // The function must have the signature:
+        //   void f(size_t index, const Sample* sample)
+        // and is called for every stride-th sample in [begin, end).
+        template <typename F>
+        void for_each(size_t begin, size_t end, size_t stride, F f) const;
+
+        // accessors
+        size_t size() const;
+        format_t format() const;
+        size_t file_size() const;
+
+    private:
+        struct record_t {
+            uint64_t offset; // from the start of the file or the decoded block
+            uint32_t size;
+            uint32_t block; // only used for a compressed stream
+        };
+        struct block_t {
+            uint64_t offset; // start of the encoded block
+            uint32_t size;
+        };
+        struct cached_block_t {
+            size_t block;
+            std::vector<uint8_t> data;
+        };
+
+        const uint8_t* m_data;
+        size_t m_file_size;
+        format_t m_format;
+        std::vector<record_t> m_index;
+        std::vector<block_t> m_blocks;
+
+        mutable std::array<cached_block_t, cache_size> m_cache;
+        mutable size_t m_cache_next;
+        mutable std::vector<uint32_t> m_decode_sizes;
+        mutable std::vector<uint8_t> m_decode_scratch;
+
+        void build_container_index();
+        void build_stream_index();
+        void build_compressed_stream_index();
+        size_t stream_end(size_t* samples) const; // end of records or blocks, excluding footer
+        const uint8_t* block_data(size_t block) const;
+}; // class SampleLogReader
+
+inline const Sample* SampleLogReader::sample(size_t index) const {
+    return flatbuffers::GetRoot<Sample>(data(index));
+}
+
+inline const uint8_t* SampleLogReader::data(size_t index) const {
+    const record_t& r = m_index[index];
+    if (m_format == format_t::compressed_stream) {
+        return block_data(r.block) + r.offset;
+    }
+    return m_data + r.offset;
+}
+
+inline uint32_t SampleLogReader::data_size(size_t index) const {
+    return m_index[index].size;
+}
+
+inline size_t SampleLogReader::keyframe(size_t index) const {
+    while ((index > 0) && sample(index)->delta()) {
+        --index;
+    }
+    return index;
+}
+
+template <typename F>
+inline void SampleLogReader::for_each(size_t begin, size_t end, size_t stride, F f) const {
+    if (end > size()) {
+        end = size();
+    }
+    if (stride == 0) {
+        stride = 1;
+    }
+    for (size_t i = begin; i < end; i += stride) {
+        f(i, sample(i));
+    }
+}
+
+inline size_t SampleLogReader::size() const {
+    return m_index.size();
+}
+
+inline SampleLogReader::format_t SampleLogReader::format() const {
+    return m_format;
+}
+
+inline size_t SampleLogReader::file_size() const {
+    return m_file_size;
+}
+
+} // namespace fbs
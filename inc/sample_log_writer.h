@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "flatbuffers/flatbuffers.h"
+
+namespace fbs {
+
+/*
+ * This class streams finished flatbuffers, e.g. Sample tables, to a file.
+ *
+ * The loop thread acquires a builder from a bounded ring of reusable
+ * builders, serializes a sample with it, and commits it. A background thread
+ * appends committed buffers to the file, clears the builders and returns them
+ * to the ring. Builders keep their memory when cleared, so memory use does not
+ * grow with the length of the run, and acquire() and commit() never wait on
+ * the file. If all builders are in use, acquire() returns nullptr and the
+ * sample is counted as dropped.
+ *
+ * The file is synchronized to disk periodically so that at most one sync
+ * period of samples is lost in a crash.
+ *
+ * If a write or sync fails, e.g. when the disk is full, the error flag is
+ * set and nothing more is written to the file. Samples that are not written
+ * because of the error are counted as dropped. The loop thread can poll
+ * error().
+ *
+ * File layout (all integers little-endian):
+ *   record: uint32 size, uint32 reserved = 0, followed by size bytes of a
+ *           finished flatbuffer and zero padding to a multiple of 8 bytes
+ *   footer: uint64 offset[count], uint64 index_interval, uint64 samples,
+ *           uint32 count, char identifier[4] = "BIDX"
+ * Records start at multiples of record_alignment so that the flatbuffer is
+ * aligned for its 8-byte scalars and structs when the file is memory mapped.
+ * The footer is written when the writer is closed. offset[i] is the file
+ * offset of record i*index_interval, allowing a reader to seek near a sample
+ * without reading all previous records. A file without footer, e.g. after a
+ * crash, can be read by scanning records until the end of the file.
+ *
+ * With block compression, index_interval records are collected and written
+ * as a compressed block (see sample_log_compression.h) and the layout is:
+ *   header: char identifier[4] = "BCMP", uint32 index_interval
+ *   block: uint32 size, followed by size bytes of an encoded block
+ *   footer: as above, with offset[i] the file offset of block i
+ * Blocks are independently decodable so random access is preserved. A block
+ * is only written when it is full or the writer is closed, so in a crash up
+ * to index_interval samples may be lost in addition to the sync period.
+ * Samples are counted as written when their block is written.
+ */
+class SampleLogWriter {
+    public:
+        static constexpr size_t default_ring_size = 64;
+        static constexpr size_t default_builder_size = 4096;
+        static constexpr size_t default_index_interval = 1024;
+        static constexpr size_t record_alignment = 8; // bytes
+        static constexpr char index_identifier[4] = {'B', 'I', 'D', 'X'};
+        static constexpr char compression_identifier[4] = {'B', 'C', 'M', 'P'};
+
+        enum class compression_t: uint8_t {
+            none = 0,
+            block
+        };
+
+        SampleLogWriter(const char* filename,
+                size_t ring_size = default_ring_size,
+                std::chrono::milliseconds sync_period = std::chrono::milliseconds(1000),
+                size_t index_interval = default_index_interval,
+                compression_t compression = compression_t::none);
+        ~SampleLogWriter(); // calls close()
+        SampleLogWriter(const SampleLogWriter&) = delete;
+        SampleLogWriter& operator=(const SampleLogWriter&) = delete;
+
+        // Must only be called from a single producer thread. The acquired
+        // builder must be finished before commit() is called.
+        flatbuffers::FlatBufferBuilder* acquire();
+        void commit();
+
+        // write all committed buffers and the footer and close the file
+        void close();
+
+        // accessors
+        uint64_t samples_written() const;
+        uint64_t samples_dropped() const;
+        compression_t compression() const;
+        bool error() const; // a write or sync to the file has failed
+
+    private:
+        struct file_closer {
+            void operator()(std::FILE* file) const { std::fclose(file); }
+        };
+        using file_t = std::unique_ptr<std::FILE, file_closer>;
+
+        file_t m_file; // closed on destruction if the constructor throws
+        std::vector<std::unique_ptr<flatbuffers::FlatBufferBuilder>> m_ring;
+        std::chrono::milliseconds m_sync_period;
+        size_t m_index_interval;
+        std::vector<uint64_t> m_index; // one entry per index_interval samples
+        uint64_t m_file_offset;
+        compression_t m_compression;
+
+        // records of the current block and encoding buffers, used only by the writer thread
+        std::vector<uint32_t> m_block_sizes;
+        std::vector<uint8_t> m_block_data;
+        std::vector<uint8_t> m_block_encoded;
+        std::vector<uint8_t> m_block_scratch;
+
+        // single producer, single consumer ring indices, ring slot is index % size
+        std::atomic<uint64_t> m_head; // next builder to acquire
+        std::atomic<uint64_t> m_tail; // next builder to write
+        bool m_acquired;
+        std::atomic<uint64_t> m_samples_written;
+        std::atomic<uint64_t> m_samples_dropped;
+        std::atomic<bool> m_error;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition_variable;
+        bool m_closing;
+        std::thread m_writer_thread;
+
+        static file_t open_file(const char* filename, size_t ring_size, size_t index_interval);
+        void run_writer();
+        void write_record(const flatbuffers::FlatBufferBuilder& builder);
+        void write_block();
+        void write_footer();
+        void write(const void* data, size_t size);
+        void sync();
+}; // class SampleLogWriter
+
+inline uint64_t SampleLogWriter::samples_written() const {
+    return m_samples_written.load();
+}
+
+inline uint64_t SampleLogWriter::samples_dropped() const {
+    return m_samples_dropped.load();
+}
+
+inline SampleLogWriter::compression_t SampleLogWriter::compression() const {
+    return m_compression;
+}
+
+inline bool SampleLogWriter::error() const {
+    return m_error.load();
+}
+
+} // namespace fbs
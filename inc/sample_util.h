@@ -11,7 +11,7 @@
 namespace fbs {
 
 // TODO: generate per DiscreteLinear derived class
-::fbs::State state(const model::BicycleWhipple::state_t& x) {
+inline ::fbs::State state(const model::BicycleWhipple::state_t& x) {
     return ::fbs::State(
     x(0),
     x(1),
@@ -20,19 +20,19 @@ namespace fbs {
     x(4));
 }
 
-::fbs::Input input(const model::BicycleWhipple::input_t& u) {
+inline ::fbs::Input input(const model::BicycleWhipple::input_t& u) {
     return ::fbs::Input(
     u(0),
     u(1));
 }
 
-::fbs::Output output(const model::BicycleWhipple::output_t& y) {
+inline ::fbs::Output output(const model::BicycleWhipple::output_t& y) {
     return ::fbs::Output(
     y(0),
     y(1));
 }
 
-::fbs::AuxiliaryState auxiliary_state(const model::BicycleWhipple::auxiliary_state_t& x) {
+inline ::fbs::AuxiliaryState auxiliary_state(const model::BicycleWhipple::auxiliary_state_t& x) {
     return ::fbs::AuxiliaryState(
     x(0),
     x(1),
@@ -40,7 +40,7 @@ namespace fbs {
     x(3));
 }
 
-::fbs::StateMatrix state_matrix(const model::BicycleWhipple::state_matrix_t& a) {
+inline ::fbs::StateMatrix state_matrix(const model::BicycleWhipple::state_matrix_t& a) {
     return ::fbs::StateMatrix(
     a(0, 0),
     a(0, 1),
@@ -69,7 +69,7 @@ namespace fbs {
     a(4, 4));
 }
 
-::fbs::InputMatrix input_matrix(const model::BicycleWhipple::input_matrix_t& b) {
+inline ::fbs::InputMatrix input_matrix(const model::BicycleWhipple::input_matrix_t& b) {
     return ::fbs::InputMatrix(
     b(0, 0),
     b(0, 1),
@@ -83,7 +83,7 @@ namespace fbs {
     b(4, 1));
 }
 
-::fbs::OutputMatrix output_matrix(const model::BicycleWhipple::output_matrix_t& c) {
+inline ::fbs::OutputMatrix output_matrix(const model::BicycleWhipple::output_matrix_t& c) {
     return ::fbs::OutputMatrix(
     c(0, 0),
     c(0, 1),
@@ -97,7 +97,7 @@ namespace fbs {
     c(1, 4));
 }
 
-::fbs::FeedthroughMatrix feedthrough_matrix(const model::BicycleWhipple::feedthrough_matrix_t& d) {
+inline ::fbs::FeedthroughMatrix feedthrough_matrix(const model::BicycleWhipple::feedthrough_matrix_t& d) {
     return ::fbs::FeedthroughMatrix(
     d(0, 0),
     d(0, 1),
@@ -105,7 +105,7 @@ namespace fbs {
     d(1, 1));
 }
 
-::fbs::SymmetricStateMatrix symmetric_state_matrix(const model::BicycleWhipple::state_matrix_t& m) {
+inline ::fbs::SymmetricStateMatrix symmetric_state_matrix(const model::BicycleWhipple::state_matrix_t& m) {
     return ::fbs::SymmetricStateMatrix(
     m(0, 0),
     m(0, 1),
@@ -124,14 +124,14 @@ namespace fbs {
     m(4, 4));
 }
 
-::fbs::SymmetricInputMatrix symmetric_input_matrix(const controller::Lqr<model::BicycleWhipple>::input_cost_t& m) {
+inline ::fbs::SymmetricInputMatrix symmetric_input_matrix(const controller::Lqr<model::BicycleWhipple>::input_cost_t& m) {
     return ::fbs::SymmetricInputMatrix(
     m(0, 0),
     m(0, 1),
     m(1, 1));
 }
 
-::fbs::SymmetricOutputMatrix symmetric_output_matrix(
+inline ::fbs::SymmetricOutputMatrix symmetric_output_matrix(
         const observer::Kalman<model::BicycleWhipple>::measurement_noise_covariance_t& m) {
     return ::fbs::SymmetricOutputMatrix(
     m(0, 0),
@@ -139,7 +139,7 @@ namespace fbs {
     m(1, 1));
 }
 
-::fbs::SecondOrderMatrix second_order_matrix(const model::BicycleWhipple::second_order_matrix_t& m) {
+inline ::fbs::SecondOrderMatrix second_order_matrix(const model::BicycleWhipple::second_order_matrix_t& m) {
     return ::fbs::SecondOrderMatrix(
     m(0, 0),
     m(0, 1),
@@ -147,7 +147,7 @@ namespace fbs {
     m(1, 1));
 }
 
-::fbs::KalmanGainMatrix kalman_gain_matrix(const observer::Kalman<model::BicycleWhipple>::kalman_gain_t& k) {
+inline ::fbs::KalmanGainMatrix kalman_gain_matrix(const observer::Kalman<model::BicycleWhipple>::kalman_gain_t& k) {
     return ::fbs::KalmanGainMatrix(
     k(0, 0),
     k(0, 1),
@@ -161,7 +161,7 @@ namespace fbs {
     k(4, 1));
 }
 
-::fbs::LqrGainMatrix lqr_gain_matrix(const controller::Lqr<model::BicycleWhipple>::lqr_gain_t& k) {
+inline ::fbs::LqrGainMatrix lqr_gain_matrix(const controller::Lqr<model::BicycleWhipple>::lqr_gain_t& k) {
     return ::fbs::LqrGainMatrix(
     k(0, 0),
     k(0, 1),
@@ -176,7 +176,7 @@ namespace fbs {
 }
 
 
-flatbuffers::Offset<::fbs::Bicycle> create_bicycle(
+inline flatbuffers::Offset<::fbs::Bicycle> create_bicycle(
         flatbuffers::FlatBufferBuilder& fbb,
         const model::BicycleWhipple& bicycle, bool dt = true, bool v = true,
         bool M = true, bool C1 = true, bool K0 = true, bool K2 = true,
@@ -234,7 +234,7 @@ flatbuffers::Offset<::fbs::Bicycle> create_bicycle(
             Adp, Bdp, Cdp, Ddp);
 }
 
-flatbuffers::Offset<::fbs::Kalman> create_kalman(
+inline flatbuffers::Offset<::fbs::Kalman> create_kalman(
         flatbuffers::FlatBufferBuilder& fbb,
         const observer::Kalman<model::BicycleWhipple>& kalman, bool x = true,
         bool P = true, bool Q = true, bool R = true, bool K = true) {
@@ -268,7 +268,7 @@ flatbuffers::Offset<::fbs::Kalman> create_kalman(
 }
 
 
-flatbuffers::Offset<::fbs::Lqr> create_lqr(
+inline flatbuffers::Offset<::fbs::Lqr> create_lqr(
         flatbuffers::FlatBufferBuilder& fbb,
         const controller::Lqr<model::BicycleWhipple>& lqr, bool n = true,
         bool r = true, bool P = true, bool Q = true, bool R = true,
@@ -0,0 +1,84 @@
+#pragma once
+#include <Eigen/Core>
+#include "observer.h"
+#include "gain_schedule.h"
+
+namespace observer {
+
+/*
+ * This template class implements a steady state Kalman filter with the Kalman
+ * gain interpolated from a precomputed gain schedule at the current system
+ * speed. The error covariance is not propagated and P() returns the
+ * interpolated steady state a posteriori error covariance.
+ *
+ * The gain schedule is not copied and must outlive the observer.
+ */
+template <typename T>
+class ScheduledKalman final : public Observer<T> {
+    public:
+        using model_t = T;
+        using schedule_t = model::GainSchedule<T>;
+        using state_t = typename T::state_t;
+        using input_t = typename T::input_t;
+        using measurement_t = typename T::output_t;
+        using kalman_gain_t = typename schedule_t::kalman_gain_t;
+        using error_covariance_t = typename schedule_t::error_covariance_t;
+
+        ScheduledKalman(T& system, const schedule_t& schedule,
+                const state_t& x0 = state_t::Zero());
+
+        virtual void reset() override;
+        // simplified time and measurement update
+        virtual void update_state(const input_t& u, const measurement_t& z) override;
+
+        void time_update();
+        void time_update(const input_t& u);
+        void measurement_update(const measurement_t& z);
+
+        void set_x(const state_t& x);
+
+        // accessors
+        const state_t& x() const;
+        const schedule_t& schedule() const;
+        const kalman_gain_t& K() const;
+        const error_covariance_t& P() const;
+
+    private:
+        using Observer<T>::m_system;
+        using Observer<T>::m_x;
+        const schedule_t& m_schedule;
+        uint32_t m_system_revision; // system revision of current gain
+        kalman_gain_t m_K;
+        error_covariance_t m_P;
+
+        void update_gain();
+}; // class ScheduledKalman
+
+template <typename T>
+inline void ScheduledKalman<T>::set_x(const state_t& x) {
+    this->set_state(x);
+}
+
+template <typename T>
+inline const typename ScheduledKalman<T>::state_t& ScheduledKalman<T>::x() const {
+    return this->state();
+}
+
+template <typename T>
+inline const typename ScheduledKalman<T>::schedule_t& ScheduledKalman<T>::schedule() const {
+    return m_schedule;
+}
+
+template <typename T>
+inline const typename ScheduledKalman<T>::kalman_gain_t& ScheduledKalman<T>::K() const {
+    return m_K;
+}
+
+template <typename T>
+inline const typename ScheduledKalman<T>::error_covariance_t& ScheduledKalman<T>::P() const {
+    return m_P;
+}
+
+} // namespace observer
+
+#include "scheduled_kalman.hh"
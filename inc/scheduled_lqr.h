@@ -0,0 +1,109 @@
+#pragma once
+#include <type_traits>
+#include <Eigen/Core>
+#include "discrete_linear.h"
+#include "gain_schedule.h"
+
+namespace controller {
+using real_t = model::real_t;
+
+/*
+ * This template class implements an LQR controller with feedback gains
+ * interpolated from a precomputed gain schedule at the current system speed.
+ * No Riccati equation is solved at runtime and the control calculation has
+ * the same form as Lqr at steady state:
+ *     u = K*x + Ki*q
+ * where integral action is enabled for states with a nonzero diagonal entry in
+ * the error integral cost used to generate the schedule.
+ *
+ * The gain schedule is not copied and must outlive the controller.
+ */
+template<typename T>
+class ScheduledLqr {
+    static_assert(std::is_base_of<model::DiscreteLinearBase, T>::value, "Invalid template parameter type for ScheduledLqr");
+    public:
+        using schedule_t = model::GainSchedule<T>;
+        using state_t = typename T::state_t;
+        using input_t = typename T::input_t;
+        using lqr_gain_t = typename schedule_t::lqr_gain_t;
+
+        ScheduledLqr(T& system, const schedule_t& schedule,
+                const state_t& r = state_t::Zero(),
+                const state_t& q = state_t::Zero());
+
+        input_t control_calculate(const state_t& x);
+        input_t control_calculate(const state_t& x, const state_t& r);
+
+        void set_reference(const state_t& r);
+        void set_error_integral(const state_t& q);
+
+        // accessors
+        T& system() const;
+        const schedule_t& schedule() const;
+        const state_t& r() const;
+        const state_t& q() const;
+        const lqr_gain_t& K() const;
+        const lqr_gain_t& Ki() const;
+        real_t dt() const;
+
+    private:
+        T& m_system;                        // controlled system or plant
+        const schedule_t& m_schedule;       // precomputed gains
+        state_t m_r;                        // reference state
+        state_t m_q;                        // error integral
+        state_t m_integral_mask;            // states with integral action
+        uint32_t m_system_revision;         // system revision of current gains
+        lqr_gain_t m_K;                     // interpolated feedback gain
+        lqr_gain_t m_Ki;                    // interpolated error integral gain
+
+        void update_gain();
+}; // class ScheduledLqr
+
+template<typename T>
+inline void ScheduledLqr<T>::set_reference(const state_t& r) {
+    m_r = r;
+}
+
+template<typename T>
+inline void ScheduledLqr<T>::set_error_integral(const state_t& q) {
+    m_q = q;
+}
+
+template<typename T>
+inline T& ScheduledLqr<T>::system() const {
+    return m_system;
+}
+
+template<typename T>
+inline const typename ScheduledLqr<T>::schedule_t& ScheduledLqr<T>::schedule() const {
+    return m_schedule;
+}
+
+template<typename T>
+inline const typename ScheduledLqr<T>::state_t& ScheduledLqr<T>::r() const {
+    return m_r;
+}
+
+template<typename T>
+inline const typename ScheduledLqr<T>::state_t& ScheduledLqr<T>::q() const {
+    return m_q;
+}
+
+template<typename T>
+inline const typename ScheduledLqr<T>::lqr_gain_t& ScheduledLqr<T>::K() const {
+    return m_K;
+}
+
+template<typename T>
+inline const typename ScheduledLqr<T>::lqr_gain_t& ScheduledLqr<T>::Ki() const {
+    return m_Ki;
+}
+
+template<typename T>
+inline real_t ScheduledLqr<T>::dt() const {
+    return m_system.dt();
+}
+
+} // namespace controller
+
+#include "scheduled_lqr.hh"
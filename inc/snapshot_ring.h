@@ -0,0 +1,137 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace network {
+
+/*
+ * This class passes fixed-size samples from one producer thread, e.g. the
+ * control loop, to one consumer thread, e.g. the io_service thread.
+ *
+ * push() is wait-free and never blocks on the consumer. If the consumer falls
+ * behind, the oldest samples are overwritten. Each slot has a sequence number
+ * which is odd while the slot is written (a seqlock). The consumer copies a
+ * sample out of its slot and discards the copy if the sequence number changed
+ * during the copy, so a returned sample is always a consistent snapshot. The
+ * consumer only retries when the producer has wrapped the entire ring during
+ * a single copy.
+ *
+ * Slots and the producer and consumer positions are on separate cache lines
+ * so that the threads do not write to the same cache line.
+ */
+template <typename T, size_t N>
+class SnapshotRing {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(N > 0, "N must be greater than zero");
+    public:
+        static constexpr size_t cache_line_size = 64;
+
+        SnapshotRing();
+
+        // producer
+        void push(const T& value);
+
+        // consumer
+        bool pop(T* value); // oldest unread sample
+        bool latest(T* value); // newest sample, skipping all older unread samples
+
+        // accessors
+        uint64_t pushed() const;
+        uint64_t overwritten() const;
+
+    private:
+        struct alignas(cache_line_size) slot_t {
+            std::atomic<uint64_t> sequence;
+            T value;
+        };
+
+        std::array<slot_t, N> m_slots;
+        alignas(cache_line_size) std::atomic<uint64_t> m_head; // written by producer
+        alignas(cache_line_size) uint64_t m_tail; // consumer only
+        std::atomic<uint64_t> m_overwritten;
+
+        bool read(uint64_t position, T* value) const;
+}; // class SnapshotRing
+
+template <typename T, size_t N>
+SnapshotRing<T, N>::SnapshotRing() :
+    m_head(0),
+    m_tail(0),
+    m_overwritten(0) {
+    for (auto& slot: m_slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t N>
+void SnapshotRing<T, N>::push(const T& value) {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    slot_t& slot = m_slots[head % N];
+    slot.sequence.store(2*head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.value, &value, sizeof(T));
+    slot.sequence.store(2*head + 2, std::memory_order_release);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+template <typename T, size_t N>
+bool SnapshotRing<T, N>::read(uint64_t position, T* value) const {
+    const slot_t& slot = m_slots[position % N];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2*position + 2) {
+        return false; // overwritten or being overwritten
+    }
+    std::memcpy(value, &slot.value, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+template <typename T, size_t N>
+bool SnapshotRing<T, N>::pop(T* value) {
+    while (true) {
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        if (m_tail == head) {
+            return false;
+        }
+        if (head - m_tail > N) {
+            m_overwritten.fetch_add(head - N - m_tail, std::memory_order_relaxed);
+            m_tail = head - N;
+        }
+        if (read(m_tail, value)) {
+            ++m_tail;
+            return true;
+        }
+        // the slot was overwritten during the copy, continue with a newer sample
+        m_overwritten.fetch_add(1, std::memory_order_relaxed);
+        ++m_tail;
+    }
+}
+
+template <typename T, size_t N>
+bool SnapshotRing<T, N>::latest(T* value) {
+    while (true) {
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        if (m_tail == head) {
+            return false;
+        }
+        if (read(head - 1, value)) {
+            m_tail = head;
+            return true;
+        }
+    }
+}
+
+template <typename T, size_t N>
+inline uint64_t SnapshotRing<T, N>::pushed() const {
+    return m_head.load(std::memory_order_relaxed);
+}
+
+template <typename T, size_t N>
+inline uint64_t SnapshotRing<T, N>::overwritten() const {
+    return m_overwritten.load(std::memory_order_relaxed);
+}
+
+} // namespace network
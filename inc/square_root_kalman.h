@@ -0,0 +1,136 @@
+#pragma once
+#include <Eigen/Core>
+#include "observer.h"
+
+namespace observer {
+
+/*
+ * This template class implements a discrete-time square root Kalman filter
+ * with the same interface as Kalman. Instead of the error covariance P, a
+ * factor S with P = S*S' is propagated, which is lower triangular after an
+ * update. Time and measurement updates are calculated by QR factorization of
+ * fixed size pre-arrays, which keeps P symmetric and positive semidefinite by
+ * construction and allows the filter to be run in single precision.
+ *
+ * Process and measurement noise covariances must be positive semidefinite.
+ */
+template <typename T>
+class SquareRootKalman final : public Observer<T> {
+    public:
+        using model_t = T;
+        using state_t = typename T::state_t;
+        using input_t = typename T::input_t;
+        using measurement_t = typename T::output_t;
+        using kalman_gain_t = typename Eigen::Matrix<real_t, T::n, T::l>;
+        using error_covariance_t = typename T::state_matrix_t;
+        using error_covariance_factor_t = typename T::state_matrix_t;
+        using process_noise_covariance_t = typename T::state_matrix_t;
+        using measurement_noise_covariance_t = typename Eigen::Matrix<real_t, T::l, T::l>;
+
+        SquareRootKalman(T& system);
+        SquareRootKalman(T& system, const state_t& x0);
+        SquareRootKalman(T& system, const state_t& x0,
+                const process_noise_covariance_t& Q,
+                const measurement_noise_covariance_t& R,
+                const error_covariance_t& P0);
+
+        virtual void reset() override;
+        // simplified time and measurement update
+        virtual void update_state(const input_t& u, const measurement_t& z) override;
+
+        void time_update();
+        void time_update(const process_noise_covariance_t& Q);
+        void time_update(const input_t& u);
+        void time_update(const input_t& u, const process_noise_covariance_t& Q);
+        void measurement_update(const measurement_t& z);
+        void measurement_update(const measurement_t& z, const measurement_noise_covariance_t& R);
+
+        void set_x(const state_t& x);
+        void set_P(const error_covariance_t& P);
+        void set_Q(const process_noise_covariance_t& Q);
+        void set_R(const measurement_noise_covariance_t& R);
+
+        // accessors
+        const state_t& x() const;
+        const kalman_gain_t& K() const;
+        error_covariance_t P() const;
+        const error_covariance_factor_t& S() const; // factor of P, P = S*S'
+        const process_noise_covariance_t& Q() const;
+        const measurement_noise_covariance_t& R() const;
+
+    private:
+        using Observer<T>::m_system;
+        using Observer<T>::m_x;
+        kalman_gain_t m_K;
+        error_covariance_factor_t m_S;
+        process_noise_covariance_t m_Q;
+        process_noise_covariance_t m_Q_factor;
+        measurement_noise_covariance_t m_R;
+        measurement_noise_covariance_t m_R_factor;
+
+        void time_update_state();
+        void time_update_state(const input_t& u);
+        void time_update_error_covariance(const process_noise_covariance_t& Q_factor);
+        void measurement_update_state(const measurement_t& z);
+        void measurement_update_error_covariance(const measurement_noise_covariance_t& R_factor);
+
+        // return F such that F*F' = A for a positive semidefinite matrix A
+        template <typename M>
+        static M factor(const M& A);
+}; // class SquareRootKalman
+
+template <typename T>
+inline void SquareRootKalman<T>::set_x(const state_t& x) {
+    this->set_state(x);
+}
+
+template <typename T>
+inline void SquareRootKalman<T>::set_P(const error_covariance_t& P) {
+    m_S = factor(P);
+}
+
+template <typename T>
+inline void SquareRootKalman<T>::set_Q(const process_noise_covariance_t& Q) {
+    m_Q = Q;
+    m_Q_factor = factor(Q);
+}
+
+template <typename T>
+inline void SquareRootKalman<T>::set_R(const measurement_noise_covariance_t& R) {
+    m_R = R;
+    m_R_factor = factor(R);
+}
+
+template <typename T>
+inline const typename SquareRootKalman<T>::state_t& SquareRootKalman<T>::x() const {
+    return this->state();
+}
+
+template <typename T>
+inline const typename SquareRootKalman<T>::kalman_gain_t& SquareRootKalman<T>::K() const {
+    return m_K;
+}
+
+template <typename T>
+inline typename SquareRootKalman<T>::error_covariance_t SquareRootKalman<T>::P() const {
+    return m_S*m_S.transpose();
+}
+
+template <typename T>
+inline const typename SquareRootKalman<T>::error_covariance_factor_t& SquareRootKalman<T>::S() const {
+    return m_S;
+}
+
+template <typename T>
+inline const typename SquareRootKalman<T>::process_noise_covariance_t& SquareRootKalman<T>::Q() const {
+    return m_Q;
+}
+
+template <typename T>
+inline const typename SquareRootKalman<T>::measurement_noise_covariance_t& SquareRootKalman<T>::R() const {
+    return m_R;
+}
+
+} // namespace observer
+
+#include "square_root_kalman.hh"
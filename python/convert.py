@@ -1,5 +1,7 @@
 #!/usr/bin/env python
 # -*- coding: utf-8 -*-
+import json
+import struct
 import numpy as np
 from flatbuffers.number_types import Float64Flags as fbfloat64
 from flatbuffers.number_types import UOffsetTFlags as fbuoffset
@@ -16,17 +18,189 @@ def get_fbs_sample(fbs_sample_log, index):
     return FbsSample.GetRootAsSample(sb._tab.Bytes[a : a+sb.DataLength()], 0)
 
 
+class SampleDeltaDecoder(object):
+    """Reconstructs the Kalman and Lqr struct fields of a delta encoded sample
+    log (see inc/sample_delta.h). In a sample with Delta() set, a struct field
+    that is not present is unchanged from the previous sample. Samples must be
+    passed to update() in order, starting from a keyframe.
+    """
+    fields = {'Kalman': ('StateEstimate', 'ErrorCovariance',
+                         'ProcessNoiseCovariance',
+                         'MeasurementNoiseCovariance', 'KalmanGain'),
+              'Lqr': ('Reference', 'StateCost', 'InputCost', 'HorizonCost',
+                      'LqrGain', 'IntegralCost', 'Integral')}
+
+    def __init__(self):
+        self.values = {table: {} for table in self.fields}
+
+    def update(self, fbs_sample):
+        if not fbs_sample.Delta():
+            for v in self.values.values():
+                v.clear()
+        for table, fields in self.fields.items():
+            fbs_table = getattr(fbs_sample, table)()
+            if fbs_table is None:
+                continue
+            for field in fields:
+                value = getattr(fbs_table, field)()
+                if value is not None:
+                    self.values[table][field] = value
+        return _DecodedSample(fbs_sample, self.values)
+
+
+class _DecodedSample(object):
+    def __init__(self, fbs_sample, values):
+        self._sample = fbs_sample
+        self._values = values
+
+    def __getattr__(self, name):
+        if name not in self._values:
+            return getattr(self._sample, name)
+        fbs_table = getattr(self._sample, name)()
+        values = dict(self._values[name])
+        if fbs_table is None and not values:
+            return lambda: None
+        return lambda: _DecodedTable(fbs_table, values,
+                                     SampleDeltaDecoder.fields[name])
+
+
+class _DecodedTable(object):
+    def __init__(self, fbs_table, values, fields):
+        self._table = fbs_table
+        self._values = values
+        self._fields = fields
+
+    def __getattr__(self, name):
+        if name in self._fields:
+            value = self._values.get(name)
+            return lambda: value
+        if self._table is None:
+            return lambda: 0 # scalar default value
+        return getattr(self._table, name)
+
+
 def load_sample_log(filename):
     with open(filename, 'rb') as f:
         buf = f.read()
     log = FbsSampleLog.GetRootAsSampleLog(bytearray(buf), 0)
     rec_samples = nmrecarray(log.SamplesLength(), dtype=npt.sample_t)
+    decoder = SampleDeltaDecoder()
     for i in range(len(rec_samples)):
-        convert_record_subfield(rec_samples[i : i+1], get_fbs_sample(log, i),
+        convert_record_subfield(rec_samples[i : i+1],
+                                decoder.update(get_fbs_sample(log, i)),
                                 convert_sample)
     return rec_samples
 
 
+def _decode_block(buf, offset, size):
+    """Decode a block written by fbs::compression::encode_block. Returns the
+    record sizes and the concatenated records.
+    """
+    count, data_size = struct.unpack_from('<II', buf, offset)
+    sizes = struct.unpack_from('<{}I'.format(count), buf, offset + 8)
+    shuffled = bytearray(data_size)
+    i = offset + 8 + 4*count
+    o = 0
+    while i < offset + size:
+        c = buf[i]
+        i += 1
+        n = (c & 0x7f) + 1
+        if not c & 0x80:
+            shuffled[o : o+n] = buf[i : i+n]
+            i += n
+        o += n
+
+    words = data_size//8
+    y = np.frombuffer(shuffled, dtype=np.uint8)
+    x = np.empty(data_size, dtype=np.uint8)
+    x[:8*words] = y[:8*words].reshape(8, words).T.reshape(-1)
+    x[8*words:] = y[8*words:]
+
+    o = 0
+    for r, s in enumerate(sizes):
+        if r > 0 and s == sizes[r - 1]:
+            x[o : o+s] ^= x[o-s : o]
+        o += s
+    return sizes, x.tobytes()
+
+
+def _decode_compressed_stream(buf, end):
+    """Decode the blocks of a compressed stream and return a buffer with the
+    concatenated records and the offset of each record in that buffer.
+    """
+    data = bytearray()
+    records = []
+    offset = 8
+    while offset + 4 <= end:
+        size, = struct.unpack_from('<I', buf, offset)
+        if offset + 4 + size > end:
+            break
+        sizes, block = _decode_block(buf, offset + 4, size)
+        record_offset = len(data)
+        for s in sizes:
+            records.append(record_offset)
+            record_offset += s
+        data += block
+        offset += 4 + size
+    return data, records
+
+
+def load_sample_stream(filename):
+    """Load samples written by fbs::SampleLogWriter. Each record is a uint32
+    size and a reserved uint32 followed by a Sample flatbuffer, padded to a
+    multiple of 8 bytes. The index footer, if present, is skipped and a
+    truncated final record is ignored. Block compressed streams
+    are decoded, ignoring a truncated final block.
+    """
+    with open(filename, 'rb') as f:
+        buf = bytearray(f.read())
+    end = len(buf)
+    if end >= 24 and buf[-4:] == b'BIDX':
+        index_count, = struct.unpack_from('<I', buf, end - 8)
+        end -= 24 + 8*index_count
+
+    if buf[:4] == b'BCMP':
+        buf, records = _decode_compressed_stream(buf, end)
+    else:
+        records = []
+        offset = 0
+        while offset + 8 <= end:
+            size, = struct.unpack_from('<I', buf, offset)
+            if offset + 8 + size > end:
+                break
+            records.append(offset + 8)
+            offset += 8 + (size + 7)//8*8
+
+    rec_samples = nmrecarray(len(records), dtype=npt.sample_t)
+    decoder = SampleDeltaDecoder()
+    for i, r in enumerate(records):
+        convert_record_subfield(rec_samples[i : i+1],
+                                decoder.update(FbsSample.GetRootAsSample(buf, r)),
+                                convert_sample)
+    return rec_samples
+
+
+def load_columns(filename):
+    """Load a columnar file written by tools/flatcolumns. Returns a dict
+    mapping each column name to a read-only memory mapped array. Presence
+    bitmaps '<field>.present' are unpacked to boolean arrays.
+    """
+    with open(filename + '.json', 'r') as f:
+        manifest = json.load(f)
+    n = manifest['samples']
+    columns = {}
+    for c in manifest['columns']:
+        if c['name'].endswith('.present'):
+            bits = np.memmap(filename, dtype=np.uint8, mode='r',
+                             offset=c['offset'], shape=((n + 7)//8,))
+            columns[c['name']] = np.unpackbits(
+                    bits, bitorder=manifest['bit_order'])[:n].astype(bool)
+        else:
+            columns[c['name']] = np.memmap(filename, dtype=c['dtype'], mode='r',
+                                           offset=c['offset'], shape=(n,))
+    return columns
+
+
 def convert_record_subfield(subfield, flatbuf, convert_func=None, default=0):
     if convert_func is None:
         # flatbuf value is a scalar value
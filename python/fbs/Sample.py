@@ -121,7 +121,14 @@ class Sample(object):
             return obj
         return None
 
-def SampleStart(builder): builder.StartObject(10)
+    # Sample
+    def Delta(self):
+        o = flatbuffers.number_types.UOffsetTFlags.py_type(self._tab.Offset(24))
+        if o != 0:
+            return self._tab.Get(flatbuffers.number_types.BoolFlags, o + self._tab.Pos)
+        return 0
+
+def SampleStart(builder): builder.StartObject(11)
 def SampleAddTimestamp(builder, timestamp): builder.PrependUint32Slot(0, timestamp, 0)
 def SampleAddComputationTime(builder, computationTime): builder.PrependFloat64Slot(1, computationTime, 0)
 def SampleAddBicycle(builder, bicycle): builder.PrependUOffsetTRelativeSlot(2, flatbuffers.number_types.UOffsetTFlags.py_type(bicycle), 0)
@@ -132,4 +139,5 @@ def SampleAddInput(builder, input): builder.PrependStructSlot(6, flatbuffers.num
 def SampleAddOutput(builder, output): builder.PrependStructSlot(7, flatbuffers.number_types.UOffsetTFlags.py_type(output), 0)
 def SampleAddMeasurement(builder, measurement): builder.PrependStructSlot(8, flatbuffers.number_types.UOffsetTFlags.py_type(measurement), 0)
 def SampleAddAuxiliaryState(builder, auxiliaryState): builder.PrependStructSlot(9, flatbuffers.number_types.UOffsetTFlags.py_type(auxiliaryState), 0)
+def SampleAddDelta(builder, delta): builder.PrependBoolSlot(10, delta, 0)
 def SampleEnd(builder): return builder.EndObject()
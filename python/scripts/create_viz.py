@@ -14,7 +14,7 @@ def main():
     working_dir = os.path.dirname(os.path.realpath(__file__))
 
     params = benchmark_to_moore(benchmark_parameters())
-    samples = convert.load_sample_log(
+    samples = convert.load_sample_stream(
             '/Users/oliverlee/repos/bicycle/build/samples_full.bin')
     bicycle = BicycleScene(params, samples)
 
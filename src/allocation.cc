@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "allocation.h"
+
+namespace {
+    std::atomic<uint64_t> process_count(0);
+    std::atomic<uint64_t> violation_count(0);
+    thread_local uint64_t thread_allocation_count = 0;
+    thread_local const char* section_name = nullptr; // innermost realtime section
+    thread_local bool abort_on_allocation = false;
+} // namespace
+
+#if defined(BICYCLE_TRACK_ALLOCATIONS)
+/*
+ * The default array and nothrow versions of operator new call this function
+ * and are counted as well. Output is written with stdio to avoid allocating.
+ */
+void* operator new(std::size_t size) {
+    process_count.fetch_add(1, std::memory_order_relaxed);
+    ++thread_allocation_count;
+    if (abort_on_allocation) {
+        std::fprintf(stderr, "Heap allocation of %zu bytes in realtime section '%s'.\n",
+                size, section_name);
+        std::abort();
+    }
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+namespace allocation {
+
+bool tracking_enabled() {
+#if defined(BICYCLE_TRACK_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t count() {
+    return process_count.load(std::memory_order_relaxed);
+}
+
+uint64_t thread_count() {
+    return thread_allocation_count;
+}
+
+uint64_t realtime_violations() {
+    return violation_count.load(std::memory_order_relaxed);
+}
+
+RealtimeSection::RealtimeSection(const char* name, policy_t policy) :
+    m_name(name),
+    m_policy(policy),
+    m_start_count(thread_allocation_count),
+    m_previous_name(section_name),
+    m_previous_abort(abort_on_allocation) {
+    section_name = m_name;
+    abort_on_allocation = m_previous_abort || (m_policy == policy_t::abort);
+}
+
+RealtimeSection::~RealtimeSection() {
+    section_name = m_previous_name;
+    abort_on_allocation = m_previous_abort;
+
+    const uint64_t n = allocations();
+    if (n > 0) {
+        violation_count.fetch_add(1, std::memory_order_relaxed);
+        if (m_policy == policy_t::log) {
+            std::fprintf(stderr, "%llu heap allocation(s) in realtime section '%s'.\n",
+                    static_cast<unsigned long long>(n), m_name);
+        }
+    }
+}
+
+uint64_t RealtimeSection::allocations() const {
+    return thread_allocation_count - m_start_count;
+}
+
+} // namespace allocation
@@ -1,5 +1,6 @@
 #include <cmath>
 #include "bicycle/arend.h"
+#include "bicycle/bicycle.hh"
 #include "constants.h"
 
 namespace {
@@ -34,7 +35,7 @@ BicycleArend::state_t BicycleArend::update_state(const BicycleArend::state_t& x,
     return get_state_part(xout);
 }
 
-BicycleArend::full_state_t BicycleArend::integrate_full_state(const BicycleArend::full_state_t& xf, const BicycleArend::input_t& u, real_t t, const BicycleArend::measurement_t& z) const {
+auto BicycleArend::full_state_system(const BicycleArend::measurement_t& z) const {
     /*
      * Simplified equations of motion are used to simulate the bicycle dynamics.
      * Roll/steer acceleration terms and input torque are ignored resulting in:
@@ -64,7 +65,6 @@ BicycleArend::full_state_t BicycleArend::integrate_full_state(const BicycleArend
      *
      * For more information, refer to: https://github.com/oliverlee/phobos/issues/161
      */
-    (void)u;
     static constexpr auto x_index = index(full_state_index_t::x);
     static constexpr auto y_index = index(full_state_index_t::y);
     static constexpr auto rear_wheel_index = index(full_state_index_t::rear_wheel_angle);
@@ -91,10 +91,8 @@ BicycleArend::full_state_t BicycleArend::integrate_full_state(const BicycleArend
     const real_t steer_angle_measurement = z[index(output_index_t::steer_angle)];
     const real_t steer_rate_measurement = z[index(output_index_t::steer_rate)];
 
-    full_state_t xout = xf;
-
-    m_stepper.do_step([&A, M_00, C_01, K_01, C_00, K_00, v, rr,
-                       steer_angle_measurement, steer_rate_measurement](
+    return [&A, M_00, C_01, K_01, C_00, K_00, v, rr,
+            steer_angle_measurement, steer_rate_measurement](
                 const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
             (void)t; // system is time-independent;
 
@@ -114,11 +112,37 @@ BicycleArend::full_state_t BicycleArend::integrate_full_state(const BicycleArend
                                       C_00*x[roll_rate_index] +
                                       K_00*x[roll_index])/M_00;
             dxdt[steer_rate_index] = 0; // disable steer rate integration
-            }, xout, static_cast<real_t>(0), t); // newly obtained state written in place
+            };
+}
+
+BicycleArend::full_state_t BicycleArend::integrate_full_state(const BicycleArend::full_state_t& xf, const BicycleArend::input_t& u, real_t t, const BicycleArend::measurement_t& z) const {
+    (void)u;
+    full_state_t xout = xf;
+    m_stepper.reset(); // discard the derivative cached from an unrelated previous call
+    m_stepper.do_step(full_state_system(z), xout, static_cast<real_t>(0), t); // newly obtained state written in place
+
+    // set steer angle and rate to measured values
+    xout[index(full_state_index_t::steer_angle)] = z[index(output_index_t::steer_angle)];
+    xout[index(full_state_index_t::steer_rate)] = z[index(output_index_t::steer_rate)];
+    return xout;
+}
+
+BicycleArend::full_state_t BicycleArend::integrate_full_state_trajectory(const BicycleArend::full_state_t& xf,
+        const BicycleArend::input_t& u, real_t t, real_t t_sample,
+        BicycleArend::full_state_trajectory_t* trajectory, const BicycleArend::measurement_t& z) const {
+    (void)u;
+    const size_t first_sample = (trajectory != nullptr) ? trajectory->size() : 0;
+    full_state_t xout = integrate_full_state_dense_output(full_state_system(z), xf, t, t_sample, trajectory);
 
     // set steer angle and rate to measured values
-    xout[index(full_state_index_t::steer_angle)] = steer_angle_measurement;
-    xout[index(full_state_index_t::steer_rate)] = steer_rate_measurement;
+    xout[index(full_state_index_t::steer_angle)] = z[index(output_index_t::steer_angle)];
+    xout[index(full_state_index_t::steer_rate)] = z[index(output_index_t::steer_rate)];
+    if (trajectory != nullptr) {
+        for (auto it = trajectory->begin() + first_sample + 1; it != trajectory->end(); ++it) {
+            (*it)[index(full_state_index_t::steer_angle)] = xout[index(full_state_index_t::steer_angle)];
+            (*it)[index(full_state_index_t::steer_rate)] = xout[index(full_state_index_t::steer_rate)];
+        }
+    }
     return xout;
 }
 
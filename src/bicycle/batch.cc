@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <stdexcept>
+#include "bicycle/batch.h"
+
+/*
+ * Compile the batch update for multiple instruction sets and select the
+ * widest supported version at runtime. Eigen types are not used by the update
+ * so that the alignment of Eigen objects is not affected.
+ */
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define BICYCLE_BATCH_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#if !defined(BICYCLE_BATCH_TARGET_CLONES)
+#define BICYCLE_BATCH_TARGET_CLONES
+#endif
+
+namespace {
+    template <typename E>
+    constexpr uint8_t index(E e) {
+        return static_cast<uint8_t>(e);
+    }
+
+    /*
+     * Update a block of B lanes starting at the given array pointers. The state
+     * of the block is copied to local arrays and updated for all iterations
+     * before being written back. Each inner loop operates on contiguous arrays
+     * of compile-time length with one bicycle per element and is vectorized by
+     * the compiler. Lanes beyond the batch size are padding and are updated
+     * with an identity state matrix and a zero input matrix, so their state
+     * does not change.
+     */
+    template <size_t N, size_t M, size_t B>
+    BICYCLE_BATCH_TARGET_CLONES
+    void update_state_block(const model::real_t* __restrict__ Ad, const model::real_t* __restrict__ Bd,
+            const model::real_t* __restrict__ u, model::real_t* __restrict__ x_inout,
+            size_t stride, size_t iterations) {
+        using model::real_t;
+        alignas(64) real_t x[N][B];
+        alignas(64) real_t x_next[N][B];
+        alignas(64) real_t Bu[N][B];
+
+        for (size_t i = 0; i < N; ++i) {
+            std::copy_n(x_inout + i*stride, B, x[i]);
+        }
+
+        // input is held constant over all iterations
+        for (size_t i = 0; i < N; ++i) {
+            std::fill_n(Bu[i], B, static_cast<real_t>(0));
+            for (size_t j = 0; j < M; ++j) {
+                const real_t* b = Bd + (i*M + j)*stride;
+                const real_t* uj = u + j*stride;
+                for (size_t k = 0; k < B; ++k) {
+                    Bu[i][k] += b[k]*uj[k];
+                }
+            }
+        }
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration) {
+            for (size_t i = 0; i < N; ++i) {
+                std::copy_n(Bu[i], B, x_next[i]);
+                for (size_t j = 0; j < N; ++j) {
+                    const real_t* a = Ad + (i*N + j)*stride;
+                    for (size_t k = 0; k < B; ++k) {
+                        x_next[i][k] += a[k]*x[j][k];
+                    }
+                }
+            }
+            std::copy_n(&x_next[0][0], N*B, &x[0][0]);
+        }
+
+        for (size_t i = 0; i < N; ++i) {
+            std::copy_n(x[i], B, x_inout + i*stride);
+        }
+    }
+} // namespace
+
+namespace model {
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+constexpr size_t BicycleBatch::block_size;
+
+BicycleBatch::BicycleBatch(size_t size) :
+    m_size(size),
+    m_stride(((size + block_size - 1)/block_size)*block_size),
+    m_Ad(n*n*m_stride, static_cast<real_t>(0)),
+    m_Bd(n*m*m_stride, static_cast<real_t>(0)),
+    m_x(n*m_stride, static_cast<real_t>(0)),
+    m_u(m*m_stride, static_cast<real_t>(0)) {
+    if (size == 0) {
+        throw std::invalid_argument("Invalid bicycle batch size provided.");
+    }
+    // default to an unchanging state
+    for (unsigned int i = 0; i < n; ++i) {
+        std::fill_n(m_Ad.begin() + (i*n + i)*m_stride, m_stride, static_cast<real_t>(1));
+    }
+}
+
+void BicycleBatch::set_bicycle(size_t index, const Bicycle& bicycle) {
+    check_index(index);
+    const Bicycle::state_matrix_t& Ad = bicycle.Ad();
+    const Bicycle::input_matrix_t& Bd = bicycle.Bd();
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j < n; ++j) {
+            m_Ad[(i*n + j)*m_stride + index] = Ad(i, j);
+        }
+        for (unsigned int j = 0; j < m; ++j) {
+            m_Bd[(i*m + j)*m_stride + index] = Bd(i, j);
+        }
+    }
+}
+
+void BicycleBatch::set_state(size_t index, const state_t& x) {
+    check_index(index);
+    for (unsigned int i = 0; i < n; ++i) {
+        m_x[i*m_stride + index] = x[i];
+    }
+}
+
+void BicycleBatch::set_input(size_t index, const input_t& u) {
+    check_index(index);
+    for (unsigned int i = 0; i < m; ++i) {
+        m_u[i*m_stride + index] = u[i];
+    }
+}
+
+void BicycleBatch::set_state_element(Bicycle::state_index_t field, real_t value) {
+    std::fill_n(m_x.begin() + index(field)*m_stride, m_size, value);
+}
+
+void BicycleBatch::set_input_element(Bicycle::input_index_t field, real_t value) {
+    std::fill_n(m_u.begin() + index(field)*m_stride, m_size, value);
+}
+
+void BicycleBatch::update_state() {
+    update_state(1);
+}
+
+void BicycleBatch::update_state(size_t iterations) {
+    for (size_t begin = 0; begin < m_size; begin += block_size) {
+        update_state_block<n, m, block_size>(m_Ad.data() + begin, m_Bd.data() + begin,
+                m_u.data() + begin, m_x.data() + begin, m_stride, iterations);
+    }
+}
+
+BicycleBatch::state_t BicycleBatch::state(size_t index) const {
+    check_index(index);
+    state_t x;
+    for (unsigned int i = 0; i < n; ++i) {
+        x[i] = m_x[i*m_stride + index];
+    }
+    return x;
+}
+
+BicycleBatch::input_t BicycleBatch::input(size_t index) const {
+    check_index(index);
+    input_t u;
+    for (unsigned int i = 0; i < m; ++i) {
+        u[i] = m_u[i*m_stride + index];
+    }
+    return u;
+}
+
+const real_t* BicycleBatch::state_data(Bicycle::state_index_t field) const {
+    return m_x.data() + index(field)*m_stride;
+}
+
+real_t* BicycleBatch::input_data(Bicycle::input_index_t field) {
+    return m_u.data() + index(field)*m_stride;
+}
+
+void BicycleBatch::check_index(size_t index) const {
+    if (index >= m_size) {
+        throw std::out_of_range("Invalid bicycle batch index provided.");
+    }
+}
+#endif
+
+} // namespace model
@@ -6,6 +6,7 @@
 #include <unsupported/Eigen/MatrixFunctions>
 #endif
 #include "bicycle/bicycle.h"
+#include "bicycle/bicycle.hh"
 #include "parameters.h"
 
 namespace {
@@ -124,6 +125,37 @@ Bicycle::output_t Bicycle::calculate_output(const Bicycle::state_t& x, const Bic
     return m_C*x + m_D*u;
 }
 
+Bicycle::full_state_t Bicycle::integrate_full_state_trajectory(const Bicycle::full_state_t& xf,
+        const Bicycle::input_t& u, real_t t, real_t t_sample,
+        Bicycle::full_state_trajectory_t* trajectory, const Bicycle::measurement_t& z) const {
+    static constexpr auto x_index = index(full_state_index_t::x);
+    static constexpr auto y_index = index(full_state_index_t::y);
+    static constexpr auto rear_wheel_index = index(full_state_index_t::rear_wheel_angle);
+    static constexpr auto pitch_index = index(full_state_index_t::pitch_angle);
+    static constexpr auto yaw_index = index(full_state_index_t::yaw_angle);
+    (void)z;
+
+    const state_matrix_t& A = m_A;
+    const real_t v = m_v;
+    const real_t rr = m_rr;
+    const Eigen::Matrix<real_t, o, 1> M_inv_u = m_M_llt.solve(u);
+
+    return integrate_full_state_dense_output(
+            [&A, M_inv_u, v, rr](const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
+                (void)t; // system is time-independent
+
+                // auxiliary state fields first
+                dxdt[x_index] = v*std::cos(x[yaw_index]);
+                dxdt[y_index] = v*std::sin(x[yaw_index]);
+                dxdt[rear_wheel_index] = -v/rr;
+                dxdt[pitch_index] = 0; // pitch angle is not integrated and must be obtained using solve_pitch_constraint()
+
+                // state fields
+                dxdt.tail<n>() = A*x.tail<n>();
+                dxdt.tail<o>() += M_inv_u;
+            }, xf, t, t_sample, trajectory);
+}
+
 void Bicycle::set_v_dt(real_t v, real_t dt) {
     m_v = v;
     m_dt = dt;
@@ -134,6 +166,7 @@ void Bicycle::set_v_dt(real_t v, real_t dt) {
 void Bicycle::set_M(second_order_matrix_t& M, bool recalculate_state_space) {
     m_M = M;
     m_M_llt.compute(M);
+    set_state_space_coefficients();
     if (recalculate_state_space) {
         set_state_space();
     } else {
@@ -143,6 +176,7 @@ void Bicycle::set_M(second_order_matrix_t& M, bool recalculate_state_space) {
 
 void Bicycle::set_C1(second_order_matrix_t& C1, bool recalculate_state_space) {
     m_C1 = C1;
+    set_state_space_coefficients();
     if (recalculate_state_space) {
         set_state_space();
     } else {
@@ -152,6 +186,7 @@ void Bicycle::set_C1(second_order_matrix_t& C1, bool recalculate_state_space) {
 
 void Bicycle::set_K0(second_order_matrix_t& K0, bool recalculate_state_space) {
     m_K0 = K0;
+    set_state_space_coefficients();
     if (recalculate_state_space) {
         set_state_space();
     } else {
@@ -161,6 +196,7 @@ void Bicycle::set_K0(second_order_matrix_t& K0, bool recalculate_state_space) {
 
 void Bicycle::set_K2(second_order_matrix_t& K2, bool recalculate_state_space) {
     m_K2 = K2;
+    set_state_space_coefficients();
     if (recalculate_state_space) {
         set_state_space();
     } else {
@@ -170,6 +206,7 @@ void Bicycle::set_K2(second_order_matrix_t& K2, bool recalculate_state_space) {
 
 void Bicycle::set_wheelbase(real_t w, bool recalculate_parameters) {
     m_w = w;
+    set_state_space_coefficients();
     if (recalculate_parameters) {
         set_moore_parameters();
         set_state_space();
@@ -181,6 +218,7 @@ void Bicycle::set_wheelbase(real_t w, bool recalculate_parameters) {
 
 void Bicycle::set_trail(real_t c, bool recalculate_parameters) {
     m_c = c;
+    set_state_space_coefficients();
     if (recalculate_parameters) {
         set_moore_parameters();
         set_state_space();
@@ -192,6 +230,7 @@ void Bicycle::set_trail(real_t c, bool recalculate_parameters) {
 
 void Bicycle::set_steer_axis_tilt(real_t lambda, bool recalculate_parameters) {
     m_lambda = lambda;
+    set_state_space_coefficients();
     if (recalculate_parameters) {
         set_moore_parameters();
         set_state_space();
@@ -221,10 +260,12 @@ void Bicycle::set_front_wheel_radius(real_t rf, bool recalculate_moore_parameter
 
 void Bicycle::set_C(const output_matrix_t& C) {
     m_C = C;
+    ++m_revision;
 }
 
 void Bicycle::set_D(const feedthrough_matrix_t& D) {
     m_D = D;
+    ++m_revision;
 }
 
 void Bicycle::set_v(real_t v) {
@@ -235,6 +276,7 @@ void Bicycle::set_v(real_t v) {
 
 void Bicycle::set_dt(real_t dt) {
     m_dt = dt;
+    ++m_revision;
 
 #if !defined(BICYCLE_NO_DISCRETIZATION)
     set_discrete_state_space();
@@ -242,6 +284,17 @@ void Bicycle::set_dt(real_t dt) {
 }
 
 void Bicycle::set_state_space() {
+    calculate_state_matrix(m_v, &m_A);
+    m_B.bottomRows<o>() = m_M.inverse();
+    m_recalculate_state_space = false;
+    ++m_revision;
+
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+    set_discrete_state_space();
+#endif
+}
+
+void Bicycle::set_state_space_coefficients() {
     static_assert(index(Bicycle::state_index_t::yaw_angle) == 0,
         "Invalid underlying value for state index element");
     static_assert(index(Bicycle::state_index_t::roll_angle) == 1,
@@ -269,31 +322,49 @@ void Bicycle::set_state_space() {
      * a = [0, v*cos(lambda)/w]
      * b = [0, c*cos(lambda)/w]
      *
+     * The state matrix is a quadratic polynomial in v, A = A0 + v*A1 + v^2*A2, with
+     *
+     * A0 = [ 0           0  b]   A1 = [ 0  a'        0]   A2 = [ 0         0  0]
+     *      [ 0           0  I]        [ 0   0        0]        [ 0         0  0]
+     *      [ 0  -M^-1*g*K0  0]        [ 0   0 -M^-1*C1]        [ 0  -M^-1*K2 0]
+     *
+     * a' = [0, cos(lambda)/w]
+     *
+     * and the coefficient matrices only need to be calculated when the
+     * bicycle parameters change.
+     *
      * As M is positive definite, we use the Cholesky decomposition in solving the linear system
      *
      * If states change, we need to reformulate the state space matrix equations.
      */
-    m_A(0, 2) = m_v * std::cos(m_lambda) / m_w; /* steer angle component of yaw rate */
-    m_A(0, 4) = m_c * std::cos(m_lambda) / m_w; /* steer rate component of yaw rate */
-    m_A.block<o, o>(1, 3).setIdentity();
-    m_A.block<o, o>(3, 1) = -m_M_llt.solve(constants::g*m_K0 + m_v*m_v*m_K2);
-    m_A.bottomRightCorner<o, o>() = -m_M_llt.solve(m_v*m_C1);
-    m_B.bottomRows<o>() = m_M.inverse();
-    m_recalculate_state_space = false;
+    m_A0.setZero();
+    m_A1.setZero();
+    m_A2.setZero();
+    m_A0(0, 4) = m_c * std::cos(m_lambda) / m_w; /* steer rate component of yaw rate */
+    m_A1(0, 2) = std::cos(m_lambda) / m_w; /* steer angle component of yaw rate */
+    m_A0.block<o, o>(1, 3).setIdentity();
+    m_A0.block<o, o>(3, 1) = -m_M_llt.solve(constants::g*m_K0);
+    m_A2.block<o, o>(3, 1) = -m_M_llt.solve(m_K2);
+    m_A1.bottomRightCorner<o, o>() = -m_M_llt.solve(m_C1);
 
 #if !defined(BICYCLE_NO_DISCRETIZATION)
-    set_discrete_state_space();
+    // the tabulated matrices are no longer valid if the continuous time state space changes
+    m_discretization_table.clear();
 #endif
 }
 
 #if !defined(BICYCLE_NO_DISCRETIZATION)
 void Bicycle::set_discrete_state_space() {
-    m_Ad.setZero();
-    m_Bd.setZero();
+    if (!m_discretization_table.lookup(m_v, m_dt, &m_Ad, &m_Bd)) {
+        calculate_discrete_state_space(m_A, m_B, m_dt, &m_Ad, &m_Bd);
+    }
+}
 
-    if (m_dt == static_cast<real_t>(0)) { // discrete time state does not change
-        m_Ad.setIdentity();
-        m_Bd.setZero();
+void Bicycle::calculate_discrete_state_space(const state_matrix_t& A, const input_matrix_t& B,
+        real_t dt, state_matrix_t* Ad, input_matrix_t* Bd) {
+    if (dt == static_cast<real_t>(0)) { // discrete time state does not change
+        Ad->setIdentity();
+        Bd->setZero();
     } else {
         /*
          * The full state matrix A is singular as yaw rate, and all other
@@ -306,16 +377,37 @@ void Bicycle::set_discrete_state_space() {
          */
         using discretization_matrix_t = Eigen::Matrix<real_t, n + m, n + m>;
         discretization_matrix_t AT = discretization_matrix_t::Zero();
-        AT.topLeftCorner<n, n>() = m_A;
-        AT.topRightCorner<n, m>() = m_B;
-        AT *= m_dt;
+        AT.topLeftCorner<n, n>() = A;
+        AT.topRightCorner<n, m>() = B;
+        AT *= dt;
 
         discretization_matrix_t T = AT.exp();
         assert((T.bottomLeftCorner<m, n>().isZero(discretization_precision)) &&
                (T.bottomRightCorner<m, m>().isIdentity(discretization_precision)));
-        m_Ad = T.topLeftCorner<n, n>();
-        m_Bd = T.topRightCorner<n, m>();
+        *Ad = T.topLeftCorner<n, n>();
+        *Bd = T.topRightCorner<n, m>();
+    }
+}
+
+void Bicycle::set_discretization_table(real_t v_min, real_t v_max, real_t dv, real_t tolerance) {
+    if (m_recalculate_state_space) {
+        set_state_space();
     }
+
+    m_discretization_table.generate(v_min, v_max, dv, m_dt, tolerance,
+            [this](real_t v, state_matrix_t* Ad, input_matrix_t* Bd) {
+                state_matrix_t A;
+                calculate_state_matrix(v, &A);
+                calculate_discrete_state_space(A, m_B, m_dt, Ad, Bd);
+            });
+}
+
+void Bicycle::clear_discretization_table() {
+    m_discretization_table.clear();
+}
+
+const Bicycle::discretization_table_t& Bicycle::discretization_table() const {
+    return m_discretization_table;
 }
 #endif
 
@@ -325,6 +417,11 @@ void Bicycle::set_moore_parameters() {
     m_d3 = -std::cos(m_lambda)*(m_c - m_rf*std::tan(m_lambda));
     m_d2 = (m_rr + m_d1*std::sin(m_lambda) - m_rf + m_d3*std::sin(m_lambda)) / std::cos(m_lambda);
     m_recalculate_moore_parameters = false;
+
+    // the tabulated pitch angles are no longer valid if the Moore parameters change
+    if (!m_pitch_table.empty()) {
+        generate_pitch_table(m_pitch_table.roll_max(), m_pitch_table.steer_max(), m_pitch_table.spacing());
+    }
 }
 
 /*
@@ -333,141 +430,28 @@ void Bicycle::set_moore_parameters() {
  * }
  */
 
-#if !defined(BICYCLE_NO_DISCRETIZATION)
-const Bicycle::state_matrix_t& Bicycle::Ad() const {
-    return m_Ad;
-}
-
-const Bicycle::input_matrix_t& Bicycle::Bd() const {
-    return m_Bd;
-}
-
-const Bicycle::output_matrix_t& Bicycle::Cd() const {
-    return C();
-}
-
-const Bicycle::feedthrough_matrix_t& Bicycle::Dd() const {
-    return D();
-}
-#endif
-
-const Bicycle::state_matrix_t& Bicycle::A() const {
-    return m_A;
-}
-
-const Bicycle::input_matrix_t& Bicycle::B() const {
-    return m_B;
-}
-
-const Bicycle::output_matrix_t& Bicycle::C() const {
-    return m_C;
-}
-
-const Bicycle::feedthrough_matrix_t& Bicycle::D() const {
-    return m_D;
-}
-
-const Bicycle::second_order_matrix_t& Bicycle::M() const {
-    return m_M;
-}
-
-const Bicycle::second_order_matrix_t& Bicycle::C1() const {
-    return m_C1;
-}
-
-const Bicycle::second_order_matrix_t& Bicycle::K0() const {
-    return m_K0;
-}
-
-const Bicycle::second_order_matrix_t& Bicycle::K2() const {
-    return m_K2;
-}
-
-real_t Bicycle::wheelbase() const {
-    return m_w;
-}
-
-real_t Bicycle::trail() const {
-    return m_c;
-}
-
-real_t Bicycle::steer_axis_tilt() const {
-    return m_lambda;
-}
-
-real_t Bicycle::rear_wheel_radius() const {
-    return m_rr;
-}
-
-real_t Bicycle::front_wheel_radius() const {
-    return m_rf;
-}
-
-real_t Bicycle::v() const {
-    return m_v;
-}
-
-real_t Bicycle::dt() const {
-    return m_dt;
+void Bicycle::set_pitch_table(real_t roll_max, real_t steer_max, real_t spacing) {
+    if (m_recalculate_moore_parameters) {
+        set_moore_parameters();
+    }
+    generate_pitch_table(roll_max, steer_max, spacing);
 }
 
-bool Bicycle::need_recalculate_state_space() const {
-    return m_recalculate_state_space;
+void Bicycle::clear_pitch_table() {
+    m_pitch_table.clear();
 }
 
-bool Bicycle::need_recalculate_moore_parameters() const {
-    return m_recalculate_moore_parameters;
+const Bicycle::pitch_table_t& Bicycle::pitch_table() const {
+    return m_pitch_table;
 }
 
-/*
- * Ensure the normalization functions are updated if state indices change.
- *
- * We use 2*pi as the second argument simply to keep these angles from
- * growing toward infinity.
- * NOTE: This does not prevent the roll rate and steer rate from
- * growing to infinity.
- */
-Bicycle::state_t Bicycle::normalize_state(const state_t& x) const {
-    static_assert(index(Bicycle::state_index_t::yaw_angle) == 0,
-        "Invalid underlying value for state index element");
-    static_assert(index(Bicycle::state_index_t::roll_angle) == 1,
-        "Invalid underlying value for state index element");
-    static_assert(index(Bicycle::state_index_t::steer_angle) == 2,
-        "Invalid underlying value for state index element");
-    static_assert(index(Bicycle::state_index_t::roll_rate) == 3,
-        "Invalid underlying value for state index element");
-    static_assert(index(Bicycle::state_index_t::steer_rate) == 4,
-        "Invalid underlying value for state index element");
-    static_assert(index(Bicycle::state_index_t::number_of_types) == 5,
-        "Invalid underlying value for state index element");
-
-    state_t normalized_x = x;
-    mod_two_pi_element(normalized_x, state_index_t::yaw_angle);
-    mod_two_pi_element(normalized_x, state_index_t::roll_angle);
-    mod_two_pi_element(normalized_x, state_index_t::steer_angle);
-    return normalized_x;
-}
-
-Bicycle::output_t Bicycle::normalize_output(const output_t& y) const {
-    static_assert(index(Bicycle::output_index_t::yaw_angle) == 0,
-        "Invalid underlying value for output index element");
-    static_assert(index(Bicycle::output_index_t::steer_angle) == 1,
-        "Invalid underlying value for output index element");
-    static_assert(index(Bicycle::output_index_t::number_of_types) == 2,
-        "Invalid underlying value for output index element");
-
-    output_t normalized_y = y;
-
-    auto yaw = std::fmod(get_element(y, output_index_t::yaw_angle), constants::two_pi);
-    if (yaw >= constants::pi) {
-        yaw -= constants::two_pi;
-    } else if (yaw < -constants::pi) {
-        yaw += constants::two_pi;
-    }
-
-    set_element(normalized_y, output_index_t::yaw_angle, yaw);
-    mod_two_pi_element(normalized_y, output_index_t::steer_angle);
-    return normalized_y;
+void Bicycle::generate_pitch_table(real_t roll_max, real_t steer_max, real_t spacing) {
+    static constexpr size_t max_iterations = 20;
+    m_pitch_table.generate(roll_max, steer_max, spacing,
+            [this](real_t roll, real_t steer) {
+                // grid points are solved to full precision instead of using a warm start
+                return newton_solve_constraint_pitch(roll, steer, 0, max_iterations);
+            });
 }
 
 Bicycle::auxiliary_state_t Bicycle::normalize_auxiliary_state(const auxiliary_state_t& x_aux) const {
@@ -525,12 +509,16 @@ Bicycle::Bicycle(const second_order_matrix_t& M, const second_order_matrix_t& C1
     m_rr(rear_wheel_radius), m_rf(front_wheel_radius),
     m_recalculate_state_space(true),
     m_recalculate_moore_parameters(true),
+    m_revision(0),
+    m_integration_absolute_tolerance(default_integration_tolerance),
+    m_integration_relative_tolerance(default_integration_tolerance),
     m_M_llt(M),
     m_A(state_matrix_t::Zero()),
     m_B(input_matrix_t::Zero()),
     m_C(parameters::defaultvalue::bicycle::C),
     m_D(parameters::defaultvalue::bicycle::D) {
     set_moore_parameters();
+    set_state_space_coefficients();
 
     // This isn't called as it calls set_state_space(), a pure virtual function,
     // and the derived object is not yet constructed. We simply do the same thing
@@ -543,6 +531,9 @@ Bicycle::Bicycle(const char* param_file, real_t v, real_t dt) :
     m_v(v), m_dt(dt),
     m_recalculate_state_space(true),
     m_recalculate_moore_parameters(true),
+    m_revision(0),
+    m_integration_absolute_tolerance(default_integration_tolerance),
+    m_integration_relative_tolerance(default_integration_tolerance),
     m_A(state_matrix_t::Zero()),
     m_B(input_matrix_t::Zero()),
     m_C(parameters::defaultvalue::bicycle::C),
@@ -550,6 +541,7 @@ Bicycle::Bicycle(const char* param_file, real_t v, real_t dt) :
     // set M, C1, K0, K2 matrices and w, c, lambda, rr, rf parameters from file
     set_parameters_from_file(param_file);
     set_moore_parameters();
+    set_state_space_coefficients();
 
     // This isn't called as it calls set_state_space(), a pure virtual function,
     // and the derived object is not yet constructed. We simply do the same thing
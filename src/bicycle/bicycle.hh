@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <stdexcept>
+#include <boost/numeric/odeint/stepper/runge_kutta_dopri5.hpp>
+#include <boost/numeric/odeint/stepper/controlled_runge_kutta.hpp>
+#include <boost/numeric/odeint/stepper/dense_output_runge_kutta.hpp>
+#include <boost/numeric/odeint/algebra/vector_space_algebra.hpp>
+#include <boost/numeric/odeint/external/eigen/eigen_algebra.hpp>
+/*
+ * Member function template definitions of Bicycle class used by derived
+ * classes. See bicycle.h for class declaration.
+ */
+
+namespace model {
+
+template <typename System>
+Bicycle::full_state_t Bicycle::integrate_full_state_dense_output(System system, const full_state_t& x, real_t t,
+        real_t t_sample, full_state_trajectory_t* trajectory) const {
+    namespace odeint = boost::numeric::odeint;
+    if (!(t >= 0) || !(t_sample > 0)) {
+        throw std::invalid_argument("Invalid integration time or sample time provided.");
+    }
+
+    if (trajectory != nullptr) {
+        trajectory->push_back(x);
+    }
+    if (t == 0) {
+        return x;
+    }
+
+    using error_stepper_t = odeint::runge_kutta_dopri5<full_state_t, real_t, full_state_t, real_t,
+          odeint::vector_space_algebra>;
+    using controlled_stepper_t = odeint::controlled_runge_kutta<error_stepper_t>;
+    using error_checker_t = typename controlled_stepper_t::error_checker_type;
+    /*
+     * The dense output stepper can only be constructed from a copy of a
+     * controlled stepper. The copy includes the stepper's unset Eigen work
+     * vectors, which are always written before they are read, and GCC warns
+     * about them.
+     */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    odeint::dense_output_runge_kutta<controlled_stepper_t> stepper(controlled_stepper_t(
+                error_checker_t(m_integration_absolute_tolerance, m_integration_relative_tolerance)));
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+    stepper.initialize(x, static_cast<real_t>(0), std::min(t_sample, t));
+
+    full_state_t xs;
+    size_t k = 1;
+    real_t ts = t_sample;
+    while (stepper.current_time() < t) {
+        stepper.do_step(system);
+        // sample times are calculated directly to avoid accumulating error
+        while ((ts <= t) && (ts <= stepper.current_time())) {
+            stepper.calc_state(ts, xs);
+            if (trajectory != nullptr) {
+                trajectory->push_back(xs);
+            }
+            ts = static_cast<real_t>(++k)*t_sample;
+        }
+    }
+
+    // the last step may overshoot t and the final state is interpolated
+    stepper.calc_state(t, xs);
+    return xs;
+}
+
+} // namespace model
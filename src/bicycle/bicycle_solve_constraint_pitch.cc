@@ -18,6 +18,14 @@ namespace {
 namespace model {
 
 real_t Bicycle::solve_constraint_pitch(real_t roll, real_t steer, real_t guess, size_t max_iterations) const {
+    real_t pitch;
+    if (!m_recalculate_moore_parameters && m_pitch_table.lookup(roll, steer, &pitch)) {
+        return pitch;
+    }
+    return newton_solve_constraint_pitch(roll, steer, guess, max_iterations);
+}
+
+real_t Bicycle::newton_solve_constraint_pitch(real_t roll, real_t steer, real_t guess, size_t max_iterations) const {
     // constraint function generated by script 'generate_pitch.py'.
     static constexpr int digits = std::numeric_limits<real_t>::digits*2/3;
     static constexpr real_t two = static_cast<real_t>(2.0);
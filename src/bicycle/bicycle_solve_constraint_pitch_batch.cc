@@ -0,0 +1,34 @@
+#include <algorithm>
+#include "bicycle/bicycle.h"
+#include "bicycle/solve_constraint_pitch_batch_kernel.h"
+#include "constants.h"
+
+namespace model {
+
+void Bicycle::solve_constraint_pitch_batch(const real_t* roll, const real_t* steer, real_t* pitch,
+        size_t count, size_t iterations) const {
+    static constexpr size_t block_size = pitch_batch::block_size;
+    // the solution is limited to [0, pi/2] as in the scalar solver
+    const pitch_batch::parameters_t p{m_rr, m_rf, m_d1, m_d2, m_d3,
+        static_cast<real_t>(0.0), constants::pi/2};
+
+    size_t begin = 0;
+    for (; begin + block_size <= count; begin += block_size) {
+        pitch_batch::solve_block(p, roll + begin, steer + begin, pitch + begin, iterations);
+    }
+
+    // copy the remaining elements to a zero padded block
+    if (begin < count) {
+        const size_t remainder = count - begin;
+        alignas(64) real_t roll_block[block_size] = {};
+        alignas(64) real_t steer_block[block_size] = {};
+        alignas(64) real_t pitch_block[block_size] = {};
+        std::copy_n(roll + begin, remainder, roll_block);
+        std::copy_n(steer + begin, remainder, steer_block);
+        std::copy_n(pitch + begin, remainder, pitch_block);
+        pitch_batch::solve_block(p, roll_block, steer_block, pitch_block, iterations);
+        std::copy_n(pitch_block, remainder, pitch + begin);
+    }
+}
+
+} // namespace model
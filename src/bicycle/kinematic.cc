@@ -1,5 +1,6 @@
 #include <cmath>
 #include "bicycle/kinematic.h"
+#include "bicycle/bicycle.hh"
 #include "constants.h"
 
 namespace {
@@ -51,13 +52,7 @@ BicycleKinematic::state_t BicycleKinematic::update_state(const BicycleKinematic:
     return next_x;
 }
 
-BicycleKinematic::full_state_t BicycleKinematic::integrate_full_state(const BicycleKinematic::full_state_t& xf, const BicycleKinematic::input_t& u, real_t t, const BicycleKinematic::measurement_t& z) const {
-    /*
-     * As this class is already a simplification, we integrate the auxiliary state part separately, using the state at
-     * the previous time. After, integration of the auxiliary state, the dynamic state is updated.
-     */
-    const real_t steer_angle_measurement = get_output_element(z, output_index_t::steer_angle);
-
+auto BicycleKinematic::full_state_system() const {
     static constexpr auto x_index = index(full_state_index_t::x);
     static constexpr auto y_index = index(full_state_index_t::y);
     static constexpr auto rear_wheel_index = index(full_state_index_t::rear_wheel_angle);
@@ -68,11 +63,7 @@ BicycleKinematic::full_state_t BicycleKinematic::integrate_full_state(const Bicy
     const real_t rr = m_rr;
     const state_matrix_t& A = m_A;
 
-    full_state_t xout = xf;
-    // this model ignores roll rate and steer rate
-    set_full_state_element(xout, full_state_index_t::roll_rate, static_cast<real_t>(0));
-    set_full_state_element(xout, full_state_index_t::steer_rate, static_cast<real_t>(0));
-    m_stepper.do_step([&A, &u, v, rr](const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
+    return [&A, v, rr](const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
             (void)t; // system is time-independent;
 
             dxdt[x_index] = v*std::cos(x[yaw_index]);
@@ -80,16 +71,56 @@ BicycleKinematic::full_state_t BicycleKinematic::integrate_full_state(const Bicy
             dxdt[rear_wheel_index] = -v/rr;
             dxdt[pitch_index] = 0; // pitch angle is not integrated and must be obtained using solve_pitch_constraint()
             dxdt.tail<n>() = A*x.tail<n>();
-            }, xout, static_cast<real_t>(0), t); // newly obtained state written in place
+            };
+}
 
-    const real_t next_roll = -m_K(0, 1)/m_K(0, 0) * steer_angle_measurement;
-    set_full_state_element(xout, full_state_index_t::roll_angle, next_roll);
-    set_full_state_element(xout, full_state_index_t::steer_angle, steer_angle_measurement);
+BicycleKinematic::full_state_t BicycleKinematic::integrate_full_state(const BicycleKinematic::full_state_t& xf, const BicycleKinematic::input_t& u, real_t t, const BicycleKinematic::measurement_t& z) const {
+    /*
+     * As this class is already a simplification, we integrate the auxiliary state part separately, using the state at
+     * the previous time. After, integration of the auxiliary state, the dynamic state is updated.
+     */
+    (void)u;
+    full_state_t xout = xf;
+    // this model ignores roll rate and steer rate
     set_full_state_element(xout, full_state_index_t::roll_rate, static_cast<real_t>(0));
     set_full_state_element(xout, full_state_index_t::steer_rate, static_cast<real_t>(0));
+    m_stepper.reset(); // discard the derivative cached from an unrelated previous call
+    m_stepper.do_step(full_state_system(), xout, static_cast<real_t>(0), t); // newly obtained state written in place
+
+    set_measured_state(xout, z);
     return xout;
 }
 
+BicycleKinematic::full_state_t BicycleKinematic::integrate_full_state_trajectory(const BicycleKinematic::full_state_t& xf,
+        const BicycleKinematic::input_t& u, real_t t, real_t t_sample,
+        BicycleKinematic::full_state_trajectory_t* trajectory, const BicycleKinematic::measurement_t& z) const {
+    (void)u;
+    full_state_t x0 = xf;
+    // this model ignores roll rate and steer rate
+    set_full_state_element(x0, full_state_index_t::roll_rate, static_cast<real_t>(0));
+    set_full_state_element(x0, full_state_index_t::steer_rate, static_cast<real_t>(0));
+
+    const size_t first_sample = (trajectory != nullptr) ? trajectory->size() : 0;
+    full_state_t xout = integrate_full_state_dense_output(full_state_system(), x0, t, t_sample, trajectory);
+
+    set_measured_state(xout, z);
+    if (trajectory != nullptr) {
+        for (auto it = trajectory->begin() + first_sample + 1; it != trajectory->end(); ++it) {
+            set_measured_state(*it, z);
+        }
+    }
+    return xout;
+}
+
+void BicycleKinematic::set_measured_state(full_state_t& xf, const measurement_t& z) const {
+    const real_t steer_angle_measurement = get_output_element(z, output_index_t::steer_angle);
+    const real_t next_roll = -m_K(0, 1)/m_K(0, 0) * steer_angle_measurement;
+    set_full_state_element(xf, full_state_index_t::roll_angle, next_roll);
+    set_full_state_element(xf, full_state_index_t::steer_angle, steer_angle_measurement);
+    set_full_state_element(xf, full_state_index_t::roll_rate, static_cast<real_t>(0));
+    set_full_state_element(xf, full_state_index_t::steer_rate, static_cast<real_t>(0));
+}
+
 void BicycleKinematic::set_state_space() {
     Bicycle::set_state_space();
     set_K();
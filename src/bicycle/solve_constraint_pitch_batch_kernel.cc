@@ -0,0 +1,80 @@
+/*
+ * This file is compiled with -ffast-math. This allows the compiler to use the
+ * vector math library for the trigonometric functions and to vectorize the
+ * Newton iterations across elements. Only headers without shared inline
+ * functions may be included, see solve_constraint_pitch_batch_kernel.h.
+ */
+#include <cmath>
+#include "bicycle/solve_constraint_pitch_batch_kernel.h"
+
+/*
+ * Compile the kernel for multiple instruction sets and select the widest
+ * supported version at runtime, see batch.cc.
+ */
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define BICYCLE_PITCH_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#if !defined(BICYCLE_PITCH_TARGET_CLONES)
+#define BICYCLE_PITCH_TARGET_CLONES
+#endif
+
+namespace {
+    /*
+     * GCC combines the sine and cosine of the same argument into a sincos
+     * call, which is not vectorized. The cosine is calculated as a phase
+     * shifted sine so that the loops use the vector sine.
+     */
+    inline model::real_t cos_(model::real_t x) {
+        static constexpr model::real_t half_pi = static_cast<model::real_t>(1.57079632679489661923);
+        return std::sin(x + half_pi);
+    }
+} // namespace
+
+namespace model {
+namespace pitch_batch {
+
+/*
+ * The constraint function generated by 'generate_pitch.py' simplifies to
+ *   f = rf*r + d3*a + (d2*cos(pitch) - d1*sin(pitch))*cos(roll) - rr*|cos(roll)|
+ * with
+ *   a = sin(roll)*sin(steer) - sin(pitch)*cos(roll)*cos(steer)
+ *   r = sqrt(a^2 + cos(pitch)^2*cos(roll)^2)
+ * and the solution is limited to [min, max].
+ */
+BICYCLE_PITCH_TARGET_CLONES
+void solve_block(const parameters_t& p, const real_t* __restrict__ roll,
+        const real_t* __restrict__ steer, real_t* __restrict__ pitch, size_t iterations) {
+    alignas(64) real_t cos_roll[block_size];
+    alignas(64) real_t sin_roll_sin_steer[block_size];
+    alignas(64) real_t cos_roll_cos_steer[block_size];
+
+    // roll and steer angles are constant over all iterations
+    for (size_t k = 0; k < block_size; ++k) {
+        cos_roll[k] = cos_(roll[k]);
+        sin_roll_sin_steer[k] = std::sin(roll[k])*std::sin(steer[k]);
+        cos_roll_cos_steer[k] = cos_roll[k]*cos_(steer[k]);
+    }
+
+    for (size_t iteration = 0; iteration < iterations; ++iteration) {
+        for (size_t k = 0; k < block_size; ++k) {
+            const real_t cos_pitch = cos_(pitch[k]);
+            const real_t sin_pitch = std::sin(pitch[k]);
+            const real_t cos_pitch_cos_roll = cos_pitch*cos_roll[k];
+            const real_t a = sin_roll_sin_steer[k] - sin_pitch*cos_roll_cos_steer[k];
+            const real_t da = -cos_pitch*cos_roll_cos_steer[k];
+            const real_t r = std::sqrt(a*a + cos_pitch_cos_roll*cos_pitch_cos_roll);
+            const real_t dr = (a*da - sin_pitch*cos_roll[k]*cos_pitch_cos_roll)/r;
+
+            const real_t f = p.rf*r + p.d3*a + (p.d2*cos_pitch - p.d1*sin_pitch)*cos_roll[k] -
+                p.rr*std::fabs(cos_roll[k]);
+            const real_t df = p.rf*dr + p.d3*da - (p.d2*sin_pitch + p.d1*cos_pitch)*cos_roll[k];
+            // std::min and std::max are shared inline functions and are not used
+            pitch[k] = std::fmin(std::fmax(pitch[k] - f/df, p.min), p.max);
+        }
+    }
+}
+
+} // namespace pitch_batch
+} // namespace model
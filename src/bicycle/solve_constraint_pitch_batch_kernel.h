@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include "types.h"
+
+/*
+ * Newton iteration kernel used by Bicycle::solve_constraint_pitch_batch().
+ *
+ * The kernel is defined in solve_constraint_pitch_batch_kernel.cc, which is
+ * compiled with -ffast-math. That file must not include headers with inline
+ * functions or templates shared with the rest of the program, e.g. Eigen or
+ * the model headers, as the linker may otherwise select the fast-math
+ * definitions for all translation units.
+ */
+namespace model {
+namespace pitch_batch {
+
+static constexpr size_t block_size = 64;
+
+struct parameters_t {
+    real_t rr;
+    real_t rf;
+    real_t d1;
+    real_t d2;
+    real_t d3;
+    real_t min; // solution lower limit
+    real_t max; // solution upper limit
+};
+
+/*
+ * Perform a fixed number of Newton iterations for block_size elements. The
+ * pitch array holds the initial values and receives the solutions.
+ */
+void solve_block(const parameters_t& p, const real_t* roll, const real_t* steer,
+        real_t* pitch, size_t iterations);
+
+} // namespace pitch_batch
+} // namespace model
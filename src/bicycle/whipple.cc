@@ -1,5 +1,6 @@
 #include <cmath>
 #include "bicycle/whipple.h"
+#include "bicycle/bicycle.hh"
 
 namespace {
     template <typename E>
@@ -14,44 +15,41 @@ BicycleWhipple::BicycleWhipple(const second_order_matrix_t& M, const second_orde
         real_t wheelbase, real_t trail, real_t steer_axis_tilt,
         real_t rear_wheel_radius, real_t front_wheel_radius,
         real_t v, real_t dt) :
-    Bicycle(M, C1, K0, K2, wheelbase, trail, steer_axis_tilt, rear_wheel_radius, front_wheel_radius, v, dt)
+    Bicycle(M, C1, K0, K2, wheelbase, trail, steer_axis_tilt, rear_wheel_radius, front_wheel_radius, v, dt),
+    m_integration_method(integration_method_t::runge_kutta_dopri5)
     { }
 
 BicycleWhipple::BicycleWhipple(const char* param_file, real_t v, real_t dt) :
-    Bicycle(param_file, v, dt)
+    Bicycle(param_file, v, dt),
+    m_integration_method(integration_method_t::runge_kutta_dopri5)
     { }
 
 BicycleWhipple::BicycleWhipple(real_t v, real_t dt) :
-    Bicycle(v, dt)
+    Bicycle(v, dt),
+    m_integration_method(integration_method_t::runge_kutta_dopri5)
     { }
 
-BicycleWhipple::state_t BicycleWhipple::update_state(const BicycleWhipple::state_t& x, const BicycleWhipple::input_t& u, const BicycleWhipple::measurement_t& z) const {
-    (void)z;
-#if defined(BICYCLE_NO_DISCRETIZATION)
-    // This simply calls integrate state with the integration time set to m_dt
-    // if discretization has been disabled.
-    return integrate_state(x, u, m_dt);
-#else
-    return m_Ad*x + m_Bd*u;
-#endif
-}
-
-BicycleWhipple::full_state_t BicycleWhipple::integrate_full_state(const BicycleWhipple::full_state_t& xf, const BicycleWhipple::input_t& u, real_t t, const BicycleWhipple::measurement_t& z) const {
-    (void)z;
+/*
+ * Return the full state system function for use with odeint steppers.
+ * Normally we would write dxdt = A*x + B*u but we prefer not to use the
+ * matrix inverse unless absolutely necessary when computing.
+ * As B = [   0  ], the product Bu = [      0   ]
+ *        [ M^-1 ]                   [ M^-1 * u ]
+ * and M^-1 * u is constant over the integration time.
+ */
+auto BicycleWhipple::full_state_system(const BicycleWhipple::input_t& u) const {
     static constexpr auto x_index = index(full_state_index_t::x);
     static constexpr auto y_index = index(full_state_index_t::y);
     static constexpr auto rear_wheel_index = index(full_state_index_t::rear_wheel_angle);
     static constexpr auto pitch_index = index(full_state_index_t::pitch_angle);
     static constexpr auto yaw_index = index(full_state_index_t::yaw_angle);
 
+    const state_matrix_t& A = m_A;
     const real_t v = m_v;
     const real_t rr = m_rr;
-    const state_matrix_t& A = m_A;
-    const Eigen::LLT<second_order_matrix_t>& M_llt = m_M_llt;
+    const Eigen::Matrix<real_t, o, 1> M_inv_u = m_M_llt.solve(u);
 
-    full_state_t xout = xf;
-
-    m_stepper.do_step([&A, &M_llt, &u, v, rr](const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
+    return [&A, M_inv_u, v, rr](const full_state_t& x, full_state_t& dxdt, const real_t t) -> void {
             (void)t; // system is time-independent
 
             // auxiliary state fields first
@@ -62,21 +60,65 @@ BicycleWhipple::full_state_t BicycleWhipple::integrate_full_state(const BicycleW
 
             // state fields
             dxdt.tail<n>() = A*x.tail<n>();
-            // Normally we would write dxdt = A*x + B*u but we prefer not to
-            // use the matrix inverse unless absolutely necessary when computing.
-            // As B = [   0  ], the product Bu = [      0   ]
-            //        [ M^-1 ]                   [ M^-1 * u ]
-            dxdt.tail<o>() += M_llt.solve(u);
-            }, xout, static_cast<real_t>(0), t); // newly obtained state written in place
+            dxdt.tail<o>() += M_inv_u;
+            };
+}
+
+BicycleWhipple::full_state_t BicycleWhipple::integrate_full_state(const BicycleWhipple::full_state_t& xf, const BicycleWhipple::input_t& u, real_t t, const BicycleWhipple::measurement_t& z) const {
+    (void)z;
+#if !defined(BICYCLE_NO_DISCRETIZATION)
+    if ((m_integration_method == integration_method_t::discrete) && (t == m_dt)) {
+        static constexpr auto x_index = index(full_state_index_t::x);
+        static constexpr auto y_index = index(full_state_index_t::y);
+        static constexpr auto rear_wheel_index = index(full_state_index_t::rear_wheel_angle);
+        static constexpr auto yaw_index = index(full_state_index_t::yaw_angle);
+        const real_t v = m_v;
+        const real_t rr = m_rr;
+
+        full_state_t xout = xf;
+        xout.tail<n>() = update_state(xf.tail<n>(), u);
+
+        /*
+         * With the yaw angle varying linearly from yaw0 to yaw1 over the step,
+         * the integral of v*[cos(yaw), sin(yaw)] is
+         * v*t*sinc(dyaw/2)*[cos(yaw_mid), sin(yaw_mid)].
+         */
+        const real_t yaw_mid = (xf[yaw_index] + xout[yaw_index])/2;
+        const real_t half_dyaw = (xout[yaw_index] - xf[yaw_index])/2;
+        real_t sinc = 1 - half_dyaw*half_dyaw/6;
+        if (std::abs(half_dyaw) > static_cast<real_t>(1e-4)) {
+            sinc = std::sin(half_dyaw)/half_dyaw;
+        }
+        const real_t distance = v*t*sinc;
+        xout[x_index] += distance*std::cos(yaw_mid);
+        xout[y_index] += distance*std::sin(yaw_mid);
+        xout[rear_wheel_index] += -v/rr*t;
+        // pitch angle is not integrated and must be obtained using solve_pitch_constraint()
+        return xout;
+    }
+#endif
+
+    full_state_t xout = xf;
+    m_stepper.reset(); // discard the derivative cached from an unrelated previous call
+    m_stepper.do_step(full_state_system(u),
+            xout, static_cast<real_t>(0), t); // newly obtained state written in place
     return xout;
 }
 
+BicycleWhipple::full_state_t BicycleWhipple::integrate_full_state_trajectory(const BicycleWhipple::full_state_t& xf,
+        const BicycleWhipple::input_t& u, real_t t, real_t t_sample,
+        BicycleWhipple::full_state_trajectory_t* trajectory, const BicycleWhipple::measurement_t& z) const {
+    (void)z;
+    return integrate_full_state_dense_output(full_state_system(u), xf, t, t_sample, trajectory);
+}
+
 BicycleWhipple::state_t BicycleWhipple::integrate_state(const BicycleWhipple::state_t& x, const BicycleWhipple::input_t& u, real_t t) const {
     state_t xout = x;
 
     const state_matrix_t& A = m_A;
     const Eigen::LLT<second_order_matrix_t>& M_llt = m_M_llt;
 
+    m_stepper_state.reset();
     m_stepper_state.do_step([&A, &M_llt, &u](const state_t& x, state_t& dxdt, const real_t t) -> void {
             (void)t; // system is time-independent
             dxdt = A*x;
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+/*
+ * Member function definitions of DiscretizationTable template class.
+ * See discretization_table.h for template class declaration.
+ */
+
+namespace model {
+
+template <size_t N, size_t M>
+DiscretizationTable<N, M>::DiscretizationTable() :
+    m_v_min(0), m_v_max(0), m_dv(0), m_dt(0), m_tolerance(0), m_max_error(0) { }
+
+template <size_t N, size_t M>
+template <typename F>
+void DiscretizationTable<N, M>::generate(real_t v_min, real_t v_max, real_t dv, real_t dt,
+        real_t tolerance, F discretize) {
+    if (!(v_max > v_min) || !(dv > 0) || !(tolerance >= 0)) {
+        throw std::invalid_argument("Invalid discretization table range provided.");
+    }
+
+    // adjust grid spacing so that both v_min and v_max are grid points
+    const size_t intervals = static_cast<size_t>(std::ceil((v_max - v_min)/dv));
+    clear();
+    m_v_min = v_min;
+    m_v_max = v_max;
+    m_dv = (v_max - v_min)/intervals;
+    m_dt = dt;
+    m_tolerance = tolerance;
+
+    m_Ad.resize(intervals + 1);
+    m_Bd.resize(intervals + 1);
+    for (size_t i = 0; i <= intervals; ++i) {
+        discretize(m_v_min + i*m_dv, &m_Ad[i], &m_Bd[i]);
+    }
+
+    /*
+     * The interpolation error is largest (approximately) at the midpoint of
+     * each interval as the matrices are smooth functions of v.
+     */
+    m_valid.resize(intervals);
+    state_matrix_t Ad;
+    input_matrix_t Bd;
+    for (size_t i = 0; i < intervals; ++i) {
+        discretize(m_v_min + (i + static_cast<real_t>(0.5))*m_dv, &Ad, &Bd);
+        const real_t error = std::max(
+                (Ad - (m_Ad[i] + m_Ad[i + 1])/2).cwiseAbs().maxCoeff(),
+                (Bd - (m_Bd[i] + m_Bd[i + 1])/2).cwiseAbs().maxCoeff());
+        m_valid[i] = (error <= m_tolerance);
+        if (m_valid[i]) {
+            m_max_error = std::max(m_max_error, error);
+        }
+    }
+}
+
+template <size_t N, size_t M>
+void DiscretizationTable<N, M>::clear() {
+    m_Ad.clear();
+    m_Bd.clear();
+    m_valid.clear();
+    m_max_error = 0;
+}
+
+template <size_t N, size_t M>
+bool DiscretizationTable<N, M>::lookup(real_t v, real_t dt,
+        state_matrix_t* Ad, input_matrix_t* Bd) const {
+    if (empty() || (dt != m_dt) || !(v >= m_v_min) || !(v <= m_v_max)) {
+        return false;
+    }
+
+    const real_t s = (v - m_v_min)/m_dv;
+    const size_t i = std::min(static_cast<size_t>(s), m_valid.size() - 1);
+    if (!m_valid[i]) {
+        return false;
+    }
+
+    const real_t t = s - i;
+    *Ad = m_Ad[i] + t*(m_Ad[i + 1] - m_Ad[i]);
+    *Bd = m_Bd[i] + t*(m_Bd[i + 1] - m_Bd[i]);
+    return true;
+}
+
+template <size_t N, size_t M>
+size_t DiscretizationTable<N, M>::invalid_intervals() const {
+    return std::count(m_valid.cbegin(), m_valid.cend(), false);
+}
+
+} // namespace model
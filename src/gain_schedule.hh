@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "kalman.h"
+#include "lqr.h"
+/*
+ * Member function definitions of GainSchedule template class.
+ * See gain_schedule.h for template class declaration.
+ */
+
+namespace model {
+
+template <typename T>
+constexpr uint32_t GainSchedule<T>::max_kalman_iterations;
+
+template <typename T>
+constexpr uint32_t GainSchedule<T>::max_lqr_iterations;
+
+template <typename T>
+constexpr uint32_t GainSchedule<T>::lqr_horizon_iterations;
+
+template <typename T>
+GainSchedule<T>::GainSchedule() : m_v_min(0), m_dv(0), m_dt(0) { }
+
+template <typename T>
+void GainSchedule<T>::generate(T& system, real_t v_min, real_t v_max, real_t dv,
+        const weights_t& weights) {
+    using lqr_t = controller::Lqr<T>;
+    using kalman_t = observer::Kalman<T>;
+    if (!(v_max > v_min) || !(dv > 0)) {
+        throw std::invalid_argument("Invalid gain schedule range provided.");
+    }
+
+    // adjust grid spacing so that both v_min and v_max are grid points
+    const size_t intervals = static_cast<size_t>(std::ceil((v_max - v_min)/dv));
+    const real_t spacing = (v_max - v_min)/intervals;
+    const real_t v0 = system.v();
+    entry_vector_t entries(intervals + 1);
+
+    for (size_t i = 0; i <= intervals; ++i) {
+        system.set_v(v_min + i*spacing);
+        entry_t& entry = entries[i];
+
+        /*
+         * The Riccati doubling solver falls back to value iteration if the
+         * system is not stabilizable, in which case the gain is iterated until
+         * it no longer changes.
+         */
+        lqr_t lqr(system, weights.lqr_Q, weights.lqr_R, T::state_t::Zero(),
+                lqr_horizon_iterations, weights.lqr_Qi);
+        lqr.set_solver(lqr_t::solver_t::riccati_doubling);
+        lqr.control_calculate(T::state_t::Zero());
+        for (uint32_t j = 0; j < max_lqr_iterations; ++j) {
+            const typename lqr_t::lqr_gain_t K = lqr.K();
+            const typename lqr_t::lqr_gain_t Ki = lqr.Ki();
+            lqr.control_calculate(T::state_t::Zero());
+            if (lqr.K().isApprox(K) && lqr.Ki().isApprox(Ki)) {
+                break;
+            }
+        }
+        // Lqr gains only contain rows for inputs with nonzero cost
+        entry.lqr_K.setZero();
+        entry.lqr_Ki.setZero();
+        for (unsigned int j = 0, k = 0; j < T::m; ++j) {
+            if (weights.lqr_R(j, j) != 0.0) {
+                entry.lqr_K.row(j) = lqr.K().row(k);
+                entry.lqr_Ki.row(j) = lqr.Ki().row(k++);
+            }
+        }
+
+        kalman_t kalman(system, T::state_t::Zero(), weights.kalman_Q, weights.kalman_R,
+                weights.kalman_Q);
+        for (uint32_t j = 0; j < max_kalman_iterations; ++j) {
+            const error_covariance_t P = kalman.P();
+            kalman.time_update();
+            kalman.measurement_update(kalman_t::measurement_t::Zero());
+            if (kalman.P().isApprox(P)) {
+                break;
+            }
+        }
+        entry.kalman_K = kalman.K();
+        entry.kalman_P = kalman.P();
+    }
+
+    system.set_v(v0);
+    set(v_min, spacing, system.dt(), weights, entries);
+}
+
+template <typename T>
+void GainSchedule<T>::set(real_t v_min, real_t dv, real_t dt, const weights_t& weights,
+        const entry_vector_t& entries) {
+    if (!(dv > 0) || (entries.size() < 2)) {
+        throw std::invalid_argument("Invalid gain schedule provided.");
+    }
+    m_v_min = v_min;
+    m_dv = dv;
+    m_dt = dt;
+    m_weights = weights;
+    m_entries = entries;
+}
+
+template <typename T>
+void GainSchedule<T>::clear() {
+    m_entries.clear();
+}
+
+template <typename T>
+void GainSchedule<T>::interval(real_t v, size_t* i, real_t* t) const {
+    const real_t s = std::min(std::max((v - m_v_min)/m_dv, static_cast<real_t>(0)),
+            static_cast<real_t>(size() - 1));
+    *i = std::min(static_cast<size_t>(s), size() - 2);
+    *t = s - *i;
+}
+
+template <typename T>
+void GainSchedule<T>::lqr_gain(real_t v, lqr_gain_t* K, lqr_gain_t* Ki) const {
+    size_t i;
+    real_t t;
+    interval(v, &i, &t);
+    const entry_t& e0 = m_entries[i];
+    const entry_t& e1 = m_entries[i + 1];
+    *K = e0.lqr_K + t*(e1.lqr_K - e0.lqr_K);
+    *Ki = e0.lqr_Ki + t*(e1.lqr_Ki - e0.lqr_Ki);
+}
+
+template <typename T>
+void GainSchedule<T>::kalman_gain(real_t v, kalman_gain_t* K, error_covariance_t* P) const {
+    size_t i;
+    real_t t;
+    interval(v, &i, &t);
+    const entry_t& e0 = m_entries[i];
+    const entry_t& e1 = m_entries[i + 1];
+    *K = e0.kalman_K + t*(e1.kalman_K - e0.kalman_K);
+    *P = e0.kalman_P + t*(e1.kalman_P - e0.kalman_P);
+}
+
+} // namespace model
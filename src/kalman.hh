@@ -1,3 +1,5 @@
+#include <cassert>
+#include <limits>
 #include <Eigen/Cholesky>
 /*
  * Member function definitions of Kalman template class.
@@ -21,8 +23,11 @@ Kalman<T>::Kalman(T& system, const state_t& x0,
         const process_noise_covariance_t& Q,
         const measurement_noise_covariance_t& R,
         const error_covariance_t& P0) : Observer<T>(system, x0),
-            m_P(P0), m_Q(Q), m_R(R) {
+            m_P(P0), m_Q(Q), m_R(R), m_steady_state_mode(false),
+            m_system_revision(system.revision()) {
     m_K.setZero();
+    reset_steady_state();
+    set_output_selection();
 }
 
 template <typename T>
@@ -32,6 +37,10 @@ void Kalman<T>::reset() {
     m_Q.setIdentity();
     m_R.setIdentity();
     m_K.setZero();
+    m_steady_state_mode = false;
+    reset_steady_state();
+    m_system_revision = m_system.revision();
+    set_output_selection();
 }
 
 template <typename T>
@@ -42,78 +51,182 @@ void Kalman<T>::update_state(const input_t& u, const measurement_t& z) {
 
 template <typename T>
 void Kalman<T>::time_update() {
+    check_system_change();
     time_update_state();
-    time_update_error_covariance();
+    if (!m_steady_state) {
+        time_update_error_covariance(m_Q);
+    }
 }
 
 template <typename T>
 void Kalman<T>::time_update(const process_noise_covariance_t& Q) {
+    check_system_change();
+    reset_steady_state();
     time_update_state();
     time_update_error_covariance(Q);
 }
 
 template <typename T>
 void Kalman<T>::time_update(const input_t& u) {
+    check_system_change();
     time_update_state(u);
-    time_update_error_covariance();
+    if (!m_steady_state) {
+        time_update_error_covariance(m_Q);
+    }
 }
 
 template <typename T>
 void Kalman<T>::time_update(const input_t& u, const process_noise_covariance_t& Q) {
+    check_system_change();
+    reset_steady_state();
     time_update_state(u);
     time_update_error_covariance(Q);
 }
 
 template <typename T>
 void Kalman<T>::measurement_update(const measurement_t& z) {
-    measurement_update_kalman_gain();
+    check_system_change();
+    if (m_steady_state) {
+        measurement_update_state(z);
+        return;
+    }
+    measurement_update_kalman_gain(m_R);
     measurement_update_state(z);
     measurement_update_error_covariance();
+
+    if (m_steady_state_mode) {
+        // relative change of the a posteriori error covariance
+        const real_t norm = m_P.norm();
+        m_error_covariance_change = (norm > static_cast<real_t>(0)) ?
+            (m_P - m_P_previous).norm()/norm : static_cast<real_t>(0);
+        m_P_previous = m_P;
+        ++m_steady_state_updates;
+        if (m_error_covariance_change <= Eigen::NumTraits<real_t>::dummy_precision()) {
+            m_steady_state = true;
+            m_Ad = m_system.Ad();
+            m_Cd = m_system.Cd();
+        }
+    }
 }
 
 template <typename T>
 void Kalman<T>::measurement_update(const measurement_t& z, const measurement_noise_covariance_t& R) {
+    check_system_change();
+    reset_steady_state();
     measurement_update_kalman_gain(R);
     measurement_update_state(z);
     measurement_update_error_covariance();
 }
 
 template <typename T>
-void Kalman<T>::time_update_state() {
-    m_x = m_system.normalize_state(m_system.Ad()*m_x);
+void Kalman<T>::check_system_change() {
+    if (m_system.revision() == m_system_revision) {
+        return;
+    }
+    m_system_revision = m_system.revision();
+    set_output_selection();
+    if (m_steady_state && (!m_system.Ad().isApprox(m_Ad) || !m_system.Cd().isApprox(m_Cd))) {
+        // steady state error covariance and Kalman gain are no longer valid
+        reset_steady_state();
+    }
 }
 
 template <typename T>
-void Kalman<T>::time_update_state(const input_t& u) {
-    m_x = m_system.normalize_state(m_system.Ad()*m_x + m_system.Bd()*u);
+void Kalman<T>::reset_steady_state() {
+    m_steady_state = false;
+    m_steady_state_updates = 0;
+    m_error_covariance_change = std::numeric_limits<real_t>::infinity();
+    m_P_previous.setZero();
 }
 
 template <typename T>
-void Kalman<T>::time_update_error_covariance() {
-    m_P = m_system.Ad()*m_P*m_system.Ad().transpose() + m_Q;
+void Kalman<T>::set_output_selection() {
+    // Cd is a selection matrix if each row has a single nonzero entry equal to 1
+    m_output_selection = true;
+    for (unsigned int i = 0; i < T::l; ++i) {
+        typename T::output_matrix_t::Index j;
+        m_system.Cd().row(i).cwiseAbs().maxCoeff(&j);
+        m_output_index[i] = static_cast<uint32_t>(j);
+        if ((m_system.Cd()(i, j) != static_cast<real_t>(1)) ||
+                ((m_system.Cd().row(i).array() != static_cast<real_t>(0)).count() != 1)) {
+            m_output_selection = false;
+        }
+    }
 }
 
 template <typename T>
-void Kalman<T>::time_update_error_covariance(const process_noise_covariance_t& Q) {
-    m_P = m_system.Ad()*m_P*m_system.Ad().transpose() + Q;
+void Kalman<T>::time_update_state() {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x);
 }
 
 template <typename T>
-void Kalman<T>::measurement_update_kalman_gain() {
-    // S = C*P*C' + R
-    // K = P*C'*S^-1 - > K' = S^-1*C*P'
-    Eigen::LDLT<measurement_noise_covariance_t> S_ldlt(
-            m_system.Cd()*m_P*m_system.Cd().transpose() + m_R);
-    m_K.noalias() = S_ldlt.solve(m_system.Cd()*m_P.transpose()).transpose();
+void Kalman<T>::time_update_state(const input_t& u) {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x + m_system.Bd()*u);
+}
+
+template <typename T>
+void Kalman<T>::time_update_error_covariance(const process_noise_covariance_t& Q) {
+    /*
+     * P = Ad*P*Ad' + Q
+     *
+     * The first k = T::ni states do not feed back and the state matrix has
+     * the block upper triangular form
+     *     Ad = [I  A12]
+     *          [0  A22]
+     * With P partitioned accordingly, the products with the identity and zero
+     * blocks are skipped:
+     *     U = P21 + P22*A12'
+     *     P11 = P11 + A12*U + (A12*P21)'
+     *     P21 = A22*U
+     *     P22 = A22*P22*A22'
+     * If k is zero, this is the dense update. The upper triangle of P is
+     * copied from the lower triangle so that P remains symmetric, as rounding
+     * error in the antisymmetric part otherwise grows for an unstable system.
+     */
+    constexpr unsigned int k = T::ni;
+    constexpr unsigned int r = T::n - T::ni;
+    assert(m_system.Ad().template leftCols<k>().isIdentity(0));
+    const auto A12 = m_system.Ad().template topRightCorner<k, r>();
+    const auto A22 = m_system.Ad().template bottomRightCorner<r, r>();
+    auto P11 = m_P.template topLeftCorner<k, k>();
+    auto P21 = m_P.template bottomLeftCorner<r, k>();
+    auto P22 = m_P.template bottomRightCorner<r, r>();
+
+    Eigen::Matrix<real_t, r, k> U = P21;
+    U.noalias() += P22*A12.transpose();
+    P11.noalias() += A12*U;
+    P11.noalias() += (A12*P21).transpose();
+    P21.noalias() = A22*U;
+    Eigen::Matrix<real_t, r, r> W;
+    W.noalias() = A22*P22;
+    P22.noalias() = W*A22.transpose();
+    m_P += Q;
+    m_P.template triangularView<Eigen::StrictlyUpper>() = m_P.transpose();
 }
 
 template <typename T>
 void Kalman<T>::measurement_update_kalman_gain(const measurement_noise_covariance_t& R) {
-    // S = C*P*C' + R
-    // K = P*C'*S^-1 - > K' = S^-1*C*P'
-    Eigen::LDLT<measurement_noise_covariance_t> S_ldlt(
-            m_system.Cd()*m_P*m_system.Cd().transpose() + R);
-    m_K.noalias() = S_ldlt.solve(m_system.Cd()*m_P.transpose()).transpose();
+    /*
+     * S = C*P*C' + R
+     * K = P*C'*S^-1 -> K' = S^-1*C*P as P is symmetric
+     *
+     * C*P is kept for the error covariance update. If C is a selection
+     * matrix, C*P and C*P*C' are formed by copying rows and columns of P.
+     */
+    measurement_noise_covariance_t S = R;
+    if (m_output_selection) {
+        for (unsigned int i = 0; i < T::l; ++i) {
+            m_CP.row(i) = m_P.row(m_output_index[i]);
+        }
+        for (unsigned int i = 0; i < T::l; ++i) {
+            S.col(i) += m_CP.col(m_output_index[i]);
+        }
+    } else {
+        m_CP.noalias() = m_system.Cd()*m_P;
+        S.noalias() += m_CP*m_system.Cd().transpose();
+    }
+    Eigen::LDLT<measurement_noise_covariance_t> S_ldlt(S);
+    m_K.noalias() = S_ldlt.solve(m_CP).transpose();
 }
 
 template <typename T>
@@ -124,7 +237,8 @@ void Kalman<T>::measurement_update_state(const measurement_t& z) {
 
 template <typename T>
 void Kalman<T>::measurement_update_error_covariance() {
-    m_P = (error_covariance_t::Identity() - m_K*m_system.Cd())*m_P;
+    // P = (I - K*C)*P = P - K*(C*P)
+    m_P.noalias() -= m_K*m_CP;
 }
 
 } // namespace observer
@@ -11,7 +11,9 @@ Lqr<T>::Lqr(T& system, const state_cost_t& Q, const input_cost_t& R,
         const state_cost_t& Qi, const state_t& q) :
     m_system(system), m_horizon(horizon_iterations), m_r(r), m_q(q),
     m_Q(Q), m_Qi(Qi), m_R(R), m_steady_state(false),
-    m_Bd(system.Bd()), m_Ag(augmented_state_matrix_t::Identity()),
+    m_solver(solver_t::value_iteration), m_solve_riccati(true),
+    m_Bd(system.Bd()), m_system_revision(system.revision()),
+    m_Ag(augmented_state_matrix_t::Identity()),
     m_Pg(augmented_state_cost_t::Zero()) {
     m_Ag.template topLeftCorner<T::n, T::n>() = m_system.Ad();
     m_Ag.template bottomLeftCorner<T::n, T::n>() =
@@ -54,13 +56,27 @@ typename Lqr<T>::input_t Lqr<T>::control_calculate(const state_t& x, const state
 
 template<typename T>
 void Lqr<T>::perform_value_iteration() {
-    if (!m_system.Ad().isApprox(m_Ag.template topLeftCorner<T::n, T::n>()) ||
-            !m_system.Bd().isApprox(m_Bd)) {
+    // the system matrices are only compared if the system has been modified
+    if ((m_system.revision() != m_system_revision) && (
+                !m_system.Ad().isApprox(m_Ag.template topLeftCorner<T::n, T::n>()) ||
+                !m_system.Bd().isApprox(m_Bd))) {
         // check if system has changed
+        const augmented_state_cost_t P = m_Pg;
         m_Ag.template topLeftCorner<T::n, T::n>() = m_system.Ad();
         m_Bd = m_system.Bd();
         reduce_input_matrices();
         m_steady_state = false;
+        m_solve_riccati = true;
+        if (m_solver == solver_t::riccati_doubling) {
+            m_Pg = P; // warm start from previous solution
+        }
+    }
+    m_system_revision = m_system.revision();
+
+    if (!m_steady_state && m_solve_riccati && (m_solver == solver_t::riccati_doubling)) {
+        // if the doubling algorithm does not converge, do not retry until the problem changes
+        m_solve_riccati = false;
+        m_steady_state = solve_riccati_doubling();
     }
 
     if (!m_steady_state) {
@@ -76,31 +92,171 @@ void Lqr<T>::perform_value_iteration() {
     }
 }
 
+template<typename T>
+bool Lqr<T>::solve_riccati_doubling() {
+    // keep the current cost-to-go if it is still a solution
+    if (!m_Pg.isZero() && is_riccati_fixed_point()) {
+        return true;
+    }
+
+    augmented_state_matrix_t G;
+    if (m_m == T::m) {
+        G.noalias() = m_Bg*m_R.ldlt().solve(m_Bg.transpose());
+    } else {
+        G.noalias() = m_Bg.leftCols(m_m)*m_Rr.topLeftCorner(m_m, m_m).ldlt().solve(
+                m_Bg.leftCols(m_m).transpose());
+    }
+
+    bool converged;
+    if (m_Qi.isZero()) {
+        // error integral states are decoupled and have zero cost
+        state_cost_t P;
+        converged = riccati_doubling<T::n>(m_system.Ad(),
+                G.template topLeftCorner<T::n, T::n>(), m_Q, &P);
+        m_Pg.setZero();
+        m_Pg.template topLeftCorner<T::n, T::n>() = P;
+    } else {
+        augmented_state_cost_t H = augmented_state_cost_t::Zero();
+        H.template topLeftCorner<T::n, T::n>() = m_Q;
+        H.template bottomRightCorner<T::n, T::n>() = m_Qi;
+        converged = riccati_doubling<2*T::n>(m_Ag, G, H, &m_Pg);
+    }
+
+    // reject false convergence when a stabilizing solution does not exist
+    if (!converged || !is_riccati_fixed_point()) {
+        m_Pg.setZero();
+        m_Kg.setZero();
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool Lqr<T>::is_riccati_fixed_point() {
+    const augmented_state_cost_t P = m_Pg;
+    update_lqr_gain();
+    update_horizon_cost();
+    const bool fixed_point = m_Pg.isApprox(P);
+    m_Pg = P;
+    update_lqr_gain();
+    return fixed_point;
+}
+
+template<typename T>
+template<int N>
+bool Lqr<T>::riccati_doubling(const Eigen::Matrix<real_t, N, N>& A0,
+        const Eigen::Matrix<real_t, N, N>& G0, const Eigen::Matrix<real_t, N, N>& H0,
+        Eigen::Matrix<real_t, N, N>* P) {
+    /*
+     * Structured doubling algorithm for the discrete algebraic Riccati equation
+     *     P = A'*P*(I + G*P)^-1*A + H,  G = B*R^-1*B'
+     * where each iteration doubles the number of Riccati recursion steps:
+     *     W_k = I + G_k*H_k
+     *     A_k+1 = A_k*W_k^-1*A_k
+     *     G_k+1 = G_k + A_k*W_k^-1*G_k*A_k'
+     *     H_k+1 = H_k + A_k'*H_k*W_k^-1*A_k
+     * and H_k converges quadratically to P if a stabilizing solution exists.
+     */
+    using matrix_t = Eigen::Matrix<real_t, N, N>;
+    matrix_t A = A0;
+    matrix_t G = G0;
+    matrix_t H = H0;
+    matrix_t W;
+    matrix_t WA;
+    matrix_t WG;
+    for (uint32_t i = 0; i < max_doubling_iterations; ++i) {
+        W.noalias() = G*H;
+        W += matrix_t::Identity();
+        Eigen::PartialPivLU<matrix_t> lu(W);
+        WA.noalias() = lu.solve(A);
+        WG.noalias() = lu.solve(G);
+
+        const matrix_t H_prev = H;
+        G.noalias() += A*WG*A.transpose();
+        H.noalias() += A.transpose()*H_prev*WA;
+        A = A*WA;
+        // enforce symmetry to limit error accumulation
+        G = (G + G.transpose())/2;
+        H = (H + H.transpose())/2;
+
+        if (!H.allFinite()) {
+            return false;
+        }
+        if ((H - H_prev).norm() <= Eigen::NumTraits<real_t>::dummy_precision()*H.norm()) {
+            *P = H;
+            return true;
+        }
+    }
+    return false;
+}
+
 template<typename T>
 void Lqr<T>::update_lqr_gain() {
+    if (m_Qi.isZero()) {
+        // error integral states are decoupled and have zero cost
+        update_lqr_gain<T::n>();
+    } else {
+        update_lqr_gain<2*T::n>();
+    }
+}
+
+template<typename T>
+template<int N>
+void Lqr<T>::update_lqr_gain() {
+    /*
+     * K = -(R + B'*P*B)^-1*B'*P*A
+     * The augmented input matrix is zero for the error integral states so
+     * only the first n rows of the cost-to-go contribute to B'*P.
+     */
+    const auto A = m_Ag.template topLeftCorner<N, N>();
+    const auto B = m_Bg.template topRows<T::n>();
+    const auto P = m_Pg.template topLeftCorner<N, N>().template topRows<T::n>();
+    Eigen::Matrix<real_t, T::m, N> BP;
     input_cost_t M;
     if (m_m == T::m) {
-        M.noalias() = m_R + m_Bg.transpose()*m_Pg*m_Bg;
-        m_Kg.noalias() = -M.fullPivHouseholderQr().solve(m_Bg.transpose()*m_Pg*m_Ag);
+        BP.noalias() = B.transpose()*P;
+        M.noalias() = m_R + BP.template leftCols<T::n>()*B;
+        m_Kg.template leftCols<N>().noalias() = -M.fullPivHouseholderQr().solve(BP*A);
     } else {
+        BP.topRows(m_m).noalias() = B.leftCols(m_m).transpose()*P;
         M.topLeftCorner(m_m, m_m).noalias() =
-            m_Rr.topLeftCorner(m_m, m_m) + m_Bg.leftCols(m_m).transpose()*m_Pg*m_Bg.leftCols(m_m);
-        m_Kg.topRows(m_m).noalias() = -M.topLeftCorner(m_m, m_m).fullPivHouseholderQr().solve(
-                m_Bg.leftCols(m_m).transpose()*m_Pg*m_Ag);
+            m_Rr.topLeftCorner(m_m, m_m) + BP.topRows(m_m).template leftCols<T::n>()*B.leftCols(m_m);
+        m_Kg.topRows(m_m).template leftCols<N>().noalias() =
+            -M.topLeftCorner(m_m, m_m).fullPivHouseholderQr().solve(BP.topRows(m_m)*A);
+    }
+}
+
+template<typename T>
+void Lqr<T>::update_horizon_cost() {
+    if (m_Qi.isZero()) {
+        // error integral states are decoupled and have zero cost
+        update_horizon_cost<T::n>();
+    } else {
+        update_horizon_cost<2*T::n>();
     }
 }
 
 template<typename T>
+template<int N>
 void Lqr<T>::update_horizon_cost() {
-    augmented_state_matrix_t M;
+    // P = K'*R*K + (A + B*K)'*P*(A + B*K) + Q
+    using matrix_t = Eigen::Matrix<real_t, N, N>;
+    const auto B = m_Bg.template topRows<N>();
+    const auto K = m_Kg.template leftCols<N>();
+    auto P = m_Pg.template topLeftCorner<N, N>();
+    matrix_t M = m_Ag.template topLeftCorner<N, N>();
+    matrix_t PM;
+    matrix_t P_next;
     if (m_m == T::m) {
-        M.noalias() = m_Ag + m_Bg*m_Kg;
-        m_Pg = m_Kg.transpose()*m_R*m_Kg + M.transpose()*m_Pg*M;
+        M.noalias() += B*K;
+        P_next.noalias() = K.transpose()*m_R*K;
     } else {
-        M.noalias() = m_Ag + m_Bg.leftCols(m_m)*m_Kg.topRows(m_m);
-        m_Pg = m_Kg.topRows(m_m).transpose()*m_Rr.topLeftCorner(m_m, m_m)*m_Kg.topRows(m_m) +
-            M.transpose()*m_Pg*M;
+        M.noalias() += B.leftCols(m_m)*K.topRows(m_m);
+        P_next.noalias() = K.topRows(m_m).transpose()*m_Rr.topLeftCorner(m_m, m_m)*K.topRows(m_m);
     }
+    PM.noalias() = P*M;
+    P_next.noalias() += M.transpose()*PM;
+    P = P_next;
     m_Pg.template topLeftCorner<T::n, T::n>() += m_Q;
     m_Pg.template bottomRightCorner<T::n, T::n>() += m_Qi;
 }
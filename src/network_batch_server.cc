@@ -0,0 +1,177 @@
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include "network_batch_server.h"
+
+namespace network {
+namespace udp {
+
+constexpr size_t BatchServer::batch_size;
+constexpr size_t BatchServer::max_sources;
+constexpr int BatchServer::receive_buffer_size;
+constexpr int BatchServer::send_timeout;
+
+BatchServer::BatchServer(uint16_t server_port, uint16_t remote_port, receive_function_t receive_function) :
+    m_remote_endpoint(asio::ip::udp::v4(), remote_port),
+    m_socket(m_io_service, asio::ip::udp::endpoint(asio::ip::udp::v4(), server_port)),
+    m_receive_function(receive_function),
+    m_send_frames(batch_size),
+    m_send_iovecs(batch_size),
+    m_send_messages(batch_size),
+    m_send_batch_count(0),
+    m_receive_frames(batch_size),
+    m_receive_iovecs(batch_size),
+    m_receive_messages(batch_size),
+    m_send_count(0),
+    m_send_dropped_count(0),
+    m_receive_count(0),
+    m_lost_count(0),
+    m_invalid_count(0) {
+    // a batch of small datagrams uses much more socket buffer space than its
+    // payload, the kernel limits the size to net.core.rmem_max
+    m_socket.set_option(asio::socket_base::receive_buffer_size(receive_buffer_size));
+
+    m_send_sequence.fill(0);
+    m_receive_sequence.fill(0);
+    m_source_seen.fill(false);
+
+    // message headers point to preallocated frame buffers and are reused for each batch
+    for (size_t i = 0; i < batch_size; ++i) {
+        m_send_iovecs[i].iov_base = m_send_frames[i].data();
+        m_send_iovecs[i].iov_len = 0;
+        std::memset(&m_send_messages[i], 0, sizeof(mmsghdr));
+        m_send_messages[i].msg_hdr.msg_name = m_remote_endpoint.data();
+        m_send_messages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(m_remote_endpoint.size());
+        m_send_messages[i].msg_hdr.msg_iov = &m_send_iovecs[i];
+        m_send_messages[i].msg_hdr.msg_iovlen = 1;
+
+        m_receive_iovecs[i].iov_base = m_receive_frames[i].data();
+        m_receive_iovecs[i].iov_len = max_frame_size;
+        std::memset(&m_receive_messages[i], 0, sizeof(mmsghdr));
+        m_receive_messages[i].msg_hdr.msg_iov = &m_receive_iovecs[i];
+        m_receive_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // started after all members are initialized
+    m_service_thread = std::thread(&BatchServer::run_service, this);
+}
+
+BatchServer::~BatchServer() {
+    flush();
+    m_io_service.stop();
+    m_service_thread.join();
+}
+
+void BatchServer::async_send(frame_t type, uint8_t source, asio::const_buffer payload) {
+    const size_t size = asio::buffer_size(payload);
+    if (size > max_payload_size) {
+        throw std::invalid_argument("Frame payload exceeds maximum payload size.");
+    }
+    const frame_header_t header{type, source, static_cast<uint16_t>(size), m_send_sequence[source]++};
+    m_send_iovecs[m_send_batch_count].iov_len = encode_frame(header,
+            asio::buffer_cast<const uint8_t*>(payload), m_send_frames[m_send_batch_count].data());
+    if (++m_send_batch_count == batch_size) {
+        flush();
+    }
+}
+
+void BatchServer::flush() {
+    const int fd = m_socket.native_handle();
+    size_t sent = 0;
+    while (sent < m_send_batch_count) {
+        const int n = sendmmsg(fd, &m_send_messages[sent],
+                static_cast<unsigned int>(m_send_batch_count - sent), 0);
+        if (n >= 0) {
+            sent += static_cast<size_t>(n);
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            // the socket may be in non-blocking mode after asio starts an asynchronous operation
+            pollfd p{fd, POLLOUT, 0};
+            if (poll(&p, 1, send_timeout) == 0) {
+                break; // the send buffer is still full, the remaining frames are dropped
+            }
+        } else if (errno != EINTR) {
+            std::cerr << std::strerror(errno) << "\n";
+            break; // the remaining frames are dropped
+        }
+    }
+    m_send_count.fetch_add(sent, std::memory_order_relaxed);
+    m_send_dropped_count.fetch_add(m_send_batch_count - sent, std::memory_order_relaxed);
+    m_send_batch_count = 0;
+}
+
+void BatchServer::wait_for_send_complete() {
+    flush();
+}
+
+void BatchServer::start_receive() {
+    // wait until readable, datagrams are read with recvmmsg() in the handler
+    m_socket.async_receive(asio::null_buffers(),
+            std::bind(&BatchServer::handle_receive,
+                this,
+                std::placeholders::_1));
+}
+
+void BatchServer::handle_receive(const asio::error_code& error) {
+    if (error == asio::error::operation_aborted) {
+        return;
+    }
+    if (!error) {
+        // read until the socket is empty
+        int n;
+        do {
+            n = recvmmsg(m_socket.native_handle(), m_receive_messages.data(),
+                    static_cast<unsigned int>(batch_size), MSG_DONTWAIT, nullptr);
+            for (int i = 0; i < n; ++i) {
+                const msghdr& message = m_receive_messages[i].msg_hdr;
+                if (message.msg_flags & MSG_TRUNC) {
+                    m_invalid_count.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    handle_frame(m_receive_frames[i].data(), m_receive_messages[i].msg_len);
+                }
+            }
+        } while (n == static_cast<int>(batch_size));
+    } else {
+        std::cerr << error.message() << "\n";
+    }
+    start_receive();
+}
+
+void BatchServer::handle_frame(const uint8_t* data, size_t size) {
+    frame_header_t header;
+    const uint8_t* payload;
+    if (!decode_frame(data, size, &header, &payload)) {
+        m_invalid_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // frames older than the newest received frame, i.e. reordered frames, do
+    // not change the expected sequence number
+    const uint32_t gap = header.sequence - m_receive_sequence[header.source];
+    if (!m_source_seen[header.source] || (gap < 0x80000000u)) {
+        if (m_source_seen[header.source]) {
+            m_lost_count.fetch_add(gap, std::memory_order_relaxed);
+        }
+        m_receive_sequence[header.source] = header.sequence + 1;
+        m_source_seen[header.source] = true;
+    }
+
+    if (m_receive_function) {
+        m_receive_function(header, payload);
+    }
+    m_receive_count.fetch_add(1, std::memory_order_release);
+}
+
+void BatchServer::run_service() {
+    start_receive();
+    try {
+        m_io_service.run();
+    } catch (std::exception& e) {
+        std::cerr << e.what() << "\n";
+    }
+}
+
+} // namespace udp
+} // namespace network
@@ -5,17 +5,22 @@
 namespace network {
 namespace udp {
 
-Server::Server(uint16_t server_port, uint16_t remote_port) :
+Server::Server(uint16_t server_port, uint16_t remote_port, receive_function_t receive_function) :
     m_remote_endpoint(asio::ip::udp::v4(), remote_port),
     m_server_endpoint(asio::ip::udp::v4(), server_port),
     m_socket(m_io_service, m_server_endpoint),
-    m_service_thread(std::bind(&Server::run_service, this)),
+    m_receive_function(receive_function),
     m_pending_receptions(0),
     m_pending_transmissions(0),
+    m_waiters(0),
     m_receive_count(0) {
     //m_transmit_count(0) {
-        std::cout << "Starting UDP server, receiving on port " << server_port << "\n";
-        std::cout << "                  transmitting to port " << remote_port << "\n";
+        if (!m_receive_function) {
+            std::cout << "Starting UDP server, receiving on port " << server_port << "\n";
+            std::cout << "                  transmitting to port " << remote_port << "\n";
+        }
+        // started after all members are initialized
+        m_service_thread = std::thread(&Server::run_service, this);
 }
 
 Server::~Server() {
@@ -42,14 +47,12 @@ void Server::start_receive() {
 }
 
 void Server::handle_receive(const asio::error_code& error, size_t bytes_transferred) {
-    (void)bytes_transferred;
-    {
-        std::lock_guard<std::mutex> lock(m_receive_mutex);
-        ++m_pending_receptions;
-    }
+    ++m_pending_receptions;
 
     ++m_receive_count;
-    if (!error) {
+    if (!error && m_receive_function) {
+        m_receive_function(m_receive_buffer.data(), bytes_transferred);
+    } else if (!error) {
         std::cout << m_receive_count << ": received ";
         for (size_t i = 0; i < bytes_transferred/sizeof(double); ++i) {
             std::cout << *(reinterpret_cast<double*>(m_receive_buffer.data())+ i) << " ";
@@ -60,11 +63,7 @@ void Server::handle_receive(const asio::error_code& error, size_t bytes_transfer
     }
     start_receive();
 
-    {
-        std::lock_guard<std::mutex> lock(m_receive_mutex);
-        --m_pending_receptions;
-    }
-    m_receive_condition_variable.notify_all();
+    complete(&m_pending_receptions);
 }
 
 void Server::handle_send(const asio::error_code& error, size_t bytes_transferred) {
@@ -75,11 +74,18 @@ void Server::handle_send(const asio::error_code& error, size_t bytes_transferred
         std::cerr << error.message() << "\n";
     }
 
-    {
-        std::lock_guard<std::mutex> lock(m_send_mutex);
-        --m_pending_transmissions;
+    complete(&m_pending_transmissions);
+}
+
+void Server::complete(std::atomic<uint32_t>* pending) {
+    // a waiter increments m_waiters before checking the counter under the
+    // mutex, so either the waiter sees zero or this sees the waiter
+    if ((pending->fetch_sub(1) == 1) && (m_waiters.load() > 0)) {
+        {
+            std::lock_guard<std::mutex> lock(m_wait_mutex);
+        }
+        m_wait_condition_variable.notify_all();
     }
-    m_send_condition_variable.notify_all();
 }
 
 //void Server::async_send(uint8_t* buffer, size_t length) {
@@ -92,12 +98,10 @@ void Server::handle_send(const asio::error_code& error, size_t bytes_transferred
 //}
 
 void Server::async_send(asio::const_buffer buffer) {
-    {
-        std::lock_guard<std::mutex> lock(m_send_mutex);
-        ++m_pending_transmissions;
-    }
+    ++m_pending_transmissions;
 
-    // TODO: ensure that buffer data is not changed if transmission queued
+    // buffer data must not change until the transmission completes, see
+    // SnapshotTransmitServer for periodic transmission of changing data
     //size_t bytes_copied = asio::buffer_copy(asio::buffer(m_transmit_buffer), buffer);
     //m_socket.async_send_to(asio::buffer(m_transmit_buffer, bytes_copied),
     m_socket.async_send_to(asio::buffer(buffer),
@@ -117,14 +121,28 @@ void Server::run_service() {
     }
 }
 
+bool Server::send_pending() {
+    return m_pending_transmissions.load() > 0;
+}
+
+void Server::wait_for_complete(const std::atomic<uint32_t>& pending) {
+    if (pending.load() == 0) {
+        return;
+    }
+    ++m_waiters;
+    {
+        std::unique_lock<std::mutex> lock(m_wait_mutex);
+        m_wait_condition_variable.wait(lock, [&pending]{return pending.load() == 0;});
+    }
+    --m_waiters;
+}
+
 void Server::wait_for_receive_complete() {
-    std::unique_lock<std::mutex> lock(m_receive_mutex);
-    m_receive_condition_variable.wait(lock, [this]{return m_pending_receptions == 0;});
+    wait_for_complete(m_pending_receptions);
 }
 
 void Server::wait_for_send_complete() {
-    std::unique_lock<std::mutex> lock(m_send_mutex);
-    m_send_condition_variable.wait(lock, [this]{return m_pending_transmissions == 0;});
+    wait_for_complete(m_pending_transmissions);
 }
 
 } // namespace udp
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+/*
+ * Member function definitions of PitchTable class.
+ * See pitch_table.h for class declaration.
+ */
+
+namespace model {
+
+inline PitchTable::PitchTable() :
+    m_roll_max(0), m_steer_max(0), m_spacing(0), m_droll(0), m_dsteer(0), m_max_error(0),
+    m_roll_points(0), m_steer_points(0) { }
+
+template <typename F>
+void PitchTable::generate(real_t roll_max, real_t steer_max, real_t spacing, F solve) {
+    if (!(roll_max > 0) || !(steer_max > 0) || !(spacing > 0)) {
+        throw std::invalid_argument("Invalid pitch table range provided.");
+    }
+
+    const size_t roll_intervals = static_cast<size_t>(std::ceil(2*roll_max/spacing));
+    const size_t steer_intervals = static_cast<size_t>(std::ceil(2*steer_max/spacing));
+    clear();
+    m_roll_max = roll_max;
+    m_steer_max = steer_max;
+    m_spacing = spacing;
+    m_droll = 2*roll_max/roll_intervals;
+    m_dsteer = 2*steer_max/steer_intervals;
+    m_roll_points = roll_intervals + 3;
+    m_steer_points = steer_intervals + 3;
+
+    // the first and last grid points in each direction are padding outside the domain
+    m_pitch.resize(m_roll_points*m_steer_points);
+    for (size_t i = 0; i < m_roll_points; ++i) {
+        const real_t roll = -m_roll_max + (static_cast<real_t>(i) - 1)*m_droll;
+        for (size_t j = 0; j < m_steer_points; ++j) {
+            const real_t steer = -m_steer_max + (static_cast<real_t>(j) - 1)*m_dsteer;
+            m_pitch[i*m_steer_points + j] = solve(roll, steer);
+        }
+    }
+
+    for (size_t i = 0; i < roll_intervals; ++i) {
+        const real_t roll = -m_roll_max + (i + static_cast<real_t>(0.5))*m_droll;
+        for (size_t j = 0; j < steer_intervals; ++j) {
+            const real_t steer = -m_steer_max + (j + static_cast<real_t>(0.5))*m_dsteer;
+            m_max_error = std::max(m_max_error, std::abs(interpolate(roll, steer) - solve(roll, steer)));
+        }
+    }
+}
+
+inline void PitchTable::clear() {
+    m_pitch.clear();
+    m_max_error = 0;
+}
+
+inline bool PitchTable::lookup(real_t roll, real_t steer, real_t* pitch) const {
+    if (empty() || !(std::abs(roll) <= m_roll_max) || !(std::abs(steer) <= m_steer_max)) {
+        return false;
+    }
+    *pitch = interpolate(roll, steer);
+    return true;
+}
+
+inline real_t PitchTable::interpolate(real_t roll, real_t steer) const {
+    const real_t s_roll = (roll + m_roll_max)/m_droll;
+    const real_t s_steer = (steer + m_steer_max)/m_dsteer;
+    const size_t i = std::min(static_cast<size_t>(s_roll), m_roll_points - 4);
+    const size_t j = std::min(static_cast<size_t>(s_steer), m_steer_points - 4);
+
+    real_t w_roll[4];
+    real_t w_steer[4];
+    catmull_rom_weights(s_roll - i, w_roll);
+    catmull_rom_weights(s_steer - j, w_steer);
+
+    // grid point i of the domain is stored at padded index i + 1
+    real_t pitch = 0;
+    for (size_t k = 0; k < 4; ++k) {
+        const real_t* row = &m_pitch[(i + k)*m_steer_points + j];
+        pitch += w_roll[k]*(w_steer[0]*row[0] + w_steer[1]*row[1] + w_steer[2]*row[2] + w_steer[3]*row[3]);
+    }
+    return pitch;
+}
+
+inline void PitchTable::catmull_rom_weights(real_t t, real_t w[4]) {
+    const real_t t2 = t*t;
+    const real_t t3 = t2*t;
+    w[0] = (-t3 + 2*t2 - t)/2;
+    w[1] = (3*t3 - 5*t2 + 2)/2;
+    w[2] = (-3*t3 + 4*t2 + t)/2;
+    w[3] = (t3 - t2)/2;
+}
+
+} // namespace model
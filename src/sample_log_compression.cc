@@ -0,0 +1,177 @@
+#include <cstring>
+#include "sample_log_compression.h"
+
+namespace {
+    constexpr size_t word_size = 8;
+    constexpr size_t max_run = 128;
+    constexpr uint8_t zero_run_flag = 0x80;
+
+    void put_u32(std::vector<uint8_t>* out, uint32_t value) {
+        for (size_t i = 0; i < sizeof(value); ++i) {
+            out->push_back(static_cast<uint8_t>(value >> (8*i)));
+        }
+    }
+
+    uint32_t get_u32(const uint8_t* p) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < sizeof(value); ++i) {
+            value |= static_cast<uint32_t>(p[i]) << (8*i);
+        }
+        return value;
+    }
+
+    /* byte k of word w is moved to plane k, trailing bytes are not shuffled */
+    void shuffle(const uint8_t* in, uint8_t* out, size_t size) {
+        const size_t words = size/word_size;
+        for (size_t k = 0; k < word_size; ++k) {
+            for (size_t w = 0; w < words; ++w) {
+                out[k*words + w] = in[w*word_size + k];
+            }
+        }
+        std::memcpy(out + words*word_size, in + words*word_size, size - words*word_size);
+    }
+
+    void unshuffle(const uint8_t* in, uint8_t* out, size_t size) {
+        const size_t words = size/word_size;
+        for (size_t k = 0; k < word_size; ++k) {
+            for (size_t w = 0; w < words; ++w) {
+                out[w*word_size + k] = in[k*words + w];
+            }
+        }
+        std::memcpy(out + words*word_size, in + words*word_size, size - words*word_size);
+    }
+
+    /*
+     * A control byte with the high bit set is followed by nothing and
+     * represents (c & 0x7f) + 1 zero bytes. Otherwise it is followed by c + 1
+     * literal bytes. Single zero bytes are included in literal runs.
+     */
+    void run_length_encode(const uint8_t* in, size_t size, std::vector<uint8_t>* out) {
+        size_t i = 0;
+        while (i < size) {
+            const size_t start = i;
+            if (in[i] == 0) {
+                while ((i < size) && (in[i] == 0) && (i - start < max_run)) {
+                    ++i;
+                }
+                out->push_back(static_cast<uint8_t>(zero_run_flag | (i - start - 1)));
+            } else {
+                while ((i < size) && (i - start < max_run) &&
+                        !((in[i] == 0) && (i + 1 < size) && (in[i + 1] == 0))) {
+                    ++i;
+                }
+                out->push_back(static_cast<uint8_t>(i - start - 1));
+                out->insert(out->end(), in + start, in + i);
+            }
+        }
+    }
+
+    bool run_length_decode(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) {
+        size_t i = 0;
+        size_t o = 0;
+        while (i < in_size) {
+            const uint8_t c = in[i++];
+            const size_t n = static_cast<size_t>(c & ~zero_run_flag) + 1;
+            if (o + n > out_size) {
+                return false;
+            }
+            if (c & zero_run_flag) {
+                std::memset(out + o, 0, n);
+            } else {
+                if (i + n > in_size) {
+                    return false;
+                }
+                std::memcpy(out + o, in + i, n);
+                i += n;
+            }
+            o += n;
+        }
+        return o == out_size;
+    }
+} // namespace
+
+namespace fbs {
+namespace compression {
+
+void encode_block(const std::vector<uint32_t>& sizes, const uint8_t* data,
+        std::vector<uint8_t>* encoded, std::vector<uint8_t>* scratch) {
+    size_t data_size = 0;
+    for (uint32_t s: sizes) {
+        data_size += s;
+    }
+    scratch->resize(2*data_size);
+    uint8_t* x = scratch->data();
+    uint8_t* y = scratch->data() + data_size;
+
+    // XOR with the previous record of the same size
+    size_t offset = 0;
+    for (size_t r = 0; r < sizes.size(); ++r) {
+        const size_t s = sizes[r];
+        if ((r > 0) && (s == sizes[r - 1])) {
+            for (size_t j = 0; j < s; ++j) {
+                x[offset + j] = data[offset + j] ^ data[offset - s + j];
+            }
+        } else {
+            std::memcpy(x + offset, data + offset, s);
+        }
+        offset += s;
+    }
+    shuffle(x, y, data_size);
+
+    encoded->clear();
+    put_u32(encoded, static_cast<uint32_t>(sizes.size()));
+    put_u32(encoded, static_cast<uint32_t>(data_size));
+    for (uint32_t s: sizes) {
+        put_u32(encoded, s);
+    }
+    run_length_encode(y, data_size, encoded);
+}
+
+bool decode_block(const uint8_t* encoded, size_t encoded_size,
+        std::vector<uint32_t>* sizes, std::vector<uint8_t>* data,
+        std::vector<uint8_t>* scratch) {
+    if (encoded_size < 2*sizeof(uint32_t)) {
+        return false;
+    }
+    const size_t count = get_u32(encoded);
+    const size_t data_size = get_u32(encoded + sizeof(uint32_t));
+    const size_t header_size = (2 + count)*sizeof(uint32_t);
+    if ((count > encoded_size/sizeof(uint32_t)) || (header_size > encoded_size)) {
+        return false;
+    }
+
+    sizes->resize(count);
+    size_t total = 0;
+    for (size_t r = 0; r < count; ++r) {
+        (*sizes)[r] = get_u32(encoded + (2 + r)*sizeof(uint32_t));
+        total += (*sizes)[r];
+    }
+    if (total != data_size) {
+        return false;
+    }
+
+    scratch->resize(data_size);
+    data->resize(data_size);
+    if (!run_length_decode(encoded + header_size, encoded_size - header_size,
+                scratch->data(), data_size)) {
+        return false;
+    }
+    uint8_t* x = data->data();
+    unshuffle(scratch->data(), x, data_size);
+
+    // undo the XOR in order as each record depends on the decoded previous record
+    size_t offset = 0;
+    for (size_t r = 0; r < count; ++r) {
+        const size_t s = (*sizes)[r];
+        if ((r > 0) && (s == (*sizes)[r - 1])) {
+            for (size_t j = 0; j < s; ++j) {
+                x[offset + j] ^= x[offset - s + j];
+            }
+        }
+        offset += s;
+    }
+    return true;
+}
+
+} // namespace compression
+} // namespace fbs
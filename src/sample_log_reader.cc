@@ -0,0 +1,176 @@
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sample_log_compression.h"
+#include "sample_log_reader.h"
+#include "sample_log_writer.h"
+
+namespace {
+    template <typename T>
+    T read_scalar(const uint8_t* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return flatbuffers::EndianScalar(value);
+    }
+
+    // uint64 index_interval, uint64 samples, uint32 count, char identifier[4]
+    constexpr size_t footer_trailer_size = 2*sizeof(uint64_t) + sizeof(uint32_t) +
+        sizeof(fbs::SampleLogWriter::index_identifier);
+} // namespace
+
+namespace fbs {
+
+constexpr size_t SampleLogReader::cache_size;
+
+SampleLogReader::SampleLogReader(const char* filename) :
+    m_data(nullptr),
+    m_file_size(0),
+    m_format(format_t::stream),
+    m_cache_next(0) {
+    for (auto& c: m_cache) {
+        c.block = static_cast<size_t>(-1);
+    }
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open sample log file.");
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        ::close(fd);
+        throw std::runtime_error("Unable to read sample log file size.");
+    }
+    m_file_size = static_cast<size_t>(st.st_size);
+    if (m_file_size > 0) {
+        void* p = mmap(nullptr, m_file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Unable to map sample log file.");
+        }
+        m_data = static_cast<const uint8_t*>(p);
+    }
+    ::close(fd); // the mapping remains valid after the file is closed
+
+    if ((m_file_size >= sizeof(flatbuffers::uoffset_t) + flatbuffers::kFileIdentifierLength) &&
+            flatbuffers::BufferHasIdentifier(m_data, SampleLogIdentifier())) {
+        m_format = format_t::container;
+        build_container_index();
+    } else if ((m_file_size >= sizeof(SampleLogWriter::compression_identifier) + sizeof(uint32_t)) &&
+            (std::memcmp(m_data, SampleLogWriter::compression_identifier,
+                         sizeof(SampleLogWriter::compression_identifier)) == 0)) {
+        m_format = format_t::compressed_stream;
+        build_compressed_stream_index();
+    } else {
+        build_stream_index();
+    }
+}
+
+SampleLogReader::~SampleLogReader() {
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_file_size);
+    }
+}
+
+void SampleLogReader::build_container_index() {
+    const auto samples = GetSampleLog(m_data)->samples();
+    if (samples == nullptr) {
+        return;
+    }
+    m_index.reserve(samples->size());
+    for (const auto s: *samples) {
+        const auto data = s->data();
+        m_index.push_back(record_t{
+                static_cast<uint64_t>(data->Data() - m_data), data->size(), 0});
+    }
+}
+
+size_t SampleLogReader::stream_end(size_t* samples) const {
+    // records end where the index footer starts, if the footer exists
+    *samples = 0;
+    if ((m_file_size >= footer_trailer_size) &&
+            (std::memcmp(m_data + m_file_size - sizeof(SampleLogWriter::index_identifier),
+                         SampleLogWriter::index_identifier,
+                         sizeof(SampleLogWriter::index_identifier)) == 0)) {
+        const uint8_t* trailer = m_data + m_file_size - footer_trailer_size;
+        const uint32_t count = read_scalar<uint32_t>(trailer + 2*sizeof(uint64_t));
+        const size_t footer_size = footer_trailer_size + count*sizeof(uint64_t);
+        if (footer_size <= m_file_size) {
+            *samples = read_scalar<uint64_t>(trailer + sizeof(uint64_t));
+            return m_file_size - footer_size;
+        }
+    }
+    return m_file_size;
+}
+
+void SampleLogReader::build_stream_index() {
+    size_t samples;
+    const size_t end = stream_end(&samples);
+    m_index.reserve(samples);
+
+    // only the record headers are read, see SampleLogWriter for the record layout
+    static constexpr size_t alignment = SampleLogWriter::record_alignment;
+    size_t offset = 0;
+    while (offset + 2*sizeof(uint32_t) <= end) {
+        const uint32_t size = read_scalar<uint32_t>(m_data + offset);
+        offset += 2*sizeof(uint32_t);
+        if (size > end - offset) {
+            break; // truncated record
+        }
+        m_index.push_back(record_t{offset, size, 0});
+        offset += (size + alignment - 1)/alignment*alignment;
+    }
+}
+
+void SampleLogReader::build_compressed_stream_index() {
+    size_t samples;
+    const size_t end = stream_end(&samples);
+    m_index.reserve(samples);
+
+    // only the block size prefixes and the record sizes in the block headers are read
+    size_t offset = sizeof(SampleLogWriter::compression_identifier) + sizeof(uint32_t);
+    while (offset + sizeof(uint32_t) <= end) {
+        const uint32_t size = read_scalar<uint32_t>(m_data + offset);
+        offset += sizeof(uint32_t);
+        if ((size > end - offset) || (size < 2*sizeof(uint32_t))) {
+            break; // truncated block
+        }
+        const uint8_t* header = m_data + offset;
+        const uint32_t count = read_scalar<uint32_t>(header);
+        if (count > (size - 2*sizeof(uint32_t))/sizeof(uint32_t)) {
+            break; // invalid block
+        }
+        const uint32_t block = static_cast<uint32_t>(m_blocks.size());
+        uint64_t record_offset = 0;
+        for (uint32_t r = 0; r < count; ++r) {
+            const uint32_t record_size = read_scalar<uint32_t>(header + (2 + r)*sizeof(uint32_t));
+            m_index.push_back(record_t{record_offset, record_size, block});
+            record_offset += record_size;
+        }
+        m_blocks.push_back(block_t{offset, size});
+        offset += size;
+    }
+}
+
+const uint8_t* SampleLogReader::block_data(size_t block) const {
+    for (const auto& c: m_cache) {
+        if (c.block == block) {
+            return c.data.data();
+        }
+    }
+
+    // replace the least recently decoded block
+    cached_block_t& c = m_cache[m_cache_next];
+    m_cache_next = (m_cache_next + 1) % cache_size;
+    c.block = static_cast<size_t>(-1);
+    const block_t& b = m_blocks[block];
+    if (!compression::decode_block(m_data + b.offset, b.size,
+                &m_decode_sizes, &c.data, &m_decode_scratch)) {
+        throw std::runtime_error("Unable to decode sample log block.");
+    }
+    c.block = block;
+    return c.data.data();
+}
+
+} // namespace fbs
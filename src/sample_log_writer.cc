@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+#include "sample_log_compression.h"
+#include "sample_log_writer.h"
+
+namespace fbs {
+
+constexpr size_t SampleLogWriter::default_ring_size;
+constexpr size_t SampleLogWriter::default_builder_size;
+constexpr size_t SampleLogWriter::default_index_interval;
+constexpr size_t SampleLogWriter::record_alignment;
+constexpr char SampleLogWriter::index_identifier[4];
+constexpr char SampleLogWriter::compression_identifier[4];
+
+SampleLogWriter::SampleLogWriter(const char* filename, size_t ring_size,
+        std::chrono::milliseconds sync_period, size_t index_interval, compression_t compression) :
+    m_file(open_file(filename, ring_size, index_interval)),
+    m_sync_period(sync_period),
+    m_index_interval(index_interval),
+    m_file_offset(0),
+    m_compression(compression),
+    m_head(0),
+    m_tail(0),
+    m_acquired(false),
+    m_samples_written(0),
+    m_samples_dropped(0),
+    m_error(false),
+    m_closing(false) {
+    // all builders are allocated up front so that the loop thread does not allocate
+    for (size_t i = 0; i < ring_size; ++i) {
+        m_ring.emplace_back(new flatbuffers::FlatBufferBuilder(default_builder_size));
+    }
+    if (m_compression == compression_t::block) {
+        const uint32_t block_records = flatbuffers::EndianScalar(static_cast<uint32_t>(m_index_interval));
+        write(compression_identifier, sizeof(compression_identifier));
+        write(&block_records, sizeof(block_records));
+        m_file_offset = sizeof(compression_identifier) + sizeof(block_records);
+        m_block_sizes.reserve(m_index_interval);
+        m_block_data.reserve(m_index_interval*default_builder_size);
+    }
+    m_writer_thread = std::thread(&SampleLogWriter::run_writer, this);
+}
+
+SampleLogWriter::~SampleLogWriter() {
+    close();
+}
+
+flatbuffers::FlatBufferBuilder* SampleLogWriter::acquire() {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= m_ring.size()) {
+        ++m_samples_dropped;
+        return nullptr;
+    }
+    m_acquired = true;
+    return m_ring[head % m_ring.size()].get();
+}
+
+void SampleLogWriter::commit() {
+    if (!m_acquired) {
+        return;
+    }
+    m_acquired = false;
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    m_condition_variable.notify_one();
+}
+
+void SampleLogWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closing) {
+            return;
+        }
+        m_closing = true;
+    }
+    m_condition_variable.notify_one();
+    m_writer_thread.join();
+
+    if (!m_block_sizes.empty()) {
+        write_block();
+    }
+    write_footer();
+    sync();
+    if (std::fclose(m_file.release()) != 0) {
+        m_error = true;
+    }
+}
+
+SampleLogWriter::file_t SampleLogWriter::open_file(const char* filename, size_t ring_size, size_t index_interval) {
+    // arguments are checked first so that an existing file is not truncated
+    if ((ring_size == 0) || (index_interval == 0)) {
+        throw std::invalid_argument("Invalid ring size or index interval provided.");
+    }
+    file_t file(std::fopen(filename, "wb"));
+    if (file == nullptr) {
+        throw std::runtime_error("Unable to open sample log file.");
+    }
+    return file;
+}
+
+void SampleLogWriter::run_writer() {
+    auto sync_time = std::chrono::steady_clock::now() + m_sync_period;
+    while (true) {
+        bool closing;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // commit() does not lock the mutex so the wait is bounded to not miss a notification
+            m_condition_variable.wait_for(lock, std::min(m_sync_period, std::chrono::milliseconds(10)),
+                    [this]() {
+                        return m_closing || (m_head.load(std::memory_order_acquire) !=
+                                m_tail.load(std::memory_order_relaxed));
+                    });
+            closing = m_closing;
+        }
+
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            flatbuffers::FlatBufferBuilder& builder = *m_ring[tail % m_ring.size()];
+            write_record(builder);
+            builder.Clear();
+            m_tail.store(tail + 1, std::memory_order_release);
+        }
+
+        if (std::chrono::steady_clock::now() >= sync_time) {
+            sync();
+            sync_time = std::chrono::steady_clock::now() + m_sync_period;
+        }
+        if (closing && (m_head.load(std::memory_order_acquire) == tail)) {
+            break;
+        }
+    }
+}
+
+void SampleLogWriter::write_record(const flatbuffers::FlatBufferBuilder& builder) {
+    if (m_error) {
+        ++m_samples_dropped;
+        return;
+    }
+    if (m_compression == compression_t::block) {
+        const uint8_t* data = builder.GetBufferPointer();
+        m_block_sizes.push_back(builder.GetSize());
+        m_block_data.insert(m_block_data.end(), data, data + builder.GetSize());
+        if (m_block_sizes.size() == m_index_interval) {
+            write_block();
+        }
+        return;
+    }
+
+    if ((m_samples_written % m_index_interval) == 0) {
+        m_index.push_back(m_file_offset);
+    }
+    static constexpr uint8_t padding[record_alignment] = {};
+    const uint32_t size = builder.GetSize();
+    const uint32_t header[2] = {flatbuffers::EndianScalar(size), 0};
+    const size_t padding_size = (record_alignment - size % record_alignment) % record_alignment;
+    write(header, sizeof(header));
+    write(builder.GetBufferPointer(), size);
+    write(padding, padding_size);
+    m_file_offset += sizeof(header) + size + padding_size;
+    if (m_error) {
+        ++m_samples_dropped;
+    } else {
+        ++m_samples_written;
+    }
+}
+
+void SampleLogWriter::write_block() {
+    compression::encode_block(m_block_sizes, m_block_data.data(), &m_block_encoded, &m_block_scratch);
+    m_index.push_back(m_file_offset);
+    const uint32_t size_le = flatbuffers::EndianScalar(static_cast<uint32_t>(m_block_encoded.size()));
+    write(&size_le, sizeof(size_le));
+    write(m_block_encoded.data(), m_block_encoded.size());
+    m_file_offset += sizeof(size_le) + m_block_encoded.size();
+    // samples of a block are counted when the block is written
+    if (m_error) {
+        m_samples_dropped += m_block_sizes.size();
+    } else {
+        m_samples_written += m_block_sizes.size();
+    }
+    m_block_sizes.clear();
+    m_block_data.clear();
+}
+
+void SampleLogWriter::write_footer() {
+    for (uint64_t offset: m_index) {
+        const uint64_t offset_le = flatbuffers::EndianScalar(offset);
+        write(&offset_le, sizeof(offset_le));
+    }
+    const uint64_t index_interval = flatbuffers::EndianScalar(static_cast<uint64_t>(m_index_interval));
+    const uint64_t samples = flatbuffers::EndianScalar(m_samples_written.load());
+    const uint32_t count = flatbuffers::EndianScalar(static_cast<uint32_t>(m_index.size()));
+    write(&index_interval, sizeof(index_interval));
+    write(&samples, sizeof(samples));
+    write(&count, sizeof(count));
+    write(index_identifier, sizeof(index_identifier));
+}
+
+void SampleLogWriter::write(const void* data, size_t size) {
+    if (m_error) {
+        return;
+    }
+    if (std::fwrite(data, sizeof(uint8_t), size, m_file.get()) != size) {
+        m_error = true;
+    }
+}
+
+void SampleLogWriter::sync() {
+    if (m_error) {
+        return;
+    }
+    if ((std::fflush(m_file.get()) != 0) || (fsync(fileno(m_file.get())) != 0)) {
+        m_error = true;
+    }
+}
+
+} // namespace fbs
@@ -0,0 +1,55 @@
+#include <stdexcept>
+/*
+ * Member function definitions of ScheduledKalman template class.
+ * See scheduled_kalman.h for template class declaration.
+ */
+
+namespace observer {
+
+template <typename T>
+ScheduledKalman<T>::ScheduledKalman(T& system, const schedule_t& schedule, const state_t& x0) :
+    Observer<T>(system, x0), m_schedule(schedule) {
+    if (m_schedule.empty() || (m_schedule.dt() != m_system.dt())) {
+        throw std::invalid_argument("Gain schedule does not match system sampling time.");
+    }
+    update_gain();
+}
+
+template <typename T>
+void ScheduledKalman<T>::reset() {
+    m_x.setZero();
+    update_gain();
+}
+
+template <typename T>
+void ScheduledKalman<T>::update_state(const input_t& u, const measurement_t& z) {
+    time_update(u);
+    measurement_update(z);
+}
+
+template <typename T>
+void ScheduledKalman<T>::time_update() {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x);
+}
+
+template <typename T>
+void ScheduledKalman<T>::time_update(const input_t& u) {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x + m_system.Bd()*u);
+}
+
+template <typename T>
+void ScheduledKalman<T>::measurement_update(const measurement_t& z) {
+    if (m_system.revision() != m_system_revision) {
+        update_gain();
+    }
+    m_x = m_system.normalize_state(m_x + m_K*(
+                m_system.normalize_output(z - m_system.Cd()*m_x)));
+}
+
+template <typename T>
+void ScheduledKalman<T>::update_gain() {
+    m_system_revision = m_system.revision();
+    m_schedule.kalman_gain(m_system.v(), &m_K, &m_P);
+}
+
+} // namespace observer
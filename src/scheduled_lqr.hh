@@ -0,0 +1,42 @@
+#include <stdexcept>
+/*
+ * Member function definitions of ScheduledLqr template class.
+ * See scheduled_lqr.h for template class declaration.
+ */
+
+namespace controller {
+
+template<typename T>
+ScheduledLqr<T>::ScheduledLqr(T& system, const schedule_t& schedule,
+        const state_t& r, const state_t& q) :
+    m_system(system), m_schedule(schedule), m_r(r), m_q(q) {
+    if (m_schedule.empty() || (m_schedule.dt() != m_system.dt())) {
+        throw std::invalid_argument("Gain schedule does not match system sampling time.");
+    }
+    m_integral_mask = (m_schedule.weights().lqr_Qi.diagonal().array() != 0.0).template cast<real_t>();
+    update_gain();
+}
+
+template<typename T>
+typename ScheduledLqr<T>::input_t ScheduledLqr<T>::control_calculate(const state_t& x) {
+    if (m_system.revision() != m_system_revision) {
+        update_gain();
+    }
+    const input_t u = m_K*x + m_Ki*m_q;
+    m_q += m_integral_mask.cwiseProduct(x - m_r);
+    return u;
+}
+
+template<typename T>
+typename ScheduledLqr<T>::input_t ScheduledLqr<T>::control_calculate(const state_t& x, const state_t& r) {
+    set_reference(r);
+    return control_calculate(x);
+}
+
+template<typename T>
+void ScheduledLqr<T>::update_gain() {
+    m_system_revision = m_system.revision();
+    m_schedule.lqr_gain(m_system.v(), &m_K, &m_Ki);
+}
+
+} // namespace controller
@@ -0,0 +1,152 @@
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
+/*
+ * Member function definitions of SquareRootKalman template class.
+ * See square_root_kalman.h for template class declaration.
+ */
+
+namespace observer {
+
+template <typename T>
+SquareRootKalman<T>::SquareRootKalman(T& system) : Observer<T>(system, state_t::Zero()) {
+    reset();
+}
+
+template <typename T>
+SquareRootKalman<T>::SquareRootKalman(T& system, const state_t& x0) : Observer<T>(system, x0) {
+    reset();
+}
+
+template <typename T>
+SquareRootKalman<T>::SquareRootKalman(T& system, const state_t& x0,
+        const process_noise_covariance_t& Q,
+        const measurement_noise_covariance_t& R,
+        const error_covariance_t& P0) : Observer<T>(system, x0) {
+    m_K.setZero();
+    set_P(P0);
+    set_Q(Q);
+    set_R(R);
+}
+
+template <typename T>
+void SquareRootKalman<T>::reset() {
+    m_x.setZero();
+    m_S.setIdentity();
+    m_Q.setIdentity();
+    m_Q_factor.setIdentity();
+    m_R.setIdentity();
+    m_R_factor.setIdentity();
+    m_K.setZero();
+}
+
+template <typename T>
+void SquareRootKalman<T>::update_state(const input_t& u, const measurement_t& z) {
+    time_update(u);
+    measurement_update(z);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update() {
+    time_update_state();
+    time_update_error_covariance(m_Q_factor);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update(const process_noise_covariance_t& Q) {
+    time_update_state();
+    time_update_error_covariance(factor(Q));
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update(const input_t& u) {
+    time_update_state(u);
+    time_update_error_covariance(m_Q_factor);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update(const input_t& u, const process_noise_covariance_t& Q) {
+    time_update_state(u);
+    time_update_error_covariance(factor(Q));
+}
+
+template <typename T>
+void SquareRootKalman<T>::measurement_update(const measurement_t& z) {
+    measurement_update_error_covariance(m_R_factor);
+    measurement_update_state(z);
+}
+
+template <typename T>
+void SquareRootKalman<T>::measurement_update(const measurement_t& z, const measurement_noise_covariance_t& R) {
+    measurement_update_error_covariance(factor(R));
+    measurement_update_state(z);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update_state() {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update_state(const input_t& u) {
+    m_x = m_system.normalize_state(m_system.Ad()*m_x + m_system.Bd()*u);
+}
+
+template <typename T>
+void SquareRootKalman<T>::time_update_error_covariance(const process_noise_covariance_t& Q_factor) {
+    /*
+     * P = A*P*A' + Q = M*M' with M = [A*S, Q^1/2]
+     * With the QR decomposition M' = Q_M*R_M, P = R_M'*R_M and the updated
+     * factor is the lower triangular matrix R_M'.
+     */
+    Eigen::Matrix<real_t, 2*T::n, T::n> M;
+    M.template topRows<T::n>().noalias() = (m_system.Ad()*m_S).transpose();
+    M.template bottomRows<T::n>() = Q_factor.transpose();
+    Eigen::HouseholderQR<Eigen::Matrix<real_t, 2*T::n, T::n>> qr(M);
+    m_S = qr.matrixQR().template topRows<T::n>().template triangularView<Eigen::Upper>().transpose();
+}
+
+template <typename T>
+void SquareRootKalman<T>::measurement_update_state(const measurement_t& z) {
+    m_x = m_system.normalize_state(m_x + m_K*(
+                m_system.normalize_output(z - m_system.Cd()*m_x)));
+}
+
+template <typename T>
+void SquareRootKalman<T>::measurement_update_error_covariance(const measurement_noise_covariance_t& R_factor) {
+    /*
+     * The pre-array
+     *     [R^1/2  C*S]
+     *     [    0    S]
+     * is triangularized with an orthogonal transformation to obtain
+     *     [Se     0]
+     *     [Kb    S+]
+     * where Se*Se' = C*P*C' + R is the innovation covariance,
+     * Kb = P*C'*Se'^-1, and S+ is the factor of the updated error covariance.
+     * The Kalman gain is K = Kb*Se^-1.
+     */
+    using array_t = Eigen::Matrix<real_t, T::l + T::n, T::l + T::n>;
+    array_t pre = array_t::Zero();
+    pre.template topLeftCorner<T::l, T::l>() = R_factor;
+    pre.template topRightCorner<T::l, T::n>().noalias() = m_system.Cd()*m_S;
+    pre.template bottomRightCorner<T::n, T::n>() = m_S;
+
+    Eigen::HouseholderQR<array_t> qr(pre.transpose());
+    const array_t post = qr.matrixQR().template triangularView<Eigen::Upper>().transpose();
+
+    m_K.noalias() = post.template topLeftCorner<T::l, T::l>().transpose().template
+        triangularView<Eigen::Upper>().solve(
+                post.template bottomLeftCorner<T::n, T::l>().transpose()).transpose();
+    m_S = post.template bottomRightCorner<T::n, T::n>();
+}
+
+template <typename T>
+template <typename M>
+M SquareRootKalman<T>::factor(const M& A) {
+    // A = P'*L*D*L'*P = F*F' with F = P'*L*D^1/2
+    Eigen::LDLT<M> ldlt(A);
+    M L = ldlt.matrixL();
+    L = L*ldlt.vectorD().cwiseMax(static_cast<real_t>(0)).cwiseSqrt().asDiagonal();
+    return ldlt.transpositionsP().transpose()*L;
+}
+
+} // namespace observer
@@ -0,0 +1,139 @@
+#include <cmath>
+#include "gtest/gtest.h"
+#include "allocation.h"
+#include "bicycle/whipple.h"
+#include "kalman.h"
+#include "lqr.h"
+#include "parameters.h"
+
+#include "flatbuffers/flatbuffers.h"
+#include "sample_generated.h"
+#include "sample_util.h" // only included in this file as it defines non-inline functions
+
+/*
+ * This test is built with BICYCLE_TRACK_ALLOCATIONS defined so that heap
+ * allocations are counted. The closed loop, including serialization of a sample
+ * with a reused builder, must not allocate after warmup.
+ */
+namespace {
+    using bicycle_t = model::BicycleWhipple;
+    using kalman_t = observer::Kalman<bicycle_t>;
+    using lqr_t = controller::Lqr<bicycle_t>;
+    using real_t = model::real_t;
+
+    const real_t dt = 1.0/200;
+    const size_t warmup_length = 10;
+    const size_t simulation_length = 1000;
+    const uint32_t horizon_length = 100;
+
+    int* volatile sink; // prevent allocation elision
+
+    void allocate() {
+        sink = new int(0);
+        delete sink;
+    }
+} // namespace
+
+TEST(Allocation, TrackingEnabled) {
+    EXPECT_TRUE(allocation::tracking_enabled());
+}
+
+TEST(Allocation, SectionCountsAllocations) {
+    allocation::RealtimeSection section("test", allocation::RealtimeSection::policy_t::count);
+    EXPECT_EQ(section.allocations(), 0u);
+    allocate();
+    EXPECT_EQ(section.allocations(), 1u);
+    {
+        allocation::RealtimeSection nested("nested", allocation::RealtimeSection::policy_t::count);
+        allocate();
+        EXPECT_EQ(nested.allocations(), 1u);
+    }
+    EXPECT_EQ(section.allocations(), 2u);
+}
+
+TEST(Allocation, SectionViolationCounted) {
+    const uint64_t violations = allocation::realtime_violations();
+    {
+        allocation::RealtimeSection section("test", allocation::RealtimeSection::policy_t::count);
+    }
+    EXPECT_EQ(allocation::realtime_violations(), violations);
+    {
+        allocation::RealtimeSection section("test", allocation::RealtimeSection::policy_t::count);
+        allocate();
+    }
+    EXPECT_EQ(allocation::realtime_violations(), violations + 1);
+}
+
+TEST(AllocationDeathTest, SectionAbortPolicy) {
+    EXPECT_DEATH({
+            allocation::RealtimeSection section("test",
+                    allocation::RealtimeSection::policy_t::abort);
+            allocate();
+        }, "realtime section 'test'");
+}
+
+class ClosedLoopAllocationTest: public ::testing::TestWithParam<real_t> { };
+
+TEST_P(ClosedLoopAllocationTest, NoAllocationAfterWarmup) {
+    const real_t v = GetParam();
+    bicycle_t::state_t x;
+    x << 0, 3, 5, 0, 0; // define x in degrees
+    x *= constants::as_radians;
+    bicycle_t::auxiliary_state_t aux = bicycle_t::auxiliary_state_t::Zero();
+
+    bicycle_t bicycle(v, dt);
+    kalman_t kalman(bicycle,
+            bicycle_t::state_t::Zero(),
+            parameters::defaultvalue::kalman::Q(dt),
+            parameters::defaultvalue::kalman::R,
+            std::pow(x[1]/2, 2) * bicycle_t::state_matrix_t::Identity());
+    lqr_t lqr(bicycle,
+            lqr_t::state_cost_t::Identity(),
+            0.1 * (lqr_t::input_cost_t() << 0, 0, 0, 1).finished(),
+            bicycle_t::state_t::Zero(), horizon_length);
+
+    flatbuffers::FlatBufferBuilder fbb;
+    uint64_t allocations = 0;
+    for (size_t i = 0; i < warmup_length + simulation_length; ++i) {
+        allocation::RealtimeSection section("closed loop",
+                allocation::RealtimeSection::policy_t::count);
+
+        auto u = lqr.control_calculate(kalman.x());
+
+        bicycle_t::full_state_t x_full = bicycle_t::make_full_state(aux, x);
+        x_full = bicycle.integrate_full_state(x_full, u, bicycle.dt());
+        aux = bicycle_t::get_auxiliary_state_part(x_full);
+        x = bicycle_t::get_state_part(x_full);
+
+        auto z = bicycle.calculate_output(x);
+        kalman.time_update(u);
+        kalman.measurement_update(z);
+
+        fbb.Clear();
+        auto kalman_location = fbs::create_kalman(fbb, kalman,
+                true, true, false, false, true); // x, P, Q, R, K
+        auto lqr_location = fbs::create_lqr(fbb, lqr,
+                false, true, true, false, false, true, // n, r, P, Q, R, K
+                false, true); // Qi, q
+        auto fbs_state = fbs::state(x);
+        auto fbs_input = fbs::input(u);
+        auto fbs_measurement = fbs::output(z);
+        auto fbs_auxiliary_state = fbs::auxiliary_state(aux);
+        fbb.Finish(fbs::CreateSample(fbb, static_cast<uint32_t>(i), 0,
+                    0, kalman_location, lqr_location,
+                    &fbs_state, &fbs_input, 0, &fbs_measurement,
+                    &fbs_auxiliary_state));
+
+        if (i >= warmup_length) {
+            allocations += section.allocations();
+        }
+    }
+    EXPECT_EQ(allocations, 0u);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    AllocationRange_1_9,
+    ClosedLoopAllocationTest,
+    ::testing::Values(static_cast<real_t>(1.0),
+        static_cast<real_t>(5.0),
+        static_cast<real_t>(9.0)));
@@ -0,0 +1,101 @@
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+#include "bicycle/batch.h"
+#include "bicycle/whipple.h"
+#include "test_utilities.h"
+
+namespace {
+    const model::real_t dt = 1.0/200;
+    const size_t batch_size = 37; // not a multiple of any SIMD width
+    const size_t simulation_length = 200;
+} // namespace
+
+class BicycleBatchTest : public ::testing::Test {
+    public:
+        virtual void SetUp() {
+            std::mt19937 gen(0);
+            std::uniform_real_distribution<> rv(0.5, 9.5);
+            std::uniform_real_distribution<> rk(0.9, 1.1);
+            std::normal_distribution<> rx(0, 0.05);
+
+            batch = std::unique_ptr<model::BicycleBatch>(new model::BicycleBatch(batch_size));
+            for (size_t i = 0; i < batch_size; ++i) {
+                bicycles.emplace_back(new model::BicycleWhipple(rv(gen), dt));
+                model::BicycleWhipple::second_order_matrix_t K2 = rk(gen)*bicycles.back()->K2();
+                bicycles.back()->set_K2(K2, true);
+
+                model::BicycleWhipple::state_t x;
+                x << rx(gen), rx(gen), rx(gen), rx(gen), rx(gen);
+                states.push_back(x);
+
+                batch->set_bicycle(i, *bicycles.back());
+                batch->set_state(i, x);
+            }
+        }
+
+    protected:
+        std::unique_ptr<model::BicycleBatch> batch;
+        std::vector<std::unique_ptr<model::BicycleWhipple>> bicycles;
+        std::vector<model::BicycleWhipple::state_t,
+            Eigen::aligned_allocator<model::BicycleWhipple::state_t>> states;
+};
+
+TEST_F(BicycleBatchTest, ZeroInput) {
+    for (size_t k = 0; k < simulation_length; ++k) {
+        batch->update_state();
+        for (size_t i = 0; i < batch_size; ++i) {
+            states[i] = bicycles[i]->update_state(states[i]);
+        }
+    }
+
+    for (size_t i = 0; i < batch_size; ++i) {
+        EXPECT_TRUE(test::allclose(batch->state(i), states[i], 1e-4, 1e-6))
+            << test::output_matrices(states[i], batch->state(i));
+    }
+}
+
+TEST_F(BicycleBatchTest, RandomSteerInput) {
+    std::mt19937 gen(1);
+    std::normal_distribution<> ru(0, 2); // Nm, steer torque
+
+    for (size_t k = 0; k < simulation_length; ++k) {
+        for (size_t i = 0; i < batch_size; ++i) {
+            model::BicycleWhipple::input_t u(0, ru(gen));
+            batch->set_input(i, u);
+            states[i] = bicycles[i]->update_state(states[i], u);
+        }
+        batch->update_state();
+    }
+
+    for (size_t i = 0; i < batch_size; ++i) {
+        EXPECT_TRUE(test::allclose(batch->state(i), states[i], 1e-4, 1e-6))
+            << test::output_matrices(states[i], batch->state(i));
+    }
+}
+
+TEST(BicycleBatch, DefaultUnchangingState) {
+    model::BicycleBatch batch(3);
+    batch.set_state_element(model::Bicycle::state_index_t::roll_angle, 0.1);
+    batch.set_input_element(model::Bicycle::input_index_t::steer_torque, 1.0);
+    batch.update_state(10);
+
+    model::BicycleBatch::state_t x;
+    x << 0, 0.1, 0, 0, 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(batch.state(i), x);
+    }
+}
+
+TEST(BicycleBatch, IndexOutOfRange) {
+    model::BicycleBatch batch(3);
+    model::BicycleWhipple bicycle(5.0, dt);
+    EXPECT_THROW(batch.set_bicycle(3, bicycle), std::out_of_range);
+    EXPECT_THROW(batch.set_state(3, model::BicycleBatch::state_t::Zero()), std::out_of_range);
+    EXPECT_THROW(batch.set_input(3, model::BicycleBatch::input_t::Zero()), std::out_of_range);
+    EXPECT_THROW(batch.state(3), std::out_of_range);
+    EXPECT_THROW(batch.input(3), std::out_of_range);
+    EXPECT_NO_THROW(batch.state(2));
+}
@@ -0,0 +1,149 @@
+#include <memory>
+#include "gtest/gtest.h"
+#include "test_convergence.h"
+#include "test_utilities.h"
+#include "gain_schedule.h"
+#include "scheduled_kalman.h"
+#include "scheduled_lqr.h"
+#include "parameters.h"
+
+namespace {
+    using schedule_t = model::GainSchedule<model::BicycleWhipple>;
+    const model::real_t v_min = 0.5;
+    const model::real_t v_max = 9.5;
+    const model::real_t dv = 0.25;
+} // namespace
+
+class GainScheduleTest: public ConvergenceTest {
+    public:
+        using scheduled_kalman_t = observer::ScheduledKalman<bicycle_t>;
+        using scheduled_lqr_t = controller::ScheduledLqr<bicycle_t>;
+
+        static void SetUpTestCase() {
+            bicycle_t bicycle(v_min, m_dt);
+            schedule_t::weights_t weights;
+            weights.lqr_Q = schedule_t::state_cost_t::Identity();
+            weights.lqr_R = 0.1 * (schedule_t::input_cost_t() << 0, 0, 0, 1).finished();
+            weights.lqr_Qi = schedule_t::state_cost_t::Zero();
+            weights.kalman_Q = parameters::defaultvalue::kalman::Q(m_dt);
+            weights.kalman_R = parameters::defaultvalue::kalman::R;
+            m_schedule = new schedule_t();
+            m_schedule->generate(bicycle, v_min, v_max, dv, weights);
+        }
+        static void TearDownTestCase() {
+            delete m_schedule;
+            m_schedule = nullptr;
+        }
+        void SetUp() {
+            ConvergenceTest::SetUp();
+            m_scheduled_kalman = std::unique_ptr<scheduled_kalman_t>(
+                    new scheduled_kalman_t(*m_bicycle, *m_schedule));
+            m_scheduled_lqr = std::unique_ptr<scheduled_lqr_t>(
+                    new scheduled_lqr_t(*m_bicycle, *m_schedule));
+        }
+        void simulate(size_t N = default_simulation_length) {
+            for(unsigned int i = 0; i < N; ++i) {
+                auto u = m_scheduled_lqr->control_calculate(m_scheduled_kalman->x());
+                m_x = m_bicycle->update_state(m_x, u);
+
+                auto z = m_bicycle->calculate_output(m_x);
+                z(0) += m_r0(m_gen);
+                z(1) += m_r1(m_gen);
+
+                m_scheduled_kalman->update_state(u, z);
+            }
+        }
+
+        // Lqr gain only contains rows for inputs with nonzero cost (steer torque)
+        static schedule_t::lqr_gain_t full_gain(const lqr_t::lqr_gain_t& K) {
+            schedule_t::lqr_gain_t full = schedule_t::lqr_gain_t::Zero();
+            full.row(1) = K.row(0);
+            return full;
+        }
+
+    protected:
+        static schedule_t* m_schedule;
+        std::unique_ptr<scheduled_kalman_t> m_scheduled_kalman;
+        std::unique_ptr<scheduled_lqr_t> m_scheduled_lqr;
+};
+
+schedule_t* GainScheduleTest::m_schedule = nullptr;
+
+TEST_P(GainScheduleTest, LqrGainMatchesSteadyState) {
+    // parameters are grid points
+    m_lqr->set_solver(lqr_t::solver_t::riccati_doubling);
+    m_lqr->control_calculate(m_x);
+
+    EXPECT_TRUE(m_scheduled_lqr->K().isApprox(full_gain(m_lqr->K()), 1e-6)) <<
+        test::output_matrices(full_gain(m_lqr->K()), m_scheduled_lqr->K());
+    EXPECT_TRUE(m_scheduled_lqr->Ki().isZero());
+}
+
+TEST_P(GainScheduleTest, KalmanGainMatchesSteadyState) {
+    for(unsigned int i = 0; i < 10000; ++i) {
+        m_kalman->time_update();
+        m_kalman->measurement_update(kalman_t::measurement_t::Zero());
+    }
+
+    EXPECT_TRUE(m_scheduled_kalman->K().isApprox(m_kalman->K(), 1e-4)) <<
+        test::output_matrices(m_kalman->K(), m_scheduled_kalman->K());
+    EXPECT_TRUE(m_scheduled_kalman->P().isApprox(m_kalman->P(), 1e-4)) <<
+        test::output_matrices(m_kalman->P(), m_scheduled_kalman->P());
+}
+
+TEST_P(GainScheduleTest, InterpolatedGain) {
+    // gain between grid points must be close to the exact gain,
+    // interpolation error is largest at low speeds where the gain changes quickly
+    m_bicycle->set_v(GetParam() + dv/2);
+    m_lqr->set_solver(lqr_t::solver_t::riccati_doubling);
+    m_lqr->control_calculate(m_x);
+    m_scheduled_lqr->control_calculate(m_x);
+
+    EXPECT_TRUE(m_scheduled_lqr->K().isApprox(full_gain(m_lqr->K()), 1e-1)) <<
+        test::output_matrices(full_gain(m_lqr->K()), m_scheduled_lqr->K());
+}
+
+TEST_P(GainScheduleTest, ZeroReference) {
+    simulate();
+    test_state_near(m_scheduled_kalman->x(), x_true());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    GainScheduleRange_1_9,
+    GainScheduleTest,
+    ::testing::Range(static_cast<model::real_t>(0.5),
+        static_cast<model::real_t>(9.5),
+        static_cast<model::real_t>(0.5)));
+
+TEST(GainSchedule, ClampedOutsideRange) {
+    const schedule_t::lqr_gain_t K0 = schedule_t::lqr_gain_t::Constant(1);
+    const schedule_t::lqr_gain_t K1 = schedule_t::lqr_gain_t::Constant(3);
+    schedule_t::entry_vector_t entries(2);
+    entries[0].lqr_K = K0;
+    entries[0].lqr_Ki = K0;
+    entries[1].lqr_K = K1;
+    entries[1].lqr_Ki = K1;
+
+    schedule_t schedule;
+    schedule.set(1.0, 2.0, 0.005, schedule_t::weights_t(), entries);
+    EXPECT_EQ(schedule.v_max(), 3.0);
+
+    schedule_t::lqr_gain_t K;
+    schedule_t::lqr_gain_t Ki;
+    schedule.lqr_gain(2.0, &K, &Ki);
+    EXPECT_TRUE(K.isApprox(schedule_t::lqr_gain_t::Constant(2)));
+    schedule.lqr_gain(0.0, &K, &Ki);
+    EXPECT_TRUE(K.isApprox(K0));
+    schedule.lqr_gain(10.0, &K, &Ki);
+    EXPECT_TRUE(K.isApprox(K1));
+}
+
+TEST(GainSchedule, SamplingTimeMismatch) {
+    schedule_t schedule;
+    schedule.set(1.0, 2.0, 0.005, schedule_t::weights_t(), schedule_t::entry_vector_t(2));
+    model::BicycleWhipple bicycle(1.0, 0.01);
+    EXPECT_THROW(controller::ScheduledLqr<model::BicycleWhipple>(bicycle, schedule),
+            std::invalid_argument);
+    EXPECT_THROW(observer::ScheduledKalman<model::BicycleWhipple>(bicycle, schedule),
+            std::invalid_argument);
+}
@@ -1,5 +1,7 @@
+#include <type_traits>
 #include "gtest/gtest.h"
 #include "test_convergence.h"
+#include "test_utilities.h"
 #include <boost/math/constants/constants.hpp>
 
 // TODO: test estimation with model error
@@ -85,3 +87,153 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Range(static_cast<model::real_t>(1.0),
         static_cast<model::real_t>(3.0),
         static_cast<model::real_t>(0.5)));
+
+class KalmanSteadyStateTest: public KalmanConvergenceTest {
+    public:
+        void SetUp() {
+            KalmanConvergenceTest::SetUp();
+            m_kalman_full = new kalman_t(*m_kalman);
+            m_kalman->set_steady_state_mode(true);
+        }
+        void TearDown() {
+            KalmanConvergenceTest::TearDown();
+            delete m_kalman_full;
+            m_kalman_full = nullptr;
+        }
+        // the bicycle is unstable at low speeds so only measurement noise is simulated
+        void simulate_filters(size_t N = steady_state_simulation_length) {
+            for (unsigned int i = 0; i < N; ++i) {
+                bicycle_t::output_t z;
+                z << m_r0(m_gen), m_r1(m_gen);
+
+                m_kalman->time_update();
+                m_kalman->measurement_update(z);
+                m_kalman_full->time_update();
+                m_kalman_full->measurement_update(z);
+            }
+        }
+        void test_matches_full_update() {
+            // convergence is slow and detected earlier with the single precision tolerance
+            const model::real_t tol = std::is_same<model::real_t, float>::value ? 1e-2 : 1e-4;
+            EXPECT_TRUE(m_kalman->K().isApprox(m_kalman_full->K(), tol)) <<
+                test::output_matrices(m_kalman_full->K(), m_kalman->K());
+            EXPECT_TRUE(m_kalman->P().isApprox(m_kalman_full->P(), tol)) <<
+                test::output_matrices(m_kalman_full->P(), m_kalman->P());
+        }
+
+    protected:
+        static const size_t steady_state_simulation_length;
+        kalman_t* m_kalman_full;
+};
+
+const size_t KalmanSteadyStateTest::steady_state_simulation_length = 10000;
+
+TEST_P(KalmanSteadyStateTest, ConvergenceDetected) {
+    EXPECT_FALSE(m_kalman->steady_state());
+    EXPECT_EQ(m_kalman->steady_state_updates(), 0u);
+
+    simulate_filters();
+    EXPECT_TRUE(m_kalman->steady_state());
+    EXPECT_GT(m_kalman->steady_state_updates(), 0u);
+    EXPECT_LT(m_kalman->steady_state_updates(), steady_state_simulation_length);
+    EXPECT_LE(m_kalman->error_covariance_change(),
+            Eigen::NumTraits<model::real_t>::dummy_precision());
+    test_matches_full_update();
+}
+
+TEST_P(KalmanSteadyStateTest, MatchesFullUpdate) {
+    simulate_filters(2*steady_state_simulation_length);
+
+    EXPECT_TRUE(m_kalman->steady_state());
+    test_matches_full_update();
+    const model::real_t tol = std::is_same<model::real_t, float>::value ? 1e-1 : 1e-4;
+    EXPECT_TRUE(m_kalman->x().isApprox(m_kalman_full->x(), tol)) <<
+        test::output_matrices(m_kalman_full->x(), m_kalman->x());
+}
+
+TEST_P(KalmanSteadyStateTest, SpeedChange) {
+    simulate_filters();
+    ASSERT_TRUE(m_kalman->steady_state());
+
+    m_bicycle->set_v(GetParam() + 0.5);
+    simulate_filters(1);
+    EXPECT_FALSE(m_kalman->steady_state());
+    EXPECT_EQ(m_kalman->steady_state_updates(), 1u);
+
+    simulate_filters();
+    EXPECT_TRUE(m_kalman->steady_state());
+    test_matches_full_update();
+}
+
+TEST_P(KalmanSteadyStateTest, UnchangedSystem) {
+    simulate_filters();
+    ASSERT_TRUE(m_kalman->steady_state());
+
+    m_bicycle->set_v(GetParam());
+    simulate_filters(1);
+    EXPECT_TRUE(m_kalman->steady_state());
+}
+
+TEST_P(KalmanSteadyStateTest, ExplicitNoiseCovariance) {
+    simulate_filters();
+    ASSERT_TRUE(m_kalman->steady_state());
+
+    m_kalman->measurement_update(bicycle_t::output_t::Zero(), m_kalman->R());
+    EXPECT_FALSE(m_kalman->steady_state());
+    EXPECT_EQ(m_kalman->steady_state_updates(), 0u);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ConvergenceRange_1_9,
+    KalmanSteadyStateTest,
+    ::testing::Range(static_cast<model::real_t>(0.5),
+        static_cast<model::real_t>(9.5),
+        static_cast<model::real_t>(0.5)));
+
+class KalmanStructureTest: public KalmanConvergenceTest {
+    public:
+        // compare with the dense time and measurement update equations
+        void test_matches_dense_update(size_t N = default_simulation_length) {
+            const bicycle_t::state_matrix_t& Ad = m_bicycle->Ad();
+            const bicycle_t::output_matrix_t& Cd = m_bicycle->Cd();
+            bicycle_t::state_matrix_t P = m_kalman->P();
+            kalman_t::kalman_gain_t K = kalman_t::kalman_gain_t::Zero();
+            for (unsigned int i = 0; i < N; ++i) {
+                bicycle_t::output_t z;
+                z << m_r0(m_gen), m_r1(m_gen);
+                m_kalman->time_update();
+                m_kalman->measurement_update(z);
+
+                P = Ad*P*Ad.transpose() + m_kalman->Q();
+                K = P*Cd.transpose()*(Cd*P*Cd.transpose() + m_kalman->R()).inverse();
+                P = (bicycle_t::state_matrix_t::Identity() - K*Cd)*P;
+                P = (P + P.transpose())/2;
+            }
+            // rounding error differs as the structured update performs fewer operations
+            const model::real_t tol = std::is_same<model::real_t, float>::value ? 1e-3 : 1e-9;
+            EXPECT_TRUE(m_kalman->K().isApprox(K, tol)) <<
+                test::output_matrices(K, m_kalman->K());
+            EXPECT_TRUE(m_kalman->P().isApprox(P, tol)) <<
+                test::output_matrices(P, m_kalman->P());
+            EXPECT_TRUE(m_kalman->P().isApprox(m_kalman->P().transpose()));
+        }
+};
+
+TEST_P(KalmanStructureTest, SelectionOutputMatrix) {
+    test_matches_dense_update();
+}
+
+TEST_P(KalmanStructureTest, GeneralOutputMatrix) {
+    bicycle_t::output_matrix_t C;
+    C << 1, 0.5, 0, 0, 0,
+         0, 0, 1, 0, 0.1;
+    m_bicycle->set_C(C);
+    test_matches_dense_update();
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ConvergenceRange_1_9,
+    KalmanStructureTest,
+    ::testing::Range(static_cast<model::real_t>(0.5),
+        static_cast<model::real_t>(9.5),
+        static_cast<model::real_t>(0.5)));
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "test_convergence.h"
 #include "constants.h"
+#include "test_utilities.h"
 
 // TODO: Add convergence with model error
 class LqrTrackingTest: public ConvergenceTest {
@@ -69,3 +70,85 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Range(static_cast<model::real_t>(0.5),
         static_cast<model::real_t>(9.5),
         static_cast<model::real_t>(0.5)));
+
+class LqrRiccatiDoublingTest: public ConvergenceTest {
+    public:
+        void SetUp() {
+            ConvergenceTest::SetUp();
+            m_lqr->set_solver(lqr_t::solver_t::riccati_doubling);
+        }
+        void simulate(size_t N = default_simulation_length) {
+            for(unsigned int i = 0; i < N; ++i) {
+                auto u = m_lqr->control_calculate(m_x);
+                m_x = m_bicycle->update_state(m_x, u);
+            }
+        }
+        lqr_t value_iteration_lqr() {
+            return lqr_t(*m_bicycle, m_lqr->Q(), m_lqr->R(), m_lqr->r(),
+                    m_lqr->horizon_iterations(), m_lqr->Qi());
+        }
+};
+
+TEST_P(LqrRiccatiDoublingTest, ClosedLoopMatchesValueIteration) {
+    lqr_t lqr = value_iteration_lqr();
+    bicycle_t::state_t x = m_x;
+    // value iteration gain must reach steady state before trajectories can match
+    for(unsigned int i = 0; i < 1000; ++i) {
+        lqr.control_calculate(x);
+    }
+    for(unsigned int i = 0; i < default_simulation_length; ++i) {
+        x = m_bicycle->update_state(x, lqr.control_calculate(x));
+    }
+    simulate();
+    test_state_near(x_true(), x);
+}
+
+TEST_P(LqrRiccatiDoublingTest, SteadyStateGain) {
+    lqr_t lqr = value_iteration_lqr();
+    for(unsigned int i = 0; i < 1000; ++i) {
+        lqr.control_calculate(m_x);
+    }
+    m_lqr->control_calculate(m_x);
+
+    EXPECT_TRUE(m_lqr->P().isApprox(lqr.P(), 1e-3)) << test::output_matrices(lqr.P(), m_lqr->P());
+    EXPECT_TRUE(m_lqr->K().isApprox(lqr.K(), 1e-3)) << test::output_matrices(lqr.K(), m_lqr->K());
+}
+
+TEST_P(LqrRiccatiDoublingTest, SpeedChange) {
+    m_lqr->control_calculate(m_x);
+    m_bicycle->set_v(GetParam() + 0.1);
+    m_lqr->control_calculate(m_x);
+
+    lqr_t lqr = value_iteration_lqr();
+    lqr.set_solver(lqr_t::solver_t::riccati_doubling);
+    lqr.control_calculate(m_x);
+    EXPECT_TRUE(m_lqr->K().isApprox(lqr.K(), 1e-4)) << test::output_matrices(lqr.K(), m_lqr->K());
+}
+
+TEST_P(LqrRiccatiDoublingTest, IntegralActionZeroReference) {
+    m_lqr->set_Qi((bicycle_t::state_t() <<
+                10.0, 1.0, 1.0, 0.0, 0.0).finished().asDiagonal() *
+            constants::as_radians);
+    simulate();
+    test_state_near(x_true(), bicycle_t::state_t::Zero());
+}
+
+TEST_P(LqrRiccatiDoublingTest, YawIntegralSteadyStateGain) {
+    m_lqr->set_Qi((bicycle_t::state_t() <<
+                10.0, 0.0, 0.0, 0.0, 0.0).finished().asDiagonal() *
+            constants::as_radians);
+    lqr_t lqr = value_iteration_lqr();
+    for(unsigned int i = 0; i < 1000; ++i) {
+        lqr.control_calculate(m_x);
+    }
+    m_lqr->control_calculate(m_x);
+    EXPECT_TRUE(m_lqr->K().isApprox(lqr.K(), 1e-3)) << test::output_matrices(lqr.K(), m_lqr->K());
+    EXPECT_TRUE(m_lqr->Ki().isApprox(lqr.Ki(), 1e-3)) << test::output_matrices(lqr.Ki(), m_lqr->Ki());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    RiccatiDoublingRange_1_9,
+    LqrRiccatiDoublingTest,
+    ::testing::Range(static_cast<model::real_t>(0.5),
+        static_cast<model::real_t>(9.5),
+        static_cast<model::real_t>(0.5)));
@@ -0,0 +1,90 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "gtest/gtest.h"
+#include "network_batch_server.h"
+
+namespace {
+    const uint16_t port_a = 9920;
+    const uint16_t port_b = 9921;
+    const size_t sources = 3;
+    const size_t frames_per_source = 100; // more frames than a single batch
+    using state_t = std::array<double, 5>;
+} // namespace
+
+TEST(NetworkFrame, RoundTrip) {
+    const state_t state = {1.0, -2.0, 3.5, 0.0, 1e-9};
+    std::array<uint8_t, network::udp::max_frame_size> buffer;
+    const network::udp::frame_header_t header{
+        network::udp::frame_t::state, 7, sizeof(state), 0xdeadbeef};
+    const size_t size = network::udp::encode_frame(header,
+            reinterpret_cast<const uint8_t*>(state.data()), buffer.data());
+    EXPECT_EQ(network::udp::frame_header_size + sizeof(state), size);
+
+    network::udp::frame_header_t decoded;
+    const uint8_t* payload;
+    ASSERT_TRUE(network::udp::decode_frame(buffer.data(), size, &decoded, &payload));
+    EXPECT_EQ(header.type, decoded.type);
+    EXPECT_EQ(header.source, decoded.source);
+    EXPECT_EQ(header.size, decoded.size);
+    EXPECT_EQ(header.sequence, decoded.sequence);
+    EXPECT_EQ(0, std::memcmp(state.data(), payload, sizeof(state)));
+}
+
+TEST(NetworkFrame, Invalid) {
+    const state_t state = {};
+    std::array<uint8_t, network::udp::max_frame_size> buffer;
+    const network::udp::frame_header_t header{
+        network::udp::frame_t::state, 0, sizeof(state), 0};
+    const size_t size = network::udp::encode_frame(header,
+            reinterpret_cast<const uint8_t*>(state.data()), buffer.data());
+
+    network::udp::frame_header_t decoded;
+    const uint8_t* payload;
+    EXPECT_FALSE(network::udp::decode_frame(buffer.data(), size - 1, &decoded, &payload));
+    EXPECT_FALSE(network::udp::decode_frame(buffer.data(), network::udp::frame_header_size - 1,
+                &decoded, &payload));
+    buffer[0] = static_cast<uint8_t>(network::udp::frame_t::number_of_types);
+    EXPECT_FALSE(network::udp::decode_frame(buffer.data(), size, &decoded, &payload));
+}
+
+TEST(BatchServer, Loopback) {
+    std::array<uint32_t, sources> next_sequence = {};
+    std::atomic<bool> in_order(true);
+    network::udp::BatchServer receiver(port_b, port_a,
+            [&next_sequence, &in_order](const network::udp::frame_header_t& header,
+                const uint8_t* payload) {
+                state_t state;
+                std::memcpy(state.data(), payload, sizeof(state));
+                if ((header.type != network::udp::frame_t::state) ||
+                        (header.size != sizeof(state)) ||
+                        (header.sequence != next_sequence[header.source]++) ||
+                        (state[0] != header.source) || (state[1] != header.sequence)) {
+                    in_order = false;
+                }
+            });
+    network::udp::BatchServer sender(port_a, port_b);
+
+    for (size_t i = 0; i < frames_per_source; ++i) {
+        for (size_t s = 0; s < sources; ++s) {
+            const state_t state = {static_cast<double>(s), static_cast<double>(i)};
+            sender.async_send(network::udp::frame_t::state, static_cast<uint8_t>(s),
+                    asio::buffer(state));
+        }
+    }
+    sender.wait_for_send_complete();
+    EXPECT_EQ(sources*frames_per_source, sender.send_count());
+    EXPECT_EQ(0u, sender.send_dropped_count());
+
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((receiver.receive_count() < sources*frames_per_source) &&
+            (std::chrono::steady_clock::now() < timeout)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(sources*frames_per_source, receiver.receive_count());
+    EXPECT_EQ(0u, receiver.lost_count());
+    EXPECT_EQ(0u, receiver.invalid_count());
+    EXPECT_TRUE(in_order);
+}
@@ -0,0 +1,108 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "sample_delta.h"
+
+namespace {
+    const size_t keyframe_interval = 4;
+    const size_t count = 10;
+
+    /* the error covariance changes every third sample, the gain is constant */
+    fbs::SymmetricStateMatrix error_covariance(size_t i) {
+        const double p = static_cast<double>(i/3);
+        return fbs::SymmetricStateMatrix(p, 0, 0, 0, 0, p, 0, 0, 0, p, 0, 0, p, 0, p);
+    }
+
+    fbs::KalmanGainMatrix kalman_gain() {
+        return fbs::KalmanGainMatrix(1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+    }
+
+    /* encode samples and return them as separate buffers */
+    std::vector<std::vector<uint8_t>> encode(size_t* serialized_fields) {
+        std::vector<std::vector<uint8_t>> samples;
+        fbs::SampleDeltaEncoder encoder(keyframe_interval);
+        *serialized_fields = 0;
+        for (size_t i = 0; i < count; ++i) {
+            flatbuffers::FlatBufferBuilder fbb;
+            encoder.next_sample();
+            const auto P = error_covariance(i);
+            const auto K = kalman_gain();
+            const bool write_P = encoder.update(fbs::delta_field_t::kalman_error_covariance, P);
+            const bool write_K = encoder.update(fbs::delta_field_t::kalman_gain, K);
+            *serialized_fields += write_P + write_K;
+            auto kalman = fbs::CreateKalman(fbb, nullptr,
+                    write_P ? &P : nullptr, nullptr, nullptr, write_K ? &K : nullptr);
+            fbb.Finish(fbs::CreateSample(fbb, static_cast<uint32_t>(i), 0, 0, kalman,
+                        0, 0, 0, 0, 0, 0, !encoder.keyframe()));
+            samples.emplace_back(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+        }
+        return samples;
+    }
+
+    void expect_decoded(const fbs::SampleDeltaDecoder& decoder, size_t i) {
+        const auto P = decoder.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::kalman_error_covariance);
+        const auto K = decoder.get<fbs::KalmanGainMatrix>(fbs::delta_field_t::kalman_gain);
+        ASSERT_NE(nullptr, P);
+        ASSERT_NE(nullptr, K);
+        EXPECT_EQ(error_covariance(i).q00(), P->q00());
+        EXPECT_EQ(error_covariance(i).q44(), P->q44());
+        EXPECT_EQ(kalman_gain().k41(), K->k41());
+        EXPECT_EQ(nullptr, decoder.get<fbs::State>(fbs::delta_field_t::kalman_state_estimate));
+    }
+} // namespace
+
+TEST(SampleDelta, UnchangedFieldsAreOmitted) {
+    size_t serialized_fields;
+    const auto samples = encode(&serialized_fields);
+    EXPECT_LT(serialized_fields, 2*count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto sample = flatbuffers::GetRoot<fbs::Sample>(samples[i].data());
+        EXPECT_EQ((i % keyframe_interval) != 0, sample->delta());
+        if (!sample->delta()) {
+            EXPECT_NE(nullptr, sample->kalman()->error_covariance());
+            EXPECT_NE(nullptr, sample->kalman()->kalman_gain());
+        }
+    }
+}
+
+TEST(SampleDelta, DecodeFromStart) {
+    size_t serialized_fields;
+    const auto samples = encode(&serialized_fields);
+    fbs::SampleDeltaDecoder decoder;
+    for (size_t i = 0; i < count; ++i) {
+        decoder.update(flatbuffers::GetRoot<fbs::Sample>(samples[i].data()));
+        expect_decoded(decoder, i);
+    }
+}
+
+TEST(SampleDelta, DecodeFromKeyframe) {
+    size_t serialized_fields;
+    const auto samples = encode(&serialized_fields);
+    fbs::SampleDeltaDecoder decoder;
+    for (size_t i = keyframe_interval; i < count; ++i) {
+        decoder.update(flatbuffers::GetRoot<fbs::Sample>(samples[i].data()));
+        expect_decoded(decoder, i);
+    }
+}
+
+TEST(SampleDelta, CreateSample) {
+    size_t serialized_fields;
+    const auto samples = encode(&serialized_fields);
+    fbs::SampleDeltaDecoder decoder;
+    for (size_t i = 0; i < count; ++i) {
+        const auto sample = flatbuffers::GetRoot<fbs::Sample>(samples[i].data());
+        decoder.update(sample);
+
+        flatbuffers::FlatBufferBuilder fbb;
+        fbb.Finish(decoder.create_sample(fbb, sample));
+        const auto full = flatbuffers::GetRoot<fbs::Sample>(fbb.GetBufferPointer());
+        EXPECT_FALSE(full->delta());
+        EXPECT_EQ(i, full->timestamp());
+        ASSERT_NE(nullptr, full->kalman());
+        ASSERT_NE(nullptr, full->kalman()->error_covariance());
+        ASSERT_NE(nullptr, full->kalman()->kalman_gain());
+        EXPECT_EQ(error_covariance(i).q22(), full->kalman()->error_covariance()->q22());
+        EXPECT_EQ(kalman_gain().k00(), full->kalman()->kalman_gain()->k00());
+        EXPECT_EQ(nullptr, full->lqr());
+    }
+}
@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "gtest/gtest.h"
+#include "sample_log_compression.h"
+#include "sample_log_reader.h"
+#include "sample_log_writer.h"
+
+namespace {
+    const char* filename = "test_sample_log_reader.bin";
+    const size_t count = 100;
+
+    void write_stream(bool with_footer,
+            fbs::SampleLogWriter::compression_t compression = fbs::SampleLogWriter::compression_t::none) {
+        fbs::SampleLogWriter writer(filename, count, std::chrono::milliseconds(10), 16, compression);
+        for (size_t i = 0; i < count; ++i) {
+            flatbuffers::FlatBufferBuilder* builder = writer.acquire();
+            ASSERT_NE(nullptr, builder);
+            builder->Finish(fbs::CreateSample(*builder, static_cast<uint32_t>(i), 0.5*i));
+            writer.commit();
+        }
+        writer.close();
+
+        if (!with_footer) {
+            // remove the footer and truncate the last record
+            std::FILE* f = std::fopen(filename, "rb");
+            std::vector<uint8_t> buffer;
+            int c;
+            while ((c = std::fgetc(f)) != EOF) {
+                buffer.push_back(static_cast<uint8_t>(c));
+            }
+            std::fclose(f);
+            const size_t footer_size = 8*2 + 4 + 4 + 8*((count + 15)/16);
+            buffer.resize(buffer.size() - footer_size - 1);
+            f = std::fopen(filename, "wb");
+            std::fwrite(buffer.data(), sizeof(uint8_t), buffer.size(), f);
+            std::fclose(f);
+        }
+    }
+
+    void write_container() {
+        flatbuffers::FlatBufferBuilder builder;
+        flatbuffers::FlatBufferBuilder log_builder;
+        std::vector<flatbuffers::Offset<fbs::SampleBuffer>> sample_locations;
+        for (size_t i = 0; i < count; ++i) {
+            builder.Clear();
+            builder.Finish(fbs::CreateSample(builder, static_cast<uint32_t>(i), 0.5*i));
+            auto data = log_builder.CreateVector(builder.GetBufferPointer(), builder.GetSize());
+            sample_locations.push_back(fbs::CreateSampleBuffer(log_builder, data));
+        }
+        auto samples_vector = log_builder.CreateVector(sample_locations);
+        log_builder.Finish(fbs::CreateSampleLog(log_builder, samples_vector), fbs::SampleLogIdentifier());
+
+        std::FILE* f = std::fopen(filename, "wb");
+        std::fwrite(log_builder.GetBufferPointer(), sizeof(uint8_t), log_builder.GetSize(), f);
+        std::fclose(f);
+    }
+
+    void expect_samples(const fbs::SampleLogReader& reader, size_t expected_count) {
+        ASSERT_EQ(expected_count, reader.size());
+        // random access in reverse order
+        for (size_t i = expected_count; i-- > 0;) {
+            EXPECT_EQ(i, reader.sample(i)->timestamp());
+            EXPECT_DOUBLE_EQ(0.5*i, reader.sample(i)->computation_time());
+        }
+    }
+} // namespace
+
+TEST(SampleLogReader, Stream) {
+    write_stream(true);
+    {
+        const fbs::SampleLogReader reader(filename);
+        EXPECT_EQ(fbs::SampleLogReader::format_t::stream, reader.format());
+        expect_samples(reader, count);
+        // samples are read in place and must be aligned for their doubles
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(reader.data(i)) % alignof(double));
+        }
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogReader, StreamWithoutFooter) {
+    write_stream(false);
+    {
+        const fbs::SampleLogReader reader(filename);
+        EXPECT_EQ(fbs::SampleLogReader::format_t::stream, reader.format());
+        expect_samples(reader, count - 1);
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogReader, CompressedStream) {
+    write_stream(true, fbs::SampleLogWriter::compression_t::block);
+    {
+        const fbs::SampleLogReader reader(filename);
+        EXPECT_EQ(fbs::SampleLogReader::format_t::compressed_stream, reader.format());
+        // more blocks than cached so blocks are decoded again
+        expect_samples(reader, count);
+        expect_samples(reader, count);
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogReader, CompressedStreamWithoutFooter) {
+    write_stream(false, fbs::SampleLogWriter::compression_t::block);
+    {
+        // the truncated last block is dropped
+        const fbs::SampleLogReader reader(filename);
+        EXPECT_EQ(fbs::SampleLogReader::format_t::compressed_stream, reader.format());
+        expect_samples(reader, 16*(count/16));
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogReader, Container) {
+    write_container();
+    {
+        const fbs::SampleLogReader reader(filename);
+        EXPECT_EQ(fbs::SampleLogReader::format_t::container, reader.format());
+        expect_samples(reader, count);
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogReader, ForEachRangeStride) {
+    write_stream(true);
+    {
+        const fbs::SampleLogReader reader(filename);
+        std::vector<size_t> indices;
+        reader.for_each(10, 2*count, 7, [&indices](size_t index, const fbs::Sample* sample) {
+                    EXPECT_EQ(index, sample->timestamp());
+                    indices.push_back(index);
+                });
+        ASSERT_EQ((count - 10 + 6)/7, indices.size());
+        EXPECT_EQ(10u, indices.front());
+        EXPECT_EQ(10 + 7*(indices.size() - 1), indices.back());
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogCompression, RoundTrip) {
+    std::vector<uint32_t> sizes;
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i < count; ++i) {
+        flatbuffers::FlatBufferBuilder builder;
+        builder.Finish(fbs::CreateSample(builder, static_cast<uint32_t>(i), 0.5*i));
+        sizes.push_back(builder.GetSize());
+        data.insert(data.end(), builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    }
+    sizes.push_back(3); // record with a size that is not a multiple of 8
+    data.insert(data.end(), {0, 0, 1});
+
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> scratch;
+    fbs::compression::encode_block(sizes, data.data(), &encoded, &scratch);
+    EXPECT_LT(encoded.size(), data.size());
+
+    std::vector<uint32_t> decoded_sizes;
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(fbs::compression::decode_block(encoded.data(), encoded.size(),
+                &decoded_sizes, &decoded, &scratch));
+    EXPECT_EQ(sizes, decoded_sizes);
+    EXPECT_EQ(data, decoded);
+
+    EXPECT_FALSE(fbs::compression::decode_block(encoded.data(), encoded.size() - 1,
+                &decoded_sizes, &decoded, &scratch));
+}
@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "sample_log_writer.h"
+
+namespace {
+    const char* filename = "test_sample_log_writer.bin";
+
+    std::vector<uint8_t> read_file() {
+        std::vector<uint8_t> buffer;
+        std::FILE* f = std::fopen(filename, "rb");
+        if (f == nullptr) {
+            return buffer;
+        }
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = std::fread(chunk, sizeof(uint8_t), sizeof(chunk), f)) > 0) {
+            buffer.insert(buffer.end(), chunk, chunk + n);
+        }
+        std::fclose(f);
+        return buffer;
+    }
+
+    template <typename T>
+    T read_scalar(const std::vector<uint8_t>& buffer, size_t offset) {
+        T value;
+        std::memcpy(&value, buffer.data() + offset, sizeof(T));
+        return flatbuffers::EndianScalar(value);
+    }
+
+    std::string record_string(const std::vector<uint8_t>& buffer, size_t offset) {
+        const uint8_t* data = buffer.data() + offset + 2*sizeof(uint32_t);
+        return flatbuffers::GetRoot<flatbuffers::String>(data)->str();
+    }
+
+    void write_samples(fbs::SampleLogWriter& writer, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            flatbuffers::FlatBufferBuilder* builder = writer.acquire();
+            while (builder == nullptr) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                builder = writer.acquire();
+            }
+            builder->Finish(builder->CreateString(std::to_string(i)));
+            writer.commit();
+        }
+    }
+} // namespace
+
+TEST(SampleLogWriter, RecordsAndFooter) {
+    static constexpr size_t count = 100;
+    static constexpr size_t index_interval = 16;
+    {
+        fbs::SampleLogWriter writer(filename, 8, std::chrono::milliseconds(10), index_interval);
+        write_samples(writer, count);
+        writer.close();
+        EXPECT_EQ(count, writer.samples_written());
+        EXPECT_FALSE(writer.error());
+    }
+    const std::vector<uint8_t> buffer = read_file();
+    ASSERT_GT(buffer.size(), 4*sizeof(uint64_t));
+
+    // footer
+    const size_t end = buffer.size();
+    EXPECT_EQ(0, std::memcmp(buffer.data() + end - 4, fbs::SampleLogWriter::index_identifier, 4));
+    const uint32_t index_count = read_scalar<uint32_t>(buffer, end - 8);
+    const uint64_t samples = read_scalar<uint64_t>(buffer, end - 16);
+    const uint64_t interval = read_scalar<uint64_t>(buffer, end - 24);
+    EXPECT_EQ(count, samples);
+    EXPECT_EQ(index_interval, interval);
+    ASSERT_EQ((count + index_interval - 1)/index_interval, index_count);
+    const size_t index_begin = end - 24 - index_count*sizeof(uint64_t);
+
+    // records are written in order, aligned, and end where the footer starts
+    static constexpr size_t alignment = fbs::SampleLogWriter::record_alignment;
+    std::vector<uint64_t> offsets;
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_LT(offset, index_begin);
+        EXPECT_EQ(0u, offset % alignment);
+        offsets.push_back(offset);
+        EXPECT_EQ(std::to_string(i), record_string(buffer, offset));
+        const uint32_t size = read_scalar<uint32_t>(buffer, offset);
+        offset += 2*sizeof(uint32_t) + (size + alignment - 1)/alignment*alignment;
+    }
+    EXPECT_EQ(index_begin, offset);
+
+    for (size_t i = 0; i < index_count; ++i) {
+        const uint64_t indexed_offset = read_scalar<uint64_t>(buffer, index_begin + i*sizeof(uint64_t));
+        EXPECT_EQ(offsets[i*index_interval], indexed_offset);
+        EXPECT_EQ(std::to_string(i*index_interval), record_string(buffer, indexed_offset));
+    }
+    std::remove(filename);
+}
+
+TEST(SampleLogWriter, DropWhenRingFull) {
+    static constexpr size_t ring_size = 4;
+    fbs::SampleLogWriter writer(filename, ring_size);
+
+    // acquire without commit returns the same builder
+    flatbuffers::FlatBufferBuilder* builder = writer.acquire();
+    ASSERT_NE(nullptr, builder);
+    EXPECT_EQ(builder, writer.acquire());
+    builder->Finish(builder->CreateString("sample"));
+    writer.commit();
+
+    // committed builders are released only after they are written
+    size_t acquired = 0;
+    size_t dropped = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+        builder = writer.acquire();
+        if (builder == nullptr) {
+            ++dropped;
+            continue;
+        }
+        builder->Finish(builder->CreateString("sample"));
+        writer.commit();
+        ++acquired;
+    }
+    writer.close();
+    EXPECT_EQ(acquired + 1, writer.samples_written());
+    EXPECT_EQ(dropped, writer.samples_dropped());
+    std::remove(filename);
+}
+
+TEST(SampleLogWriter, ErrorWhenDiskFull) {
+    static constexpr size_t count = 1000;
+    fbs::SampleLogWriter writer("/dev/full", 8, std::chrono::milliseconds(1));
+    write_samples(writer, count);
+    writer.close();
+    EXPECT_TRUE(writer.error());
+
+    // once the error is set, committed samples are dropped instead of written
+    EXPECT_LT(writer.samples_written(), count);
+    EXPECT_GE(writer.samples_dropped(), count - writer.samples_written());
+}
+
+TEST(SampleLogWriter, InvalidArgumentsKeepExistingFile) {
+    const char contents[] = "existing";
+    std::FILE* f = std::fopen(filename, "wb");
+    ASSERT_NE(nullptr, f);
+    std::fwrite(contents, sizeof(char), sizeof(contents), f);
+    std::fclose(f);
+
+    EXPECT_THROW(fbs::SampleLogWriter(filename, 0), std::invalid_argument);
+    EXPECT_THROW(fbs::SampleLogWriter(filename, 8, std::chrono::milliseconds(10), 0), std::invalid_argument);
+    EXPECT_EQ(sizeof(contents), read_file().size());
+    std::remove(filename);
+}
+
+TEST(SampleLogWriter, BlockSamplesCountedWhenBlockWritten) {
+    static constexpr size_t count = 10;
+    static constexpr size_t index_interval = 16;
+    fbs::SampleLogWriter writer(filename, 8, std::chrono::milliseconds(10), index_interval,
+            fbs::SampleLogWriter::compression_t::block);
+    write_samples(writer, count);
+
+    // the block is not full and is only written on close
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0u, writer.samples_written());
+    writer.close();
+    EXPECT_EQ(count, writer.samples_written());
+    EXPECT_FALSE(writer.error());
+    std::remove(filename);
+}
@@ -0,0 +1,87 @@
+#include <array>
+#include <thread>
+#include "gtest/gtest.h"
+#include "snapshot_ring.h"
+
+namespace {
+    const size_t ring_size = 4;
+    using ring_t = network::SnapshotRing<uint64_t, ring_size>;
+    using sample_t = std::array<uint64_t, 16>;
+} // namespace
+
+TEST(SnapshotRing, Empty) {
+    ring_t ring;
+    uint64_t value;
+    EXPECT_FALSE(ring.pop(&value));
+    EXPECT_FALSE(ring.latest(&value));
+}
+
+TEST(SnapshotRing, PopInOrder) {
+    ring_t ring;
+    uint64_t value;
+    ring.push(1);
+    ring.push(2);
+    ASSERT_TRUE(ring.pop(&value));
+    EXPECT_EQ(1u, value);
+    ASSERT_TRUE(ring.pop(&value));
+    EXPECT_EQ(2u, value);
+    EXPECT_FALSE(ring.pop(&value));
+    EXPECT_EQ(0u, ring.overwritten());
+}
+
+TEST(SnapshotRing, OverwriteOldest) {
+    ring_t ring;
+    uint64_t value;
+    for (uint64_t i = 0; i < 10; ++i) {
+        ring.push(i);
+    }
+    for (uint64_t i = 10 - ring_size; i < 10; ++i) {
+        ASSERT_TRUE(ring.pop(&value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(ring.pop(&value));
+    EXPECT_EQ(10u - ring_size, ring.overwritten());
+    EXPECT_EQ(10u, ring.pushed());
+}
+
+TEST(SnapshotRing, Latest) {
+    ring_t ring;
+    uint64_t value;
+    ring.push(1);
+    ring.push(2);
+    ring.push(3);
+    ASSERT_TRUE(ring.latest(&value));
+    EXPECT_EQ(3u, value);
+    EXPECT_FALSE(ring.latest(&value));
+    EXPECT_FALSE(ring.pop(&value));
+    ring.push(4);
+    ASSERT_TRUE(ring.pop(&value));
+    EXPECT_EQ(4u, value);
+}
+
+TEST(SnapshotRing, ConsistentSnapshot) {
+    // the producer overwrites slots while the consumer copies them
+    network::SnapshotRing<sample_t, 2> ring;
+    const uint64_t count = 1000000;
+
+    std::thread producer([&ring, count]() {
+                sample_t sample;
+                for (uint64_t i = 1; i <= count; ++i) {
+                    sample.fill(i);
+                    ring.push(sample);
+                }
+            });
+
+    uint64_t previous = 0;
+    sample_t sample;
+    while (previous < count) {
+        if (ring.pop(&sample)) {
+            for (auto v: sample) {
+                ASSERT_EQ(sample[0], v);
+            }
+            ASSERT_GT(sample[0], previous);
+            previous = sample[0];
+        }
+    }
+    producer.join();
+}
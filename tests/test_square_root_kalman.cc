@@ -0,0 +1,80 @@
+#include <type_traits>
+#include <Eigen/Cholesky>
+#include "gtest/gtest.h"
+#include "test_convergence.h"
+#include "test_utilities.h"
+#include "square_root_kalman.h"
+#include "parameters.h"
+
+class SquareRootKalmanTest: public ConvergenceTest {
+    public:
+        using square_root_kalman_t = observer::SquareRootKalman<bicycle_t>;
+
+        void SetUp() {
+            ConvergenceTest::SetUp();
+            m_square_root_kalman = new square_root_kalman_t(*m_bicycle,
+                    m_kalman->x(), m_kalman->Q(), m_kalman->R(), m_kalman->P());
+        }
+        void TearDown() {
+            ConvergenceTest::TearDown();
+            delete m_square_root_kalman;
+            m_square_root_kalman = nullptr;
+        }
+        void simulate(size_t N = default_simulation_length) {
+            for(unsigned int i = 0; i < N; ++i) {
+                m_x = m_bicycle->update_state(m_x);
+
+                auto z = m_bicycle->calculate_output(m_x);
+                z(0) += m_r0(m_gen);
+                z(1) += m_r1(m_gen);
+
+                m_kalman->time_update();
+                m_kalman->measurement_update(z);
+                m_square_root_kalman->time_update();
+                m_square_root_kalman->measurement_update(z);
+            }
+        }
+
+    protected:
+        square_root_kalman_t* m_square_root_kalman;
+};
+
+TEST_P(SquareRootKalmanTest, MatchesKalman) {
+    simulate();
+
+    EXPECT_TRUE(m_square_root_kalman->P().isApprox(m_kalman->P(), 1e-4)) <<
+        test::output_matrices(m_kalman->P(), m_square_root_kalman->P());
+    EXPECT_TRUE(m_square_root_kalman->K().isApprox(m_kalman->K(), 1e-4)) <<
+        test::output_matrices(m_kalman->K(), m_square_root_kalman->K());
+    // state diverges at low speeds and rounding error in the estimate grows with it
+    const model::real_t x_tol = std::is_same<model::real_t, float>::value ? 1e-2 : 1e-4;
+    EXPECT_TRUE(m_square_root_kalman->x().isApprox(m_kalman->x(), x_tol)) <<
+        test::output_matrices(m_kalman->x(), m_square_root_kalman->x());
+}
+
+TEST_P(SquareRootKalmanTest, LongHorizonStability) {
+    // the bicycle is unstable at low speeds so the true state is not simulated
+    const bicycle_t::output_t z = bicycle_t::output_t::Zero();
+    for(unsigned int i = 0; i < 100000; ++i) {
+        m_square_root_kalman->time_update();
+        m_square_root_kalman->measurement_update(z);
+        m_kalman->time_update();
+        m_kalman->measurement_update(z);
+    }
+
+    const bicycle_t::state_matrix_t P = m_square_root_kalman->P();
+    EXPECT_TRUE(P.isApprox(P.transpose()));
+    EXPECT_EQ(Eigen::LLT<bicycle_t::state_matrix_t>(P).info(), Eigen::Success);
+    EXPECT_TRUE(P.allFinite());
+    EXPECT_TRUE(m_square_root_kalman->K().isApprox(m_kalman->K(), 1e-3)) <<
+        test::output_matrices(m_kalman->K(), m_square_root_kalman->K());
+    EXPECT_TRUE(P.isApprox(m_kalman->P(), 1e-3)) <<
+        test::output_matrices(m_kalman->P(), P);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ConvergenceRange_1_9,
+    SquareRootKalmanTest,
+    ::testing::Range(static_cast<model::real_t>(0.5),
+        static_cast<model::real_t>(9.5),
+        static_cast<model::real_t>(0.5)));
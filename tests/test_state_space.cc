@@ -1,6 +1,9 @@
+#include <random>
+#include <vector>
 #include <Eigen/Dense>
 #include "gtest/gtest.h"
 #include "bicycle/whipple.h"
+#include "constants.h"
 #include "parameters.h"
 #include "test_utilities.h"
 #include "test_state_space.h"
@@ -68,6 +71,44 @@ TEST_F(StateSpaceTest, ContinuousV5) {
     EXPECT_TRUE(bicycle->B().isApprox(B)) << test::output_matrices(bicycle->B(), B);
 }
 
+TEST_F(StateSpaceTest, ContinuousParameterChange) {
+    bicycle->set_v_dt(3.0, 0);
+    model::BicycleWhipple::second_order_matrix_t K2 = 2*bicycle->K2();
+    model::BicycleWhipple::second_order_matrix_t C1 = bicycle->C1()/2;
+    bicycle->set_K2(K2, false);
+    bicycle->set_C1(C1, true);
+
+    const model::real_t v = bicycle->v();
+    const Eigen::LLT<model::BicycleWhipple::second_order_matrix_t> M_llt(bicycle->M());
+    A = bicycle->A();
+    A.block<2, 2>(3, 1) = -M_llt.solve(constants::g*bicycle->K0() + v*v*K2);
+    A.bottomRightCorner<2, 2>() = -M_llt.solve(v*C1);
+
+    EXPECT_TRUE(bicycle->A().isApprox(A)) << test::output_matrices(bicycle->A(), A);
+    EXPECT_TRUE(bicycle->B().isApprox(B)) << test::output_matrices(bicycle->B(), B);
+}
+
+TEST_F(StateSpaceTest, DeferredMassMatrixChange) {
+    bicycle->set_v_dt(3.0, dt);
+    const model::BicycleWhipple::state_matrix_t A0 = bicycle->A();
+    const model::BicycleWhipple::input_matrix_t B0 = bicycle->B();
+    const uint32_t revision = bicycle->revision();
+
+    // state space matrices are unchanged until the state space is recalculated
+    model::BicycleWhipple::second_order_matrix_t M = 2*bicycle->M();
+    bicycle->set_M(M, false);
+    EXPECT_TRUE(bicycle->A().isApprox(A0)) << test::output_matrices(bicycle->A(), A0);
+    EXPECT_TRUE(bicycle->B().isApprox(B0)) << test::output_matrices(bicycle->B(), B0);
+    EXPECT_EQ(bicycle->revision(), revision);
+
+    bicycle->set_v_dt(bicycle->v(), dt);
+    EXPECT_NE(bicycle->revision(), revision);
+    EXPECT_TRUE(bicycle->B().isApprox(B0/2)) << test::output_matrices(bicycle->B(), B0/2);
+    const model::BicycleWhipple::second_order_matrix_t A_C1 = A0.bottomRightCorner<2, 2>()/2;
+    const model::BicycleWhipple::second_order_matrix_t A_C1_new = bicycle->A().bottomRightCorner<2, 2>();
+    EXPECT_TRUE(A_C1_new.isApprox(A_C1)) << test::output_matrices(A_C1_new, A_C1);
+}
+
 TEST_F(StateSpaceTest, DiscreteV1) {
     bicycle->set_v_dt(1.0, dt);
 
@@ -130,3 +171,244 @@ TEST_F(StateSpaceTest, DiscreteV5) {
     EXPECT_TRUE(bicycle->Ad().isApprox(Ad)) << test::output_matrices(bicycle->Ad(), Ad);
     EXPECT_TRUE(bicycle->Bd().isApprox(Bd)) << test::output_matrices(bicycle->Bd(), Bd);
 }
+
+TEST_F(StateSpaceTest, DiscretizationTableWithinTolerance) {
+    model::BicycleWhipple exact(1.0, dt);
+    bicycle->set_v_dt(1.0, dt);
+    bicycle->set_discretization_table(0.5, 10.0, 0.01);
+    const auto& table = bicycle->discretization_table();
+    ASSERT_FALSE(table.empty());
+    EXPECT_EQ(table.invalid_intervals(), 0u);
+
+    for (auto v: {0.5, 0.503, 1.0, 2.718, 3.14159, 5.0, 7.777, 9.995, 10.0}) {
+        bicycle->set_v(v);
+        exact.set_v(v);
+        EXPECT_LE((bicycle->Ad() - exact.Ad()).cwiseAbs().maxCoeff(), table.tolerance())
+            << test::output_matrices(bicycle->Ad(), exact.Ad());
+        EXPECT_LE((bicycle->Bd() - exact.Bd()).cwiseAbs().maxCoeff(), table.tolerance())
+            << test::output_matrices(bicycle->Bd(), exact.Bd());
+    }
+}
+
+TEST_F(StateSpaceTest, DiscretizationTableFallback) {
+    model::BicycleWhipple exact(1.0, dt);
+    bicycle->set_v_dt(1.0, dt);
+    bicycle->set_discretization_table(0.5, 10.0, 0.01);
+
+    // speed outside of table range
+    bicycle->set_v(12.0);
+    exact.set_v(12.0);
+    EXPECT_EQ(bicycle->Ad(), exact.Ad());
+    EXPECT_EQ(bicycle->Bd(), exact.Bd());
+
+    // sampling time differs from table
+    bicycle->set_v_dt(5.0, dt/2);
+    exact.set_v_dt(5.0, dt/2);
+    EXPECT_EQ(bicycle->Ad(), exact.Ad());
+    EXPECT_EQ(bicycle->Bd(), exact.Bd());
+
+    // interpolation error exceeds tolerance
+    bicycle->set_v_dt(1.0, dt);
+    bicycle->set_discretization_table(0.5, 10.0, 1.0, 1e-9);
+    EXPECT_GT(bicycle->discretization_table().invalid_intervals(), 0u);
+    bicycle->set_v(4.5);
+    exact.set_v_dt(4.5, dt);
+    EXPECT_EQ(bicycle->Ad(), exact.Ad());
+    EXPECT_EQ(bicycle->Bd(), exact.Bd());
+}
+
+TEST_F(StateSpaceTest, DiscretizationTableClearedOnParameterChange) {
+    bicycle->set_v_dt(1.0, dt);
+    bicycle->set_discretization_table(0.5, 10.0, 0.01);
+    ASSERT_FALSE(bicycle->discretization_table().empty());
+
+    bicycle->set_trail(bicycle->trail(), true);
+    EXPECT_TRUE(bicycle->discretization_table().empty());
+}
+
+TEST_F(StateSpaceTest, RevisionIncrementedOnChange) {
+    uint32_t revision = bicycle->revision();
+    bicycle->set_v(1.0);
+    EXPECT_NE(bicycle->revision(), revision);
+
+    revision = bicycle->revision();
+    bicycle->set_dt(dt);
+    EXPECT_NE(bicycle->revision(), revision);
+
+    revision = bicycle->revision();
+    bicycle->set_C(bicycle->C());
+    EXPECT_NE(bicycle->revision(), revision);
+
+    revision = bicycle->revision();
+    bicycle->set_trail(bicycle->trail(), true);
+    EXPECT_NE(bicycle->revision(), revision);
+
+    revision = bicycle->revision();
+    bicycle->update_state(model::BicycleWhipple::state_t::Zero());
+    bicycle->Ad();
+    EXPECT_EQ(bicycle->revision(), revision);
+}
+
+/*
+ * The dynamic states are advanced exactly and must match the Dormand-Prince step
+ * to integration precision. The rear contact position error results from the
+ * linear yaw angle approximation and is bounded by v*dt^3*max|yaw''|/12 per step.
+ */
+TEST_F(StateSpaceTest, DiscreteIntegrationMatchesDopri5) {
+    using bicycle_t = model::BicycleWhipple;
+    const model::real_t v = 5.0;
+    bicycle->set_v_dt(v, dt);
+    bicycle->set_integration_method(bicycle_t::integration_method_t::discrete);
+    bicycle_t dopri5(v, dt); // per step reference
+    bicycle_t dopri5_trajectory(v, dt);
+
+    bicycle_t::state_t x;
+    x << 0, 3, 5, 0, 0; // define x in degrees
+    bicycle_t::full_state_t xf = bicycle_t::make_full_state(
+            bicycle_t::auxiliary_state_t::Zero(), x*constants::as_radians);
+    bicycle_t::full_state_t xf_dopri5 = xf;
+    const bicycle_t::input_t u = (bicycle_t::input_t() << 0, 0.1).finished();
+
+    for (size_t k = 0; k < 1000; ++k) {
+        const bicycle_t::full_state_t xf_step = dopri5.integrate_full_state(xf, u, dt);
+        xf = bicycle->integrate_full_state(xf, u, dt);
+        ASSERT_TRUE(test::allclose(xf.tail<bicycle_t::n>(), xf_step.tail<bicycle_t::n>(), 1e-8, 1e-10))
+            << test::output_matrices(xf_step, xf);
+        ASSERT_TRUE(test::allclose(xf.head<bicycle_t::p>(), xf_step.head<bicycle_t::p>(), 0, 1e-6))
+            << test::output_matrices(xf_step, xf);
+        xf_dopri5 = dopri5_trajectory.integrate_full_state(xf_dopri5, u, dt);
+    }
+    EXPECT_TRUE(test::allclose(xf.tail<bicycle_t::n>(), xf_dopri5.tail<bicycle_t::n>(), 1e-6, 1e-8))
+        << test::output_matrices(xf_dopri5, xf);
+    EXPECT_TRUE(test::allclose(xf.head<bicycle_t::p>(), xf_dopri5.head<bicycle_t::p>(), 0, 1e-3))
+        << test::output_matrices(xf_dopri5, xf);
+}
+
+TEST_F(StateSpaceTest, DiscreteIntegrationFallback) {
+    using bicycle_t = model::BicycleWhipple;
+    bicycle->set_v_dt(5.0, dt);
+    bicycle->set_integration_method(bicycle_t::integration_method_t::discrete);
+    bicycle_t dopri5(5.0, dt);
+
+    bicycle_t::full_state_t xf = bicycle_t::full_state_t::Zero();
+    bicycle_t::set_full_state_element(xf, bicycle_t::full_state_index_t::roll_angle, 3*constants::as_radians);
+    const bicycle_t::input_t u = bicycle_t::input_t::Zero();
+
+    // integration time differs from the sampling time
+    EXPECT_EQ(bicycle->integrate_full_state(xf, u, dt/2), dopri5.integrate_full_state(xf, u, dt/2));
+}
+
+TEST_F(StateSpaceTest, DenseOutputTrajectory) {
+    using bicycle_t = model::BicycleWhipple;
+    const model::real_t t = 5.0;
+    const model::real_t t_sample = 1.0/64; // t is a multiple of the sample time
+    bicycle->set_v_dt(5.0, dt);
+    bicycle->set_integration_tolerance(1e-10, 1e-10);
+
+    bicycle_t::state_t x;
+    x << 0, 3, 5, 0, 0; // define x in degrees
+    const bicycle_t::full_state_t xf0 = bicycle_t::make_full_state(
+            bicycle_t::auxiliary_state_t::Zero(), x*constants::as_radians);
+    const bicycle_t::input_t u = (bicycle_t::input_t() << 0, 0.1).finished();
+
+    bicycle_t::full_state_trajectory_t trajectory;
+    const bicycle_t::full_state_t xf_end = bicycle->integrate_full_state_trajectory(
+            xf0, u, t, t_sample, &trajectory);
+    ASSERT_EQ(trajectory.size(), static_cast<size_t>(t/t_sample) + 1);
+    EXPECT_EQ(trajectory.front(), xf0);
+
+    // compare with fixed steps of a fraction of the sample time
+    const size_t substeps = 10;
+    bicycle_t::full_state_t xf = xf0;
+    for (size_t k = 1; k < trajectory.size(); ++k) {
+        for (size_t i = 0; i < substeps; ++i) {
+            xf = bicycle->integrate_full_state(xf, u, t_sample/substeps);
+        }
+        ASSERT_TRUE(test::allclose(trajectory[k], xf, 1e-6, 1e-8)) << test::output_matrices(xf, trajectory[k]);
+    }
+    EXPECT_TRUE(test::allclose(xf_end, trajectory.back(), 1e-12, 1e-14))
+        << test::output_matrices(trajectory.back(), xf_end);
+
+    // the default implementation in Bicycle integrates the same linear model
+    bicycle_t::full_state_trajectory_t default_trajectory;
+    const bicycle_t::full_state_t default_xf_end = bicycle->model::Bicycle::integrate_full_state_trajectory(
+            xf0, u, t, t_sample, &default_trajectory, bicycle_t::measurement_t::Zero());
+    ASSERT_EQ(trajectory.size(), default_trajectory.size());
+    EXPECT_TRUE(test::allclose(xf_end, default_xf_end, 1e-12, 1e-14))
+        << test::output_matrices(xf_end, default_xf_end);
+}
+
+TEST_F(StateSpaceTest, ConstraintPitchBatch) {
+    const size_t count = 100; // not a multiple of the block size
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<model::real_t> rroll(-30*constants::as_radians, 30*constants::as_radians);
+    std::uniform_real_distribution<model::real_t> rsteer(-45*constants::as_radians, 45*constants::as_radians);
+
+    std::vector<model::real_t> roll(count);
+    std::vector<model::real_t> steer(count);
+    std::vector<model::real_t> pitch(count);
+    std::vector<model::real_t> expected(count);
+    for (size_t i = 0; i < count; ++i) {
+        roll[i] = rroll(gen);
+        steer[i] = rsteer(gen);
+        expected[i] = bicycle->solve_constraint_pitch(roll[i], steer[i], 0, 20);
+    }
+
+    bicycle->solve_constraint_pitch_batch(roll.data(), steer.data(), pitch.data(), count, 10);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_NEAR(pitch[i], expected[i], 1e-10) << "element " << i;
+    }
+
+    // warm start from the previous solution converges with few iterations
+    for (size_t i = 0; i < count; ++i) {
+        roll[i] += static_cast<model::real_t>(0.01);
+        steer[i] -= static_cast<model::real_t>(0.01);
+        expected[i] = bicycle->solve_constraint_pitch(roll[i], steer[i], pitch[i], 20);
+    }
+    bicycle->solve_constraint_pitch_batch(roll.data(), steer.data(), pitch.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_NEAR(pitch[i], expected[i], 1e-10) << "element " << i;
+    }
+}
+
+TEST_F(StateSpaceTest, PitchTableWithinTolerance) {
+    const model::real_t roll_max = 45*constants::as_radians;
+    const model::real_t steer_max = 60*constants::as_radians;
+    bicycle->set_pitch_table(roll_max, steer_max);
+    ASSERT_FALSE(bicycle->pitch_table().empty());
+    EXPECT_LT(bicycle->pitch_table().max_error(), 1e-6);
+
+    model::BicycleWhipple exact(0.0, 0.0);
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<model::real_t> rroll(-roll_max, roll_max);
+    std::uniform_real_distribution<model::real_t> rsteer(-steer_max, steer_max);
+    for (size_t i = 0; i < 1000; ++i) {
+        const model::real_t roll = rroll(gen);
+        const model::real_t steer = rsteer(gen);
+        EXPECT_NEAR(bicycle->solve_constraint_pitch(roll, steer, 0),
+                exact.solve_constraint_pitch(roll, steer, 0, 20), 1e-6);
+    }
+
+    // angles outside the table range are solved exactly
+    EXPECT_EQ(bicycle->solve_constraint_pitch(roll_max + 0.1, 0, 0, 20),
+            exact.solve_constraint_pitch(roll_max + 0.1, 0, 0, 20));
+}
+
+TEST_F(StateSpaceTest, PitchTableInvalidatedOnParameterChange) {
+    const model::real_t rf = bicycle->front_wheel_radius() + 0.01;
+    model::BicycleWhipple exact(0.0, 0.0);
+    exact.set_front_wheel_radius(rf, true);
+
+    bicycle->set_pitch_table(0.5, 0.5);
+    const model::real_t pitch = bicycle->solve_constraint_pitch(0.1, 0.2, 0);
+
+    // table is not used while the Moore parameters must be recalculated
+    bicycle->set_front_wheel_radius(rf, false);
+    ASSERT_TRUE(bicycle->need_recalculate_moore_parameters());
+    EXPECT_NE(bicycle->solve_constraint_pitch(0.1, 0.2, 0, 20), pitch);
+
+    // table is generated again when the Moore parameters are set
+    bicycle->set_moore_parameters();
+    EXPECT_FALSE(bicycle->pitch_table().empty());
+    EXPECT_NEAR(bicycle->solve_constraint_pitch(0.1, 0.2, 0), exact.solve_constraint_pitch(0.1, 0.2, 0, 20), 1e-6);
+}
@@ -0,0 +1,316 @@
+/*
+ * Monte Carlo sweep of closed-loop (LQR + Kalman) convergence.
+ *
+ * Each run simulates the same closed loop as the LqrKalmanConvergenceTest
+ * (see tests/test_convergence.cc) for a single combination of parameter file,
+ * forward speed, and noise seed. Runs are distributed over a pool of worker
+ * threads with work stealing and the per-worker statistics are reduced after
+ * all workers have finished, so no locks are taken during the sweep.
+ *
+ * The noise generator of each run is seeded from the base seed and the run
+ * index, so results are reproducible for a given seed regardless of the number
+ * of threads or the order in which runs are executed.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bicycle/whipple.h"
+#include "kalman.h"
+#include "lqr.h"
+#include "parameters.h"
+
+namespace {
+    using bicycle_t = model::BicycleWhipple;
+    using kalman_t = observer::Kalman<bicycle_t>;
+    using lqr_t = controller::Lqr<bicycle_t>;
+    using real_t = model::real_t;
+
+    // same values as ConvergenceTest
+    const real_t dt = 1.0/200;
+    const size_t default_simulation_length = 1000;
+    const size_t default_horizon_length = 100;
+    const real_t yaw_tol = 1 * constants::as_radians;
+    const real_t roll_tol = 0.3 * constants::as_radians;
+    const real_t steer_tol = 0.3 * constants::as_radians;
+    const real_t roll_rate_tol = 10 * roll_tol;
+    const real_t steer_rate_tol = 10 * steer_tol;
+
+    struct sweep_t {
+        std::vector<std::string> parameter_files; // empty string for benchmark parameters
+        std::vector<real_t> speeds;
+        size_t seeds;
+        uint32_t seed;
+        size_t simulation_length;
+        size_t threads;
+
+        size_t runs() const {
+            return parameter_files.size()*speeds.size()*seeds;
+        }
+    };
+
+    /* statistics accumulated per (parameter file, speed) */
+    struct statistics_t {
+        size_t runs = 0;
+        size_t estimate_converged = 0;
+        size_t state_converged = 0;
+        size_t fallen = 0;
+        double sum_estimate_error = 0; // norm of final estimation error
+        double max_estimate_error = 0;
+
+        void add(const statistics_t& other) {
+            runs += other.runs;
+            estimate_converged += other.estimate_converged;
+            state_converged += other.state_converged;
+            fallen += other.fallen;
+            sum_estimate_error += other.sum_estimate_error;
+            max_estimate_error = std::max(max_estimate_error, other.max_estimate_error);
+        }
+    };
+
+    bool state_near(const bicycle_t::state_t& actual, const bicycle_t::state_t& expected) {
+        const bicycle_t::state_t e = (actual - expected).cwiseAbs();
+        return (e[0] <= yaw_tol) && (e[1] <= roll_tol) && (e[2] <= steer_tol) &&
+            (e[3] <= roll_rate_tol) && (e[4] <= steer_rate_tol);
+    }
+
+    statistics_t simulate(const sweep_t& sweep, size_t run) {
+        const size_t seed_index = run % sweep.seeds;
+        const size_t speed_index = (run / sweep.seeds) % sweep.speeds.size();
+        const size_t file_index = run / (sweep.seeds*sweep.speeds.size());
+        const std::string& file = sweep.parameter_files[file_index];
+        const real_t v = sweep.speeds[speed_index];
+
+        std::seed_seq seq{sweep.seed, static_cast<uint32_t>(file_index),
+            static_cast<uint32_t>(speed_index), static_cast<uint32_t>(seed_index)};
+        std::mt19937 gen(seq);
+        std::normal_distribution<> r0(0, parameters::defaultvalue::kalman::R(0, 0));
+        std::normal_distribution<> r1(0, parameters::defaultvalue::kalman::R(1, 1));
+
+        bicycle_t::state_t x;
+        x << 0, 3, 5, 0, 0; // define x in degrees
+        x *= constants::as_radians;
+
+        bicycle_t bicycle = file.empty() ? bicycle_t(v, dt) : bicycle_t(file.c_str(), v, dt);
+        kalman_t kalman(bicycle,
+                bicycle_t::state_t::Zero(),
+                parameters::defaultvalue::kalman::Q(dt),
+                parameters::defaultvalue::kalman::R,
+                std::pow(x[1]/2, 2) * bicycle_t::state_matrix_t::Identity());
+        lqr_t lqr(bicycle,
+                lqr_t::state_cost_t::Identity(),
+                0.1 * (lqr_t::input_cost_t() << 0, 0, 0, 1).finished(),
+                bicycle_t::state_t::Zero(), default_horizon_length);
+
+        statistics_t stats;
+        for (size_t i = 0; i < sweep.simulation_length; ++i) {
+            auto u = lqr.control_calculate(kalman.x());
+            x = bicycle.update_state(x, u);
+
+            auto z = bicycle.calculate_output(x);
+            z(0) += r0(gen);
+            z(1) += r1(gen);
+
+            kalman.time_update(u);
+            kalman.measurement_update(z);
+
+            // stop simulation if frame is horizontal (bike has fallen)
+            if (std::abs(x[1]) >= constants::pi/2) {
+                stats.fallen = 1;
+                break;
+            }
+        }
+
+        const double error = (kalman.x() - x).norm();
+        stats.runs = 1;
+        stats.estimate_converged = state_near(kalman.x(), x);
+        stats.state_converged = state_near(x, bicycle_t::state_t::Zero());
+        stats.sum_estimate_error = error;
+        stats.max_estimate_error = error;
+        return stats;
+    }
+
+    /*
+     * Work-stealing scheduler. The runs are initially split into one contiguous
+     * range per worker. A worker claims runs from its own range and, when its
+     * range is exhausted, claims runs from the ranges of other workers. Claims
+     * are made with an atomic increment so no locks are required.
+     */
+    struct alignas(64) work_range_t {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    class Scheduler {
+        public:
+            Scheduler(size_t runs, size_t workers) : m_ranges(workers) {
+                for (size_t i = 0; i < workers; ++i) {
+                    m_ranges[i].next = runs*i/workers;
+                    m_ranges[i].end = runs*(i + 1)/workers;
+                }
+            }
+
+            // claim a run, returns false if no runs remain
+            bool claim(size_t worker, size_t* run) {
+                const size_t workers = m_ranges.size();
+                for (size_t i = 0; i < workers; ++i) {
+                    work_range_t& range = m_ranges[(worker + i) % workers];
+                    if (range.next.load(std::memory_order_relaxed) < range.end) {
+                        const size_t r = range.next.fetch_add(1, std::memory_order_relaxed);
+                        if (r < range.end) {
+                            *run = r;
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+        private:
+            std::vector<work_range_t> m_ranges;
+    };
+
+    /* statistics of each worker are stored separately to avoid false sharing */
+    struct alignas(64) worker_statistics_t {
+        std::vector<statistics_t> stats;
+    };
+
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options] [parameter_file ...]\n";
+        std::cerr << "\nRun a Monte Carlo sweep of closed-loop convergence over forward speeds,\n" <<
+            "noise seeds, and bicycle parameter files. If no parameter file is given,\n" <<
+            "the benchmark parameters are used.\n\n";
+        std::cerr << "Options:\n";
+        std::cerr << "  -j <threads>          number of worker threads (default: all cores)\n";
+        std::cerr << "  -n <seeds>            number of noise seeds per speed (default: 10)\n";
+        std::cerr << "  -s <seed>             base seed (default: 0)\n";
+        std::cerr << "  -v <min> <max> <step> forward speed range [m/s] (default: 0.5 9.0 0.5)\n";
+        std::cerr << "  -N <samples>          simulation length (default: " <<
+            default_simulation_length << ")\n";
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    sweep_t sweep;
+    sweep.seeds = 10;
+    sweep.seed = 0;
+    sweep.simulation_length = default_simulation_length;
+    sweep.threads = std::max(1u, std::thread::hardware_concurrency());
+    real_t v_min = 0.5;
+    real_t v_max = 9.0;
+    real_t dv = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string(argv[i]);
+        if ((arg == "-j") && (i + 1 < argc)) {
+            sweep.threads = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-n") && (i + 1 < argc)) {
+            sweep.seeds = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-s") && (i + 1 < argc)) {
+            sweep.seed = std::strtoul(argv[++i], nullptr, 0);
+        } else if ((arg == "-N") && (i + 1 < argc)) {
+            sweep.simulation_length = std::strtoul(argv[++i], nullptr, 0);
+        } else if ((arg == "-v") && (i + 3 < argc)) {
+            v_min = std::atof(argv[++i]);
+            v_max = std::atof(argv[++i]);
+            dv = std::atof(argv[++i]);
+        } else if ((arg == "-h") || (arg.size() > 1 && arg[0] == '-')) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            sweep.parameter_files.push_back(arg);
+        }
+    }
+    if (sweep.parameter_files.empty()) {
+        sweep.parameter_files.push_back(std::string());
+    }
+    if (!(dv > 0) || !(v_max >= v_min)) {
+        std::cerr << "Invalid speed range.\n";
+        return EXIT_FAILURE;
+    }
+    // speeds are spaced by dv and v_max is added if the range is not a multiple
+    // of dv, a grid point within a small tolerance of v_max is set to v_max
+    const real_t tolerance = static_cast<real_t>(1e-6)*dv;
+    const size_t steps = static_cast<size_t>(std::floor((v_max - v_min + tolerance)/dv));
+    for (size_t i = 0; i <= steps; ++i) {
+        sweep.speeds.push_back(std::min(v_min + i*dv, v_max));
+    }
+    if (v_max - sweep.speeds.back() > tolerance) {
+        sweep.speeds.push_back(v_max);
+    }
+
+    const size_t runs = sweep.runs();
+    const size_t groups = sweep.parameter_files.size()*sweep.speeds.size();
+    std::cout << "running " << runs << " closed-loop simulations (" <<
+        sweep.parameter_files.size() << " parameter files, " <<
+        sweep.speeds.size() << " speeds, " << sweep.seeds << " seeds) on " <<
+        sweep.threads << " threads" << std::endl;
+
+    Scheduler scheduler(runs, sweep.threads);
+    std::vector<worker_statistics_t> worker_stats(sweep.threads);
+    std::vector<std::thread> workers;
+    std::atomic<bool> failed(false);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t w = 0; w < sweep.threads; ++w) {
+        worker_stats[w].stats.resize(groups);
+        workers.emplace_back([&sweep, &scheduler, &worker_stats, &failed, w]() {
+            size_t run;
+            while (scheduler.claim(w, &run)) {
+                try {
+                    worker_stats[w].stats[run / sweep.seeds].add(simulate(sweep, run));
+                } catch (std::exception& e) {
+                    std::cerr << e.what() << "\n";
+                    failed = true;
+                    return;
+                }
+            }
+        });
+    }
+    for (auto& worker: workers) {
+        worker.join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    if (failed) {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<statistics_t> stats(groups);
+    statistics_t total;
+    for (const auto& ws: worker_stats) {
+        for (size_t i = 0; i < groups; ++i) {
+            stats[i].add(ws.stats[i]);
+        }
+    }
+
+    std::cout << "\nparameter file, speed [m/s], estimate converged, state converged, " <<
+        "fallen, mean estimate error, max estimate error" << std::endl;
+    for (size_t i = 0; i < groups; ++i) {
+        const statistics_t& s = stats[i];
+        const std::string& file = sweep.parameter_files[i / sweep.speeds.size()];
+        std::cout << (file.empty() ? "benchmark" : file) << ", " <<
+            sweep.speeds[i % sweep.speeds.size()] << ", " <<
+            s.estimate_converged << "/" << s.runs << ", " <<
+            s.state_converged << "/" << s.runs << ", " <<
+            s.fallen << ", " <<
+            s.sum_estimate_error/s.runs << ", " <<
+            s.max_estimate_error << std::endl;
+        total.add(s);
+    }
+
+    const double elapsed = std::chrono::duration<double>(stop - start).count();
+    std::cout << "\ntotal: estimate converged " << total.estimate_converged << "/" << total.runs <<
+        ", state converged " << total.state_converged << "/" << total.runs <<
+        ", fallen " << total.fallen << std::endl;
+    std::cout << "elapsed time: " << elapsed << " s, throughput: " <<
+        runs/elapsed << " runs/s" << std::endl;
+
+    return (total.runs == runs) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
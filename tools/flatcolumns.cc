@@ -0,0 +1,386 @@
+/*
+ * Convert a sample log to a columnar binary file.
+ *
+ * Every scalar field of a Sample, including each element of the struct
+ * fields (e.g. state.x0 ... state.x4, kalman.error_covariance.q00 ...), is
+ * written as a contiguous little-endian array with one element per sample.
+ * Optional fields have a presence bitmap with one bit per sample (least
+ * significant bit first) and the values of missing samples are zero. Columns
+ * start at 64 byte aligned offsets so that each column can be memory mapped
+ * directly as a numpy array, e.g. with python/convert.py load_columns().
+ *
+ * A JSON manifest is written next to the output file with the name, dtype and
+ * offset of each column. Struct fields share a presence bitmap named
+ * '<field>.present'. As in python/convert.py, a scalar field is considered
+ * missing if it is equal to its default value.
+ *
+ * The sample log is read with SampleLogReader and the output file is memory
+ * mapped, and samples are converted in chunks by a pool of worker threads. The
+ * chunk size is a multiple of 8 samples so that workers never write the same
+ * byte of a presence bitmap. Kalman and Lqr fields of a delta encoded log are
+ * reconstructed, with each worker decoding from the keyframe preceding its
+ * chunk.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "sample_delta.h"
+#include "sample_log_reader.h"
+
+namespace {
+    constexpr size_t column_alignment = 64;
+    constexpr size_t chunk_size = 8*1024; // samples, must be a multiple of 8
+
+    /* a Sample struct field, all struct fields are matrices of doubles */
+    struct group_t {
+        const char* name;
+        char prefix; // element name prefix as in fbs/sample.fbs
+        size_t rows;
+        size_t cols;
+        bool symmetric; // only the upper triangle is stored
+        const double* (*get)(const fbs::Sample* sample, const fbs::SampleDeltaDecoder& decoder);
+    };
+
+    /* a Sample scalar field */
+    struct scalar_t {
+        const char* name;
+        const char* dtype;
+        size_t size;
+        bool optional;
+        bool (*get)(const fbs::Sample* sample, void* value); // returns presence
+    };
+
+    /* a column in the output file */
+    struct column_t {
+        std::string name;
+        std::string dtype;
+        size_t offset;
+        std::string presence; // name of the presence bitmap column, if any
+    };
+
+    template <typename T>
+    const double* as_doubles(const T* t) {
+        static_assert(sizeof(T) % sizeof(double) == 0, "Struct must contain only doubles.");
+        return reinterpret_cast<const double*>(t);
+    }
+
+    /* scalar values are returned by the accessors in host byte order */
+    template <typename T>
+    void store(void* value, T v) {
+        v = flatbuffers::EndianScalar(v);
+        std::memcpy(value, &v, sizeof(v));
+    }
+
+    const group_t groups[] = {
+        {"state", 'x', 5, 1, false,
+            [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) { return as_doubles(s->state()); }},
+        {"input", 'u', 2, 1, false,
+            [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) { return as_doubles(s->input()); }},
+        {"output", 'y', 2, 1, false,
+            [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) { return as_doubles(s->output()); }},
+        {"measurement", 'y', 2, 1, false,
+            [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) { return as_doubles(s->measurement()); }},
+        {"auxiliary_state", 'x', 4, 1, false,
+            [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) { return as_doubles(s->auxiliary_state()); }},
+
+        {"bicycle.M", 'm', 2, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->M()) : nullptr; }},
+        {"bicycle.C1", 'm', 2, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->C1()) : nullptr; }},
+        {"bicycle.K0", 'm', 2, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->K0()) : nullptr; }},
+        {"bicycle.K2", 'm', 2, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->K2()) : nullptr; }},
+        {"bicycle.Ad", 'a', 5, 5, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->Ad()) : nullptr; }},
+        {"bicycle.Bd", 'b', 5, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->Bd()) : nullptr; }},
+        {"bicycle.Cd", 'c', 2, 5, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->Cd()) : nullptr; }},
+        {"bicycle.Dd", 'd', 2, 2, false, [](const fbs::Sample* s, const fbs::SampleDeltaDecoder&) {
+            return s->bicycle() ? as_doubles(s->bicycle()->Dd()) : nullptr; }},
+
+        {"kalman.state_estimate", 'x', 5, 1, false, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::State>(fbs::delta_field_t::kalman_state_estimate)); }},
+        {"kalman.error_covariance", 'q', 5, 5, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::kalman_error_covariance)); }},
+        {"kalman.process_noise_covariance", 'q', 5, 5, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::kalman_process_noise_covariance)); }},
+        {"kalman.measurement_noise_covariance", 'r', 2, 2, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricOutputMatrix>(fbs::delta_field_t::kalman_measurement_noise_covariance)); }},
+        {"kalman.kalman_gain", 'k', 5, 2, false, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::KalmanGainMatrix>(fbs::delta_field_t::kalman_gain)); }},
+
+        {"lqr.reference", 'x', 5, 1, false, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::State>(fbs::delta_field_t::lqr_reference)); }},
+        {"lqr.state_cost", 'q', 5, 5, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::lqr_state_cost)); }},
+        {"lqr.input_cost", 'r', 2, 2, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricInputMatrix>(fbs::delta_field_t::lqr_input_cost)); }},
+        {"lqr.horizon_cost", 'q', 5, 5, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::lqr_horizon_cost)); }},
+        {"lqr.lqr_gain", 'k', 2, 5, false, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::LqrGainMatrix>(fbs::delta_field_t::lqr_gain)); }},
+        {"lqr.integral_cost", 'q', 5, 5, true, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::SymmetricStateMatrix>(fbs::delta_field_t::lqr_integral_cost)); }},
+        {"lqr.integral", 'x', 5, 1, false, [](const fbs::Sample*, const fbs::SampleDeltaDecoder& d) {
+            return as_doubles(d.get<fbs::State>(fbs::delta_field_t::lqr_integral)); }},
+    };
+
+    const scalar_t scalars[] = {
+        {"timestamp", "<u4", sizeof(uint32_t), false, [](const fbs::Sample* s, void* value) {
+            const uint32_t v = s->timestamp();
+            store(value, v);
+            return true; }},
+        {"computation_time", "<f8", sizeof(double), true, [](const fbs::Sample* s, void* value) {
+            const double v = s->computation_time();
+            store(value, v);
+            return v != 0; }},
+        {"bicycle.v", "<f8", sizeof(double), true, [](const fbs::Sample* s, void* value) {
+            const double v = s->bicycle() ? s->bicycle()->v() : 0;
+            store(value, v);
+            return v != 0; }},
+        {"bicycle.dt", "<f8", sizeof(double), true, [](const fbs::Sample* s, void* value) {
+            const double v = s->bicycle() ? s->bicycle()->dt() : 0;
+            store(value, v);
+            return v != 0; }},
+        {"lqr.horizon", "<u4", sizeof(uint32_t), true, [](const fbs::Sample* s, void* value) {
+            const uint32_t v = s->lqr() ? s->lqr()->horizon() : 0;
+            store(value, v);
+            return v != 0; }},
+    };
+
+    size_t group_size(const group_t& g) {
+        return g.symmetric ? g.rows*(g.rows + 1)/2 : g.rows*g.cols;
+    }
+
+    /* element names in the order they are stored in the struct */
+    std::vector<std::string> element_names(const group_t& g) {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < g.rows; ++i) {
+            for (size_t j = g.symmetric ? i : 0; j < g.cols; ++j) {
+                std::string name(1, g.prefix);
+                name += std::to_string(i);
+                if (g.cols > 1) {
+                    name += std::to_string(j);
+                }
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+
+    size_t align(size_t offset) {
+        return (offset + column_alignment - 1)/column_alignment*column_alignment;
+    }
+
+    /* offsets of the columns of a group or scalar in the output file */
+    struct layout_t {
+        std::vector<size_t> group_data; // first element column of each group
+        std::vector<size_t> group_presence;
+        std::vector<size_t> scalar_data;
+        std::vector<size_t> scalar_presence; // zero if the scalar is not optional
+        std::vector<column_t> columns;
+        size_t file_size;
+    };
+
+    layout_t make_layout(size_t samples) {
+        layout_t layout;
+        const size_t bitmap_size = (samples + 7)/8;
+        size_t offset = 0;
+        for (const auto& g: groups) {
+            layout.group_data.push_back(offset);
+            for (const auto& e: element_names(g)) {
+                layout.columns.push_back(column_t{std::string(g.name) + "." + e, "<f8", offset,
+                        std::string(g.name) + ".present"});
+                offset = align(offset + samples*sizeof(double));
+            }
+            layout.group_presence.push_back(offset);
+            layout.columns.push_back(column_t{std::string(g.name) + ".present", "|u1", offset, ""});
+            offset = align(offset + bitmap_size);
+        }
+        for (const auto& s: scalars) {
+            layout.scalar_data.push_back(offset);
+            layout.columns.push_back(column_t{s.name, s.dtype, offset,
+                    s.optional ? std::string(s.name) + ".present" : ""});
+            offset = align(offset + samples*s.size);
+            layout.scalar_presence.push_back(0);
+            if (s.optional) {
+                layout.scalar_presence.back() = offset;
+                layout.columns.push_back(column_t{std::string(s.name) + ".present", "|u1", offset, ""});
+                offset = align(offset + bitmap_size);
+            }
+        }
+        layout.file_size = offset;
+        return layout;
+    }
+
+    void convert_chunk(const fbs::SampleLogReader& reader, const layout_t& layout,
+            uint8_t* out, size_t begin, size_t end) {
+        const size_t samples = reader.size();
+        fbs::SampleDeltaDecoder decoder;
+        for (size_t i = reader.keyframe(begin); i < begin; ++i) {
+            decoder.update(reader.sample(i));
+        }
+        for (size_t i = begin; i < end; ++i) {
+            const fbs::Sample* sample = reader.sample(i);
+            decoder.update(sample);
+            for (size_t k = 0; k < sizeof(groups)/sizeof(groups[0]); ++k) {
+                const double* values = groups[k].get(sample, decoder);
+                if (values == nullptr) {
+                    continue;
+                }
+                out[layout.group_presence[k] + i/8] |= static_cast<uint8_t>(1 << (i % 8));
+                double* column = reinterpret_cast<double*>(out + layout.group_data[k]);
+                for (size_t e = 0; e < group_size(groups[k]); ++e) {
+                    // struct values are stored little-endian in both the sample and the column
+                    // and element columns are aligned, so the stride between columns is constant
+                    std::memcpy(&column[i], &values[e], sizeof(double));
+                    column = reinterpret_cast<double*>(
+                            reinterpret_cast<uint8_t*>(column) + align(samples*sizeof(double)));
+                }
+            }
+            for (size_t k = 0; k < sizeof(scalars)/sizeof(scalars[0]); ++k) {
+                const bool present = scalars[k].get(sample,
+                        out + layout.scalar_data[k] + i*scalars[k].size);
+                if (present && scalars[k].optional) {
+                    out[layout.scalar_presence[k] + i/8] |= static_cast<uint8_t>(1 << (i % 8));
+                }
+            }
+        }
+    }
+
+    void write_manifest(const std::string& filename, const std::string& data_filename,
+            size_t samples, const layout_t& layout) {
+        std::ofstream manifest(filename);
+        manifest << "{\n";
+        manifest << "  \"file\": \"" << data_filename << "\",\n";
+        manifest << "  \"samples\": " << samples << ",\n";
+        manifest << "  \"bit_order\": \"little\",\n";
+        manifest << "  \"columns\": [\n";
+        for (size_t i = 0; i < layout.columns.size(); ++i) {
+            const column_t& c = layout.columns[i];
+            manifest << "    {\"name\": \"" << c.name << "\", \"dtype\": \"" << c.dtype <<
+                "\", \"offset\": " << c.offset;
+            if (!c.presence.empty()) {
+                manifest << ", \"presence\": \"" << c.presence << "\"";
+            }
+            manifest << "}" << (i + 1 < layout.columns.size() ? "," : "") << "\n";
+        }
+        manifest << "  ]\n";
+        manifest << "}\n";
+    }
+
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options] <sample_log> <output_file>\n";
+        std::cerr << "\nConvert a sample log to a columnar binary file with one array per\n" <<
+            "field and a JSON manifest '<output_file>.json' describing the columns.\n\n";
+        std::cerr << "Options:\n";
+        std::cerr << "  -j <threads>          number of worker threads (default: hardware concurrency)\n";
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string(argv[i]);
+        if ((arg == "-j") && (i + 1 < argc)) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-h") || (arg.size() > 1 && arg[0] == '-')) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string& input_file = positional[0];
+    const std::string& output_file = positional[1];
+
+    try {
+        const fbs::SampleLogReader reader(input_file.c_str());
+        const size_t samples = reader.size();
+        const layout_t layout = make_layout(samples);
+
+        const int fd = open(output_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open output file.");
+        }
+        /* the extended file is zero filled so missing values and presence bits are zero */
+        if (ftruncate(fd, static_cast<off_t>(layout.file_size)) < 0) {
+            ::close(fd);
+            throw std::runtime_error("Unable to resize output file.");
+        }
+        if (layout.file_size > 0) {
+            void* p = mmap(nullptr, layout.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Unable to map output file.");
+            }
+            uint8_t* out = static_cast<uint8_t*>(p);
+
+            const size_t chunks = (samples + chunk_size - 1)/chunk_size;
+            std::atomic<size_t> next_chunk(0);
+            std::vector<std::thread> workers;
+            /* exceptions are caught on the worker threads and rethrown after join */
+            std::vector<std::exception_ptr> errors(std::min(threads, chunks));
+            for (size_t t = 0; t < errors.size(); ++t) {
+                workers.emplace_back([&, t]() {
+                    try {
+                        // a compressed stream reader caches decoded blocks and cannot be shared
+                        std::unique_ptr<fbs::SampleLogReader> worker_reader;
+                        if (reader.format() == fbs::SampleLogReader::format_t::compressed_stream) {
+                            worker_reader.reset(new fbs::SampleLogReader(input_file.c_str()));
+                        }
+                        const fbs::SampleLogReader& r = worker_reader ? *worker_reader : reader;
+                        size_t chunk;
+                        while ((chunk = next_chunk++) < chunks) {
+                            const size_t begin = chunk*chunk_size;
+                            convert_chunk(r, layout, out, begin, std::min(begin + chunk_size, samples));
+                        }
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                        next_chunk = chunks; // stop the other workers
+                    }
+                });
+            }
+            for (auto& w: workers) {
+                w.join();
+            }
+            munmap(p, layout.file_size);
+            for (const auto& e: errors) {
+                if (e) {
+                    ::close(fd);
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+        ::close(fd);
+
+        write_manifest(output_file + ".json", output_file, samples, layout);
+        std::cout << "converted " << samples << " samples to " <<
+            layout.columns.size() << " columns" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
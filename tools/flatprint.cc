@@ -1,46 +1,95 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/idl.h"
 #include "flatbuffers/util.h"
 
-#include "sample_log_generated.h"
+#include "sample_delta.h"
+#include "sample_log_reader.h"
 
-void parse_nested_container(const flatbuffers::Parser& parser, const void* root_flatbuffer, std::string* text) {
-    auto sample_log = flatbuffers::GetRoot<fbs::SampleLog>(root_flatbuffer);
-    auto samples = sample_log->samples();
+namespace {
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name <<
+            " [--range <begin>:<end>] [--stride <n>] <sample_schema> <sample_log>" << std::endl;
+        std::cerr << "\nConvert a sample log binary, either a container flatbuffer or a " <<
+            "stream of size-prefixed samples, to text with a sequence of samples." << std::endl;
+        std::cerr << "\n  --range <begin>:<end>  print samples in [begin, end), " <<
+            "either may be omitted" << std::endl;
+        std::cerr << "  --stride <n>           print every n-th sample" << std::endl;
+    }
 
-    *text += "samples:\n";
-    for (auto s: *samples) {
-        flatbuffers::GenerateText(parser, s->data()->Data(), flatbuffers::GeneratorOptions(), text);
+    bool parse_size(const char* s, size_t* value) {
+        char* end = nullptr;
+        const unsigned long long v = std::strtoull(s, &end, 10);
+        if ((end == s) || (*end != '\0')) {
+            return false;
+        }
+        *value = static_cast<size_t>(v);
+        return true;
     }
-}
 
+    bool parse_range(const char* s, size_t* begin, size_t* end) {
+        const char* colon = std::strchr(s, ':');
+        if (colon == nullptr) {
+            return false;
+        }
+        const std::string first(s, colon);
+        const std::string second(colon + 1);
+        if (!first.empty() && !parse_size(first.c_str(), begin)) {
+            return false;
+        }
+        if (!second.empty() && !parse_size(second.c_str(), end)) {
+            return false;
+        }
+        return true;
+    }
+} // namespace
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <sample_schema> <container_binary>" << std::endl;
-        std::cerr << "\nConvert a container flatbuffer sample binary to a text file with a " <<
-            "sequence of the nested sample types." << std::endl;
+    size_t begin = 0;
+    size_t end = static_cast<size_t>(-1);
+    size_t stride = 1;
+    const char* positional[2] = {nullptr, nullptr};
+    size_t positional_count = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--range") == 0) && (i + 1 < argc)) {
+            if (!parse_range(argv[++i], &begin, &end)) {
+                std::cerr << "Invalid range: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if ((std::strcmp(argv[i], "--stride") == 0) && (i + 1 < argc)) {
+            if (!parse_size(argv[++i], &stride) || (stride == 0)) {
+                std::cerr << "Invalid stride: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if ((argv[i][0] != '-') && (positional_count < 2)) {
+            positional[positional_count++] = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (positional_count != 2) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
 
     flatbuffers::Parser parser;
     std::string schemafile;
-    if (!flatbuffers::LoadFile(argv[1], true, &schemafile)) {
-        std::cerr << "Unable to open schema: " << argv[1] << std::endl;
+    if (!flatbuffers::LoadFile(positional[0], true, &schemafile)) {
+        std::cerr << "Unable to open schema: " << positional[0] << std::endl;
         return EXIT_FAILURE;
     }
 
-    std::string buffer;
-    if (!flatbuffers::LoadFile(argv[2], true, &buffer)) {
-        std::cerr << "Unable to open binary: " << argv[2] << std::endl;
-        return EXIT_FAILURE;
-    }
-
-    const char *include_directories[] = { flatbuffers::StripFileName(argv[1]).c_str(), "samples", nullptr };
+    const std::string schema_directory = flatbuffers::StripFileName(positional[0]);
+    const char *include_directories[] = { schema_directory.c_str(), "samples", nullptr };
     if (!parser.Parse(schemafile.c_str(), include_directories)) {
-        std::cerr << "Unable to parse schema: " << argv[1] << std::endl;
+        std::cerr << "Unable to parse schema: " << positional[0] << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -49,8 +98,35 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    std::string json_gen;
-    parse_nested_container(parser, buffer.data(), &json_gen);
-    std::cout << json_gen << std::endl;
+    try {
+        const fbs::SampleLogReader reader(positional[1]);
+
+        /*
+         * Each sample is converted and written separately so the text for the
+         * log is never held in memory. Delta encoded samples are decoded from
+         * the preceding keyframe and printed with all fields reconstructed.
+         */
+        end = std::min(end, reader.size());
+        fbs::SampleDeltaDecoder decoder;
+        flatbuffers::FlatBufferBuilder fbb;
+        std::string text;
+        std::cout << "samples:\n";
+        for (size_t i = (begin < end) ? reader.keyframe(begin) : end; i < end; ++i) {
+            decoder.update(reader.sample(i));
+            if ((i < begin) || ((i - begin) % stride != 0)) {
+                continue;
+            }
+            fbb.Clear();
+            fbb.Finish(decoder.create_sample(fbb, reader.sample(i)));
+            text.clear();
+            flatbuffers::GenerateText(parser, fbb.GetBufferPointer(),
+                    flatbuffers::GeneratorOptions(), &text);
+            std::cout << text;
+        }
+        std::cout << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << " " << positional[1] << std::endl;
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,108 @@
+/*
+ * Generate a steady state LQR and Kalman filter gain schedule.
+ *
+ * Gains are calculated over a grid of forward speeds for a bicycle parameter
+ * file and written as a GainSchedule flatbuffer (see fbs/gain_schedule.fbs).
+ * The schedule can be loaded with fbs::get_gain_schedule() and used with
+ * ScheduledLqr and ScheduledKalman so that no Riccati equation is solved in
+ * the control loop.
+ *
+ * The cost weights and noise covariances are the same as those used in
+ * LqrKalmanConvergenceTest (see tests/test_convergence.cc).
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bicycle/whipple.h"
+#include "gain_schedule.h"
+#include "parameters.h"
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/util.h"
+#include "gain_schedule_util.h"
+
+namespace {
+    using bicycle_t = model::BicycleWhipple;
+    using schedule_t = model::GainSchedule<bicycle_t>;
+    using real_t = model::real_t;
+
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options] <output_file> [parameter_file]\n";
+        std::cerr << "\nCalculate steady state LQR and Kalman filter gains over a range of\n" <<
+            "forward speeds and write them to a gain schedule flatbuffer. If no parameter\n" <<
+            "file is given, the benchmark parameters are used.\n\n";
+        std::cerr << "Options:\n";
+        std::cerr << "  -t <dt>               sampling time [s] (default: 0.005)\n";
+        std::cerr << "  -v <min> <max> <step> forward speed range [m/s] (default: 0.5 10.0 0.1)\n";
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    real_t dt = 1.0/200;
+    real_t v_min = 0.5;
+    real_t v_max = 10.0;
+    real_t dv = 0.1;
+    std::string output_file;
+    std::string parameter_file;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string(argv[i]);
+        if ((arg == "-t") && (i + 1 < argc)) {
+            dt = std::atof(argv[++i]);
+        } else if ((arg == "-v") && (i + 3 < argc)) {
+            v_min = std::atof(argv[++i]);
+            v_max = std::atof(argv[++i]);
+            dv = std::atof(argv[++i]);
+        } else if ((arg == "-h") || (arg.size() > 1 && arg[0] == '-')) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (output_file.empty()) {
+            output_file = arg;
+        } else if (parameter_file.empty()) {
+            parameter_file = arg;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (output_file.empty()) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!(dt > 0) || !(dv > 0) || !(v_max > v_min)) {
+        std::cerr << "Invalid sampling time or speed range.\n";
+        return EXIT_FAILURE;
+    }
+
+    bicycle_t bicycle = parameter_file.empty() ?
+        bicycle_t(v_min, dt) : bicycle_t(parameter_file.c_str(), v_min, dt);
+
+    schedule_t::weights_t weights;
+    weights.lqr_Q = schedule_t::state_cost_t::Identity();
+    weights.lqr_R = 0.1 * (schedule_t::input_cost_t() << 0, 0, 0, 1).finished();
+    weights.lqr_Qi = schedule_t::state_cost_t::Zero();
+    weights.kalman_Q = parameters::defaultvalue::kalman::Q(dt);
+    weights.kalman_R = parameters::defaultvalue::kalman::R;
+
+    schedule_t schedule;
+    auto start = std::chrono::steady_clock::now();
+    schedule.generate(bicycle, v_min, v_max, dv, weights);
+    auto stop = std::chrono::steady_clock::now();
+    std::cout << "calculated gains at " << schedule.size() << " speeds in [" <<
+        schedule.v_min() << ", " << schedule.v_max() << "] m/s in " <<
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() <<
+        " ms" << std::endl;
+
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(fbs::create_gain_schedule(builder, schedule), fbs::GainScheduleIdentifier());
+    if (!flatbuffers::SaveFile(output_file.c_str(),
+                reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                builder.GetSize(), true)) {
+        std::cerr << "Unable to write gain schedule: " << output_file << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "wrote " << builder.GetSize() << " bytes to " << output_file << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/*
+ * Measure block compression of a sample log.
+ *
+ * The samples of a log, e.g. as written by examples/full_fbs, are grouped into
+ * blocks as done by SampleLogWriter with block compression. Each block is
+ * encoded and decoded (see sample_log_compression.h) and the decoded records
+ * are compared with the original. The compression ratio and the encode and
+ * decode throughput, in MB of uncompressed sample data per second, are
+ * reported. Blocks are processed one at a time so the measured throughput is
+ * for a single thread.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sample_log_compression.h"
+#include "sample_log_reader.h"
+#include "sample_log_writer.h"
+
+namespace {
+    using steady_clock = std::chrono::steady_clock;
+
+    void print_usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options] <sample_log>\n";
+        std::cerr << "\nMeasure the compression ratio and throughput of sample log block\n" <<
+            "compression.\n\n";
+        std::cerr << "Options:\n";
+        std::cerr << "  -b <records>          records per block (default: " <<
+            fbs::SampleLogWriter::default_index_interval << ")\n";
+        std::cerr << "  -r <repetitions>      number of times each block is encoded and decoded (default: 1)\n";
+    }
+
+    double megabytes_per_second(size_t bytes, steady_clock::duration duration) {
+        return static_cast<double>(bytes)/1e6/std::chrono::duration<double>(duration).count();
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t block_records = fbs::SampleLogWriter::default_index_interval;
+    size_t repetitions = 1;
+    std::string input_file;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string(argv[i]);
+        if ((arg == "-b") && (i + 1 < argc)) {
+            block_records = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-r") && (i + 1 < argc)) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "-h") || (arg.size() > 1 && arg[0] == '-') || !input_file.empty()) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            input_file = arg;
+        }
+    }
+    if (input_file.empty()) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const fbs::SampleLogReader reader(input_file.c_str());
+
+        std::vector<uint32_t> sizes;
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> encoded;
+        std::vector<uint8_t> scratch;
+        std::vector<uint32_t> decoded_sizes;
+        std::vector<uint8_t> decoded;
+
+        size_t raw_bytes = 0;
+        size_t compressed_bytes = 0;
+        size_t blocks = 0;
+        steady_clock::duration encode_time = steady_clock::duration::zero();
+        steady_clock::duration decode_time = steady_clock::duration::zero();
+
+        for (size_t begin = 0; begin < reader.size(); begin += block_records) {
+            const size_t end = std::min(begin + block_records, reader.size());
+            sizes.clear();
+            data.clear();
+            for (size_t i = begin; i < end; ++i) {
+                sizes.push_back(reader.data_size(i));
+                data.insert(data.end(), reader.data(i), reader.data(i) + reader.data_size(i));
+            }
+
+            auto start = steady_clock::now();
+            for (size_t r = 0; r < repetitions; ++r) {
+                fbs::compression::encode_block(sizes, data.data(), &encoded, &scratch);
+            }
+            encode_time += steady_clock::now() - start;
+
+            start = steady_clock::now();
+            for (size_t r = 0; r < repetitions; ++r) {
+                if (!fbs::compression::decode_block(encoded.data(), encoded.size(),
+                            &decoded_sizes, &decoded, &scratch)) {
+                    throw std::runtime_error("Unable to decode block.");
+                }
+            }
+            decode_time += steady_clock::now() - start;
+
+            if ((decoded_sizes != sizes) || (decoded != data)) {
+                throw std::runtime_error("Decoded block differs from original.");
+            }
+            raw_bytes += data.size() + sizeof(uint32_t)*sizes.size(); // size prefixed records
+            compressed_bytes += encoded.size() + sizeof(uint32_t); // size prefixed block
+            ++blocks;
+        }
+
+        std::cout << "samples: " << reader.size() << " in " << blocks << " blocks of " <<
+            block_records << " records" << std::endl;
+        std::cout << "uncompressed size: " << raw_bytes << " B" << std::endl;
+        std::cout << "compressed size: " << compressed_bytes << " B" << std::endl;
+        if (compressed_bytes > 0) {
+            std::cout << "compression ratio: " <<
+                static_cast<double>(raw_bytes)/compressed_bytes << std::endl;
+            std::cout << "encode: " << megabytes_per_second(raw_bytes*repetitions, encode_time) <<
+                " MB/s" << std::endl;
+            std::cout << "decode: " << megabytes_per_second(raw_bytes*repetitions, decode_time) <<
+                " MB/s" << std::endl;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}